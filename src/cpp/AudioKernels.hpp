@@ -0,0 +1,151 @@
+#pragma once
+
+#include <pluginterfaces/base/ftypes.h>
+#include <pongasoft/VST/AudioUtils.h>
+#include <algorithm>
+#include <type_traits>
+
+namespace pongasoft::VST::SampleSplitter::Kernels {
+
+using namespace Steinberg;
+
+/**
+ * Small library of block operations on samples used by the RT engine. Each kernel is a straight loop over plain
+ * arrays (no branching, no index computation other than the loop counter) so that the compiler can vectorize it,
+ * including the conversion between sample types (for example `Sample32` -> `Sample64` when the host processes in
+ * 64 bits).
+ */
+
+/**
+ * Copies `iNumSamples` samples from `iFrom` to `oTo`, converting them to `ToSampleType` (a plain memory copy when
+ * both types are the same) */
+template<typename FromSampleType, typename ToSampleType>
+inline void copy(FromSampleType const *iFrom, ToSampleType *oTo, int32 iNumSamples)
+{
+  if constexpr(std::is_same_v<FromSampleType, ToSampleType>)
+    std::copy(iFrom, iFrom + iNumSamples, oTo);
+  else
+  {
+    for(int32 i = 0; i < iNumSamples; i++)
+      oTo[i] = static_cast<ToSampleType>(iFrom[i]);
+  }
+}
+
+/**
+ * Adds `iNumSamples` samples from `iFrom` to `oTo`, converting them to `ToSampleType` */
+template<typename FromSampleType, typename ToSampleType>
+inline void add(FromSampleType const *iFrom, ToSampleType *oTo, int32 iNumSamples)
+{
+  for(int32 i = 0; i < iNumSamples; i++)
+    oTo[i] += static_cast<ToSampleType>(iFrom[i]);
+}
+
+/**
+ * Copies `iNumSamples` samples from `iFrom` to `oTo` reading `iFrom` backward (`oTo[0] = iFrom[0]`,
+ * `oTo[1] = iFrom[-1]`...), converting them to `ToSampleType` */
+template<typename FromSampleType, typename ToSampleType>
+inline void copyReverse(FromSampleType const *iFrom, ToSampleType *oTo, int32 iNumSamples)
+{
+  for(int32 i = 0; i < iNumSamples; i++)
+    oTo[i] = static_cast<ToSampleType>(iFrom[-i]);
+}
+
+/**
+ * Adds `iNumSamples` samples from `iFrom` to `oTo` reading `iFrom` backward (`oTo[0] += iFrom[0]`,
+ * `oTo[1] += iFrom[-1]`...), converting them to `ToSampleType` */
+template<typename FromSampleType, typename ToSampleType>
+inline void addReverse(FromSampleType const *iFrom, ToSampleType *oTo, int32 iNumSamples)
+{
+  for(int32 i = 0; i < iNumSamples; i++)
+    oTo[i] += static_cast<ToSampleType>(iFrom[-i]);
+}
+
+/**
+ * @return the peak (maximum absolute value) of the `iNumSamples` samples in `iBuffer` (`0` when empty) */
+template<typename SampleType>
+inline SampleType peak(SampleType const *iBuffer, int32 iNumSamples)
+{
+  SampleType res = 0;
+  for(int32 i = 0; i < iNumSamples; i++)
+  {
+    auto sample = iBuffer[i] < 0 ? -iBuffer[i] : iBuffer[i];
+    res = sample > res ? sample : res;
+  }
+  return res;
+}
+
+/**
+ * @return the energy (sum of the squares) of the `iNumSamples` samples in `iBuffer` (`0` when empty) */
+template<typename SampleType>
+inline SampleType energy(SampleType const *iBuffer, int32 iNumSamples)
+{
+  SampleType res = 0;
+  for(int32 i = 0; i < iNumSamples; i++)
+    res += iBuffer[i] * iBuffer[i];
+  return res;
+}
+
+/**
+ * @return `true` if all the `iNumSamples` samples in `iBuffer` are silent (same definition as `VST::isSilent`). The
+ *         buffer is processed in chunks (computing the peak of each) so that it can stop early on the first chunk
+ *         which is not silent */
+template<typename SampleType>
+inline bool isSilent(SampleType const *iBuffer, int32 iNumSamples)
+{
+  constexpr int32 CHUNK_SIZE = 64;
+
+  auto threshold = getSampleSilentThreshold<SampleType>();
+
+  for(int32 i = 0; i < iNumSamples; i += CHUNK_SIZE)
+  {
+    if(peak(iBuffer + i, std::min(CHUNK_SIZE, iNumSamples - i)) > threshold)
+      return false;
+  }
+
+  return true;
+}
+
+/**
+ * @return the index of the first of the `iNumSamples` samples in `iBuffer` whose absolute value is above `iThreshold`
+ *         (`iNumSamples` if there is none). Like `isSilent`, the buffer is scanned in chunks (computing the peak of
+ *         each) and only the first chunk above the threshold is searched sample by sample */
+template<typename SampleType>
+inline int32 findFirstAbove(SampleType const *iBuffer, int32 iNumSamples, SampleType iThreshold)
+{
+  constexpr int32 CHUNK_SIZE = 64;
+
+  for(int32 i = 0; i < iNumSamples; i += CHUNK_SIZE)
+  {
+    auto chunkSize = std::min(CHUNK_SIZE, iNumSamples - i);
+    if(peak(iBuffer + i, chunkSize) > iThreshold)
+    {
+      for(int32 j = i; j < i + chunkSize; j++)
+      {
+        if(iBuffer[j] > iThreshold || -iBuffer[j] > iThreshold)
+          return j;
+      }
+    }
+  }
+
+  return iNumSamples;
+}
+
+/**
+ * Copies `iNumSamples` samples from `iFrom` to `oTo` applying `iGain` to each of them
+ *
+ * @return the peak (maximum absolute value) of the samples written to `oTo` */
+template<typename SampleType>
+inline SampleType copyWithGain(SampleType const *iFrom, SampleType *oTo, int32 iNumSamples, double iGain)
+{
+  SampleType res = 0;
+  for(int32 i = 0; i < iNumSamples; i++)
+  {
+    auto sample = static_cast<SampleType>(iFrom[i] * iGain);
+    oTo[i] = sample;
+    sample = sample < 0 ? -sample : sample;
+    res = sample > res ? sample : res;
+  }
+  return res;
+}
+
+}
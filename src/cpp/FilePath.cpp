@@ -5,10 +5,24 @@
 
 #include "FilePath.h"
 
+#include <vector>
+
 #if !SMTG_OS_WINDOWS
 #include <cstdlib>
 #endif
 
+#if SMTG_OS_MACOS
+#include <copyfile.h>
+#endif
+
+#if defined(__linux__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#endif
+
 namespace pongasoft {
 namespace VST {
 namespace SampleSplitter {
@@ -89,6 +103,130 @@ UTF8Path createTempFilePath(UTF8Path const &iFilename)
   return tempFilePath.cpp_str() + tempFilename.str();
 }
 
+//------------------------------------------------------------------------
+// bufferedCopyFile (when the platform has no fast copy primitive)
+//------------------------------------------------------------------------
+static bool bufferedCopyFile(UTF8Path const &iFromFilePath, UTF8Path const &iToFilePath)
+{
+  constexpr size_t BUFFER_SIZE = 1 << 20; // 1MB
+
+  std::ifstream ifs(iFromFilePath.toNativePath(), std::fstream::binary);
+  if(!ifs)
+  {
+    LOG_F(ERROR, "Could not open (R) %s", iFromFilePath.c_str());
+    return false;
+  }
+
+  std::ofstream ofs(iToFilePath.toNativePath(), std::fstream::binary | std::fstream::trunc);
+  if(!ofs)
+  {
+    LOG_F(ERROR, "Could not open (W) %s", iToFilePath.c_str());
+    return false;
+  }
+
+  std::vector<char> buf(BUFFER_SIZE);
+
+  while(ifs)
+  {
+    ifs.read(buf.data(), buf.size());
+
+    if(ifs.bad())
+    {
+      LOG_F(ERROR, "Error while reading file %s", iFromFilePath.c_str());
+      return false;
+    }
+
+    if(ifs.gcount() > 0)
+    {
+      ofs.write(buf.data(), ifs.gcount());
+      if(ofs.bad())
+      {
+        LOG_F(ERROR, "Error while writing file %s", iToFilePath.c_str());
+        return false;
+      }
+    }
+  }
+
+  ofs.close();
+
+  return !ofs.fail();
+}
+
+#if defined(__linux__)
+//------------------------------------------------------------------------
+// kernelCopyFile (copy_file_range shares the extents on file systems which support it, sendfile otherwise)
+//------------------------------------------------------------------------
+static bool kernelCopyFile(UTF8Path const &iFromFilePath, UTF8Path const &iToFilePath)
+{
+  auto in = ::open(iFromFilePath.toNativePath().c_str(), O_RDONLY | O_CLOEXEC);
+  if(in < 0)
+    return false;
+
+  struct stat st{};
+  auto out = ::fstat(in, &st) == 0 ?
+             ::open(iToFilePath.toNativePath().c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600) :
+             -1;
+  if(out < 0)
+  {
+    ::close(in);
+    return false;
+  }
+
+  off_t remaining = st.st_size;
+  bool useSendFile = false;
+
+  while(remaining > 0)
+  {
+    ssize_t count = -1;
+
+    if(!useSendFile)
+    {
+      count = ::copy_file_range(in, nullptr, out, nullptr, static_cast<size_t>(remaining), 0);
+      // not supported (old kernel, different file systems...) => sendfile
+      if(count < 0 && (errno == ENOSYS || errno == EXDEV || errno == EINVAL || errno == EOPNOTSUPP))
+      {
+        useSendFile = true;
+        continue;
+      }
+    }
+    else
+      count = ::sendfile(out, in, nullptr, static_cast<size_t>(remaining));
+
+    if(count <= 0)
+      break;
+
+    remaining -= count;
+  }
+
+  auto res = ::close(out) == 0 && remaining == 0;
+  ::close(in);
+  return res;
+}
+#endif
+
+//------------------------------------------------------------------------
+// copyFile
+//------------------------------------------------------------------------
+bool copyFile(UTF8Path const &iFromFilePath, UTF8Path const &iToFilePath)
+{
+#if SMTG_OS_WINDOWS
+  // CopyFile uses block cloning on ReFS
+  if(CopyFile(iFromFilePath.toNativePath().c_str(), iToFilePath.toNativePath().c_str(), FALSE))
+    return true;
+#elif SMTG_OS_MACOS
+  // COPYFILE_CLONE clones the file on APFS and copies it (in the kernel) otherwise
+  if(copyfile(iFromFilePath.toNativePath().c_str(), iToFilePath.toNativePath().c_str(), nullptr, COPYFILE_CLONE) == 0)
+    return true;
+#elif defined(__linux__)
+  if(kernelCopyFile(iFromFilePath, iToFilePath))
+    return true;
+#endif
+
+  DLOG_F(INFO, "copyFile - no fast copy for %s => buffered copy", iFromFilePath.c_str());
+
+  return bufferedCopyFile(iFromFilePath, iToFilePath);
+}
+
 //------------------------------------------------------------------------
 // basic_UTF8Path<char>::toNativePath
 //------------------------------------------------------------------------
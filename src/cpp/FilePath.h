@@ -85,6 +85,14 @@ UTF8Path getTemporaryPath();
  */
 UTF8Path createTempFilePath(UTF8Path const &iFilename);
 
+/**
+ * Copies a file using the fastest primitive the platform provides (cloning the file when the file system supports it,
+ * copying in the kernel otherwise) and falls back to a (large) buffered copy when it is not available.
+ *
+ * @return `true` if successful
+ */
+bool copyFile(UTF8Path const &iFromFilePath, UTF8Path const &iToFilePath);
+
 // basic_UTF8Path::toNativePath => char implementation
 template<>
 std::basic_string<char> basic_UTF8Path<char>::toNativePath() const;
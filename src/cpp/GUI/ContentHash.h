@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_CONTENTHASH_H
+#define VST_SAM_SPL_64_CONTENTHASH_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace pongasoft::VST::SampleSplitter::GUI {
+
+/**
+ * The hash of the content of a (sample) file: SHA-256 so that 2 different files can be considered identical when
+ * their hash is the same (which is what `SampleBuffersCache` does to share the decoded samples) */
+using ContentHash = std::array<uint8_t, 32>;
+
+/**
+ * Computes the `ContentHash` of a file incrementally: call `update` with each chunk of the file (in order) then
+ * `digest` once at the end (for example while reading the file from the state). */
+class ContentHasher
+{
+public:
+  // update
+  void update(void const *iData, size_t iSize)
+  {
+    auto bytes = static_cast<uint8_t const *>(iData);
+
+    fTotalSize += iSize;
+
+    while(iSize > 0)
+    {
+      auto count = std::min(iSize, BLOCK_SIZE - fBlockSize);
+      for(size_t i = 0; i < count; i++)
+        fBlock[fBlockSize + i] = bytes[i];
+
+      fBlockSize += count;
+      bytes += count;
+      iSize -= count;
+
+      if(fBlockSize == BLOCK_SIZE)
+      {
+        processBlock();
+        fBlockSize = 0;
+      }
+    }
+  }
+
+  // digest (the hasher must not be updated afterwards)
+  ContentHash digest()
+  {
+    auto numBits = fTotalSize * 8;
+
+    // padding: 1 bit, 0s up to 56 bytes (mod 64), then the size in bits (big endian)
+    uint8_t const one = 0x80;
+    update(&one, 1);
+
+    uint8_t const zero = 0;
+    while(fBlockSize != BLOCK_SIZE - 8)
+      update(&zero, 1);
+
+    for(int i = 7; i >= 0; i--)
+    {
+      auto byte = static_cast<uint8_t>(numBits >> (i * 8));
+      update(&byte, 1);
+    }
+
+    ContentHash res{};
+    for(size_t i = 0; i < fState.size(); i++)
+    {
+      res[i * 4 + 0] = static_cast<uint8_t>(fState[i] >> 24);
+      res[i * 4 + 1] = static_cast<uint8_t>(fState[i] >> 16);
+      res[i * 4 + 2] = static_cast<uint8_t>(fState[i] >> 8);
+      res[i * 4 + 3] = static_cast<uint8_t>(fState[i]);
+    }
+    return res;
+  }
+
+  // hash (the content is in memory)
+  static ContentHash hash(void const *iData, size_t iSize)
+  {
+    ContentHasher hasher{};
+    hasher.update(iData, iSize);
+    return hasher.digest();
+  }
+
+private:
+  static constexpr size_t BLOCK_SIZE = 64;
+
+  // rotr
+  static constexpr uint32_t rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+  // processBlock
+  void processBlock()
+  {
+    static constexpr uint32_t K[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+      0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+      0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+      0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+      0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+      0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+      0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+    };
+
+    uint32_t w[64];
+    for(size_t i = 0; i < 16; i++)
+      w[i] = (static_cast<uint32_t>(fBlock[i * 4]) << 24) |
+             (static_cast<uint32_t>(fBlock[i * 4 + 1]) << 16) |
+             (static_cast<uint32_t>(fBlock[i * 4 + 2]) << 8) |
+             static_cast<uint32_t>(fBlock[i * 4 + 3]);
+
+    for(size_t i = 16; i < 64; i++)
+    {
+      auto s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      auto s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    auto a = fState[0], b = fState[1], c = fState[2], d = fState[3];
+    auto e = fState[4], f = fState[5], g = fState[6], h = fState[7];
+
+    for(size_t i = 0; i < 64; i++)
+    {
+      auto t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+      auto t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      h = g; g = f; f = e; e = d + t1;
+      d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    fState[0] += a; fState[1] += b; fState[2] += c; fState[3] += d;
+    fState[4] += e; fState[5] += f; fState[6] += g; fState[7] += h;
+  }
+
+private:
+  std::array<uint32_t, 8> fState{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  std::array<uint8_t, BLOCK_SIZE> fBlock{};
+  size_t fBlockSize{};
+  uint64_t fTotalSize{};
+};
+
+}
+
+#endif //VST_SAM_SPL_64_CONTENTHASH_H
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_SAMPLEANALYZER_H
+#define VST_SAM_SPL_64_SAMPLEANALYZER_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../SampleBuffers.h"
+
+namespace pongasoft::VST::SampleSplitter::GUI {
+
+/**
+ * Computes an analysis of a sample (`Result`, for example the transients or the zero crossings) on a worker thread
+ * so that the UI is never blocked (even for large samples). The results are cached per sample (the buffers of a
+ * sample are never modified, each action creates new buffers) so that using them again (for example after undoing
+ * an action) does not compute them again.
+ *
+ * All methods must be called from the UI thread. */
+template<typename Result>
+class SampleAnalyzer
+{
+public:
+  /**
+   * The analysis (called on the worker thread) which should return early (the result is then discarded) when
+   * `iCancel` is set */
+  using Analysis = std::function<Result(SampleBuffers32 const &iBuffers, std::atomic<bool> const &iCancel)>;
+
+  // how many results are kept in the cache
+  static constexpr size_t CACHE_SIZE = 8;
+
+public:
+  // Constructor
+  explicit SampleAnalyzer(Analysis iAnalysis) : fAnalysis{std::move(iAnalysis)} {}
+
+  // Destructor (cancels and waits for the worker thread)
+  ~SampleAnalyzer() { cancel(); }
+
+  /**
+   * @return the result for the sample if it has already been computed or `nullptr` if not, in which case it is being
+   *         computed on the worker thread (cancelling the computation for any other sample). Use `isComputing` to
+   *         check whether the computation is done. */
+  std::shared_ptr<Result const> getResult(std::shared_ptr<SampleBuffers32> const &iBuffers)
+  {
+    if(!iBuffers || !iBuffers->hasSamples())
+      return nullptr;
+
+    if(auto res = findInCache(iBuffers))
+      return res;
+
+    // already being computed
+    if(isComputing() && fComputingBuffers == iBuffers)
+      return nullptr;
+
+    cancel();
+
+    fComputingBuffers = iBuffers;
+    fCancel.store(false);
+    fComputing.store(true, std::memory_order_release);
+
+    fThread = std::thread([this, buffers = iBuffers] {
+      auto result = std::make_shared<Result>(fAnalysis(*buffers, fCancel));
+
+      if(!fCancel.load())
+      {
+        std::lock_guard<std::mutex> lock{fMutex};
+        fCache.insert(fCache.begin(), Entry{buffers, std::move(result)});
+        if(fCache.size() > CACHE_SIZE)
+          fCache.pop_back();
+      }
+
+      fComputing.store(false, std::memory_order_release);
+    });
+
+    return nullptr;
+  }
+
+  /**
+   * @return `true` while the worker thread is computing a result */
+  inline bool isComputing() const { return fComputing.load(std::memory_order_acquire); }
+
+private:
+  struct Entry
+  {
+    std::weak_ptr<SampleBuffers32> fBuffers;
+    std::shared_ptr<Result const> fResult;
+  };
+
+  // finds the entry for these buffers (`nullptr` if not in the cache)
+  std::shared_ptr<Result const> findInCache(std::shared_ptr<SampleBuffers32> const &iBuffers)
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+
+    // the samples which no longer exist cannot be requested anymore
+    fCache.erase(std::remove_if(fCache.begin(), fCache.end(), [](auto const &e) { return e.fBuffers.expired(); }),
+                 fCache.end());
+
+    auto iter = std::find_if(fCache.begin(), fCache.end(), [&iBuffers](auto const &e) {
+      return e.fBuffers.lock() == iBuffers;
+    });
+
+    if(iter == fCache.end())
+      return nullptr;
+
+    // most recently used first
+    std::rotate(fCache.begin(), iter, iter + 1);
+
+    return fCache.front().fResult;
+  }
+
+  // cancels the current computation (if any) and waits for the worker thread to be done
+  void cancel()
+  {
+    fCancel.store(true);
+    if(fThread.joinable())
+      fThread.join();
+    fComputingBuffers = nullptr;
+  }
+
+private:
+  Analysis fAnalysis;
+
+  std::mutex fMutex{};
+  std::vector<Entry> fCache{}; // most recent first (guarded by fMutex)
+
+  std::shared_ptr<SampleBuffers32> fComputingBuffers{}; // the sample being computed (UI thread only)
+  std::atomic<bool> fComputing{};
+  std::atomic<bool> fCancel{};
+  std::thread fThread{};
+};
+
+}
+
+#endif //VST_SAM_SPL_64_SAMPLEANALYZER_H
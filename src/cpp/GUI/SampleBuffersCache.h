@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_SAMPLEBUFFERSCACHE_H
+#define VST_SAM_SPL_64_SAMPLEBUFFERSCACHE_H
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "../Model.h"
+#include "../SampleBuffers.h"
+#include "ContentHash.h"
+
+namespace pongasoft::VST::SampleSplitter::GUI {
+
+/**
+ * Process wide cache of the decoded (and resampled) samples so that several instances of the plugin loading the same
+ * sample (same content, no matter the file name) at the same sample rate share the same buffers instead of each
+ * holding its own copy. Sharing is safe because the buffers are never modified once created (each action creates new
+ * buffers, see `SharedSampleBuffersMgr`).
+ *
+ * The decoded (not resampled) sample is kept as well when it had to be resampled (`findOriginal`) so that
+ * resampling it to another sample rate (for example when the host switches back and forth between two sample rates)
+ * does not require reading and decoding the file again.
+ *
+ * The cache keeps the most recently used samples within a memory budget: a sample still used by an instance (or by
+ * the undo history) is never evicted since evicting it would not free any memory.
+ *
+ * All methods are thread safe. */
+class SampleBuffersCache
+{
+public:
+  // identifies a decoded sample
+  struct Key
+  {
+    ContentHash fContentHash{}; // hash of the (encoded) file content (see `ContentHasher`)
+    uint64 fFileSize{};
+    SampleRate fSampleRate{}; // the sample rate the sample was decoded (and resampled) to
+    EResamplingQuality fQuality{EResamplingQuality::kHigh}; // kHigh when the sample did not need to be resampled
+
+    bool operator==(Key const &rhs) const
+    {
+      return fContentHash == rhs.fContentHash &&
+             fFileSize == rhs.fFileSize &&
+             fSampleRate == rhs.fSampleRate &&
+             fQuality == rhs.fQuality;
+    }
+  };
+
+  struct Value
+  {
+    std::shared_ptr<SampleBuffers32> fBuffers{};
+    SampleRate fOriginalSampleRate{};
+  };
+
+public:
+  // Constructor
+  explicit SampleBuffersCache(size_t iMemoryBudget = SAMPLE_BUFFERS_CACHE_MEMORY_BUDGET) :
+    fMemoryBudget{iMemoryBudget} {}
+
+  /**
+   * @return the cache shared by all the instances of the plugin (in the process) */
+  static SampleBuffersCache &instance()
+  {
+    static SampleBuffersCache kInstance{};
+    return kInstance;
+  }
+
+  /**
+   * @return the sample for this key (`std::nullopt` if not in the cache) */
+  std::optional<Value> find(Key const &iKey)
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+
+    auto iter = std::find_if(fEntries.begin(), fEntries.end(), [&iKey](auto const &e) { return e.fKey == iKey; });
+
+    if(iter == fEntries.end())
+      return std::nullopt;
+
+    // most recently used first
+    std::rotate(fEntries.begin(), iter, iter + 1);
+
+    return fEntries.front().fValue;
+  }
+
+  /**
+   * @return the sample as decoded (not resampled, no matter the sample rate) if in the cache (`std::nullopt` if not) */
+  std::optional<Value> findOriginal(ContentHash const &iContentHash, uint64 iFileSize)
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+
+    auto iter = std::find_if(fEntries.begin(), fEntries.end(), [&iContentHash, iFileSize](auto const &e) {
+      return e.fKey.fContentHash == iContentHash &&
+             e.fKey.fFileSize == iFileSize &&
+             e.fKey.fSampleRate == e.fValue.fOriginalSampleRate;
+    });
+
+    if(iter == fEntries.end())
+      return std::nullopt;
+
+    // most recently used first
+    std::rotate(fEntries.begin(), iter, iter + 1);
+
+    return fEntries.front().fValue;
+  }
+
+  /**
+   * Adds the sample to the cache (evicting the least recently used samples no longer in use if the memory budget is
+   * exceeded).
+   *
+   * @return the value to use: `iValue` or the one already in the cache if another instance added it first */
+  Value add(Key const &iKey, Value iValue)
+  {
+    if(!iValue.fBuffers)
+      return iValue;
+
+    std::lock_guard<std::mutex> lock{fMutex};
+
+    auto iter = std::find_if(fEntries.begin(), fEntries.end(), [&iKey](auto const &e) { return e.fKey == iKey; });
+    if(iter != fEntries.end())
+    {
+      std::rotate(fEntries.begin(), iter, iter + 1);
+      return fEntries.front().fValue;
+    }
+
+    fMemoryUsage += computeMemorySize(*iValue.fBuffers);
+    fEntries.insert(fEntries.begin(), Entry{iKey, iValue});
+
+    evict();
+
+    return iValue;
+  }
+
+  /**
+   * Changes the memory budget (in bytes) and evicts what is not in use anymore if it is exceeded */
+  void setMemoryBudget(size_t iMemoryBudget)
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    fMemoryBudget = iMemoryBudget;
+    evict();
+  }
+
+  // getMemoryBudget
+  size_t getMemoryBudget() const { std::lock_guard<std::mutex> lock{fMutex}; return fMemoryBudget; }
+
+  // getMemoryUsage (the memory used by all the samples in the cache, in use or not)
+  size_t getMemoryUsage() const { std::lock_guard<std::mutex> lock{fMutex}; return fMemoryUsage; }
+
+  // size (number of samples in the cache)
+  size_t size() const { std::lock_guard<std::mutex> lock{fMutex}; return fEntries.size(); }
+
+private:
+  struct Entry
+  {
+    Key fKey;
+    Value fValue;
+  };
+
+  // computeMemorySize
+  static size_t computeMemorySize(SampleBuffers32 const &iBuffers)
+  {
+    return static_cast<size_t>(iBuffers.getNumChannels()) * static_cast<size_t>(iBuffers.getNumSamples()) *
+           sizeof(Vst::Sample32);
+  }
+
+  // evicts the least recently used samples which are not in use (fMutex must be held)
+  void evict()
+  {
+    for(auto i = fEntries.size(); i > 0 && fMemoryUsage > fMemoryBudget; i--)
+    {
+      auto iter = fEntries.begin() + (i - 1);
+
+      // the cache holds the only reference => not used by any instance
+      if(iter->fValue.fBuffers.use_count() == 1)
+      {
+        fMemoryUsage -= computeMemorySize(*iter->fValue.fBuffers);
+        fEntries.erase(iter);
+      }
+    }
+  }
+
+private:
+  mutable std::mutex fMutex{};
+  std::vector<Entry> fEntries{}; // most recently used first
+  size_t fMemoryBudget;
+  size_t fMemoryUsage{};
+};
+
+}
+
+#endif //VST_SAM_SPL_64_SAMPLEBUFFERSCACHE_H
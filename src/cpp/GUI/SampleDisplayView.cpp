@@ -15,6 +15,7 @@ void SampleDisplayView::registerParameters()
   WaveformView::registerParameters();
 
   fNumSlices = registerParam(fParams->fNumSlices);
+  fSliceMap = registerParam(fState->fSliceMap);
   fSelectedSlice = registerParam(fParams->fSelectedSlice);
 }
 
@@ -31,27 +32,53 @@ void SampleDisplayView::draw(CDrawContext *iContext)
 
     auto rdc = pongasoft::VST::GUI::RelativeDrawContext{this, iContext};
 
+    auto sliceMap = getSliceMap();
+    auto numPixelsPerSample = sliceMap ? getWidth() / sliceMap->getNumSamples() : 0;
+
     if(!GUI::CColorUtils::isTransparent(getSelectionColor()))
     {
-      auto w = getWidth() / fNumSlices->realValue();
-      auto x = *fSelectedSlice * w;
+      if(sliceMap)
+      {
+        if(*fSelectedSlice < sliceMap->getNumSlices())
+          rdc.fillRect(sliceMap->getStart(*fSelectedSlice) * numPixelsPerSample,
+                       0,
+                       sliceMap->getEnd(*fSelectedSlice) * numPixelsPerSample,
+                       getHeight(),
+                       getSelectionColor());
+      }
+      else
+      {
+        auto w = getWidth() / fNumSlices->realValue();
+        auto x = *fSelectedSlice * w;
 
-      if(x < getWidth())
-        rdc.fillRect(x, 0, x + w, getHeight(), getSelectionColor());
+        if(x < getWidth())
+          rdc.fillRect(x, 0, x + w, getHeight(), getSelectionColor());
+      }
     }
 
     // second draw the slices
     auto &color = getSliceLineColor();
     if(!CColorUtils::isTransparent(color))
     {
-      auto numPixelsPerSlice = getWidth() / fNumSlices->realValue();
+      if(sliceMap)
+      {
+        for(int32 i = 1; i < sliceMap->getNumSlices(); i++)
+        {
+          auto w = sliceMap->getStart(i) * numPixelsPerSample;
+          rdc.drawLine(w, 0, w, getHeight(), color);
+        }
+      }
+      else
+      {
+        auto numPixelsPerSlice = getWidth() / fNumSlices->realValue();
 
-      auto w = numPixelsPerSlice;
+        auto w = numPixelsPerSlice;
 
-      for(int32 i = 1; i < fNumSlices->intValue(); i++)
-      {
-        rdc.drawLine(w, 0, w, getHeight(), color);
-        w += numPixelsPerSlice;
+        for(int32 i = 1; i < fNumSlices->intValue(); i++)
+        {
+          rdc.drawLine(w, 0, w, getHeight(), color);
+          w += numPixelsPerSlice;
+        }
       }
     }
   }
@@ -81,12 +108,30 @@ int SampleDisplayView::computeSelectedSlice(CPoint const &iWhere) const
 {
   RelativeView rv(this);
 
-  auto w = getWidth() / fNumSlices->realValue();
   auto x = Utils::clamp<CCoord>(rv.fromAbsolutePoint(iWhere).x, 0, getWidth());
 
+  if(auto sliceMap = getSliceMap())
+  {
+    auto sample = static_cast<int32>(x * sliceMap->getNumSamples() / getWidth());
+    return Utils::clamp<int>(sliceMap->findSlice(sample), 0, NUM_SLICES - 1);
+  }
+
+  auto w = getWidth() / fNumSlices->realValue();
+
   return Utils::clamp<int>(x / w, 0, NUM_SLICES - 1);
 }
 
+//------------------------------------------------------------------------
+// SampleDisplayView::getSliceMap
+//------------------------------------------------------------------------
+std::optional<SliceMap> SampleDisplayView::getSliceMap() const
+{
+  auto const &currentSample = *fState->fCurrentSample;
+  if(currentSample.hasSamples())
+    return SliceMap::resolve(fSliceMap->get(), currentSample.getNumSamples(), *fNumSlices);
+  return std::nullopt;
+}
+
 //------------------------------------------------------------------------
 // SampleDisplayView::onMouseDown
 //------------------------------------------------------------------------
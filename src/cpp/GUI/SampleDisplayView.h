@@ -49,11 +49,15 @@ protected:
   // computeSelectedSlice
   int computeSelectedSlice(CPoint const &iWhere) const;
 
+  // the slices of the current sample (`std::nullopt` when there is no sample)
+  std::optional<SliceMap> getSliceMap() const;
+
 private:
   CColor fSelectionColor{255, 255, 255, 100};
   CColor fSliceLineColor{kTransparentCColor};
 
   GUIVstParam<NumSlice> fNumSlices{};
+  GUIJmbParam<SharedSliceMap> fSliceMap{};
 
   GUIVstParam<int> fSelectedSlice{};
   GUIVstParamEditor<int> fSelectedSliceEditor{nullptr};
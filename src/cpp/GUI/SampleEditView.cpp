@@ -117,6 +117,23 @@ struct SampleEditView::RangeEditor
     return false;
   }
 
+  // snapToZeroCrossing => moves both ends of the selection to their nearest zero crossing
+  bool snapToZeroCrossing(ZeroCrossingIndex const &iZeroCrossingIndex, int32 iMaxDistance)
+  {
+    if(fSelectedPixelRange.isSingleValue())
+      return false;
+
+    auto from = iZeroCrossingIndex.snap(static_cast<int32>(std::round(fSelectedSampleRange->fFrom)), iMaxDistance);
+    auto to = iZeroCrossingIndex.snap(static_cast<int32>(std::round(fSelectedSampleRange->fTo)), iMaxDistance);
+
+    if(from >= to)
+      return false;
+
+    fSelectedSampleRange.update(SampleRange{static_cast<double>(from), static_cast<double>(to)});
+    fSelectedPixelRange = fVisibleSampleRange.mapSubRange(*fSelectedSampleRange, fVisiblePixelRange, false);
+    return true;
+  }
+
   // commit
   bool commit()
   {
@@ -195,14 +212,15 @@ struct SampleEditView::Slices
     fPixelSlices.emplace_back(iVisibleSampleRange.mapSubRange(sampleRange, iVisiblePixelRange, false));
   }
 
-  // getPixelSlice => finds the slice containing x
+  // getPixelSlice => finds the slice containing x (slices are sorted and contiguous => binary search)
   SamplePixelSlice getPixelSlice(RelativeCoord x) const
   {
-    auto it = std::find_if(fPixelSlices.cbegin(),
-                           fPixelSlices.cend(),
-                           [x] (auto const &iPixelSlice) { return iPixelSlice.contains(x); });
+    auto it = std::lower_bound(fPixelSlices.cbegin(),
+                               fPixelSlices.cend(),
+                               x,
+                               [] (auto const &iPixelSlice, RelativeCoord v) { return iPixelSlice.fTo < v; });
 
-    if(it != fPixelSlices.cend())
+    if(it != fPixelSlices.cend() && it->contains(x))
     {
       auto idx = it - fPixelSlices.cbegin();
       return {fSampleSlices[idx], *it};
@@ -216,39 +234,38 @@ struct SampleEditView::Slices
   // getSliceNearTo => returns the slice where fTo is close to x
   SamplePixelSlice getSliceNearTo(RelativeCoord x) const
   {
-    size_t idx = 0;
-    RelativeCoord distance = std::numeric_limits<RelativeCoord>::max();
-    for(size_t i = 0; i < fPixelSlices.size(); i++)
-    {
-      auto newDistance = std::abs(x - fPixelSlices[i].fTo);
-      if(newDistance < distance)
-      {
-        idx = i;
-        distance = newDistance;
-      }
-    }
-
+    auto idx = findNearest(x, [] (PixelRange const &iPixelSlice) { return iPixelSlice.fTo; });
     return {fSampleSlices[idx], fPixelSlices[idx]};
   }
 
   // getSliceNearTo => returns the slice where fFrom is close to x
   SamplePixelSlice getSliceNearFrom(RelativeCoord x) const
   {
-    size_t idx = 0;
-    RelativeCoord distance = std::numeric_limits<RelativeCoord>::max();
-    for(size_t i = 0; i < fPixelSlices.size(); i++)
-    {
-      auto newDistance = std::abs(x - fPixelSlices[i].fFrom);
-      if(newDistance < distance)
-      {
-        idx = i;
-        distance = newDistance;
-      }
-    }
-
+    auto idx = findNearest(x, [] (PixelRange const &iPixelSlice) { return iPixelSlice.fFrom; });
     return {fSampleSlices[idx], fPixelSlices[idx]};
   }
 
+  // findNearest => index of the slice whose boundary (fFrom or fTo, both sorted) is the closest to x (earliest wins)
+  template<typename Boundary>
+  size_t findNearest(RelativeCoord x, Boundary iBoundary) const
+  {
+    auto it = std::lower_bound(fPixelSlices.cbegin(),
+                               fPixelSlices.cend(),
+                               x,
+                               [&iBoundary] (auto const &iPixelSlice, RelativeCoord v) {
+                                 return iBoundary(iPixelSlice) < v;
+                               });
+
+    auto idx = static_cast<size_t>(it - fPixelSlices.cbegin());
+
+    // the previous boundary (< x) may be closer
+    if(idx > 0 && (idx == fPixelSlices.size() ||
+                   x - iBoundary(fPixelSlices[idx - 1]) <= iBoundary(fPixelSlices[idx]) - x))
+      idx--;
+
+    return idx < fPixelSlices.size() ? idx : 0;
+  }
+
 
   std::vector<SampleRange> fSampleSlices{};
   std::vector<PixelRange> fPixelSlices{};
@@ -264,7 +281,10 @@ void SampleEditView::registerParameters()
   fOffsetPercent = registerParam(fParams->fWEOffsetPercent);
   fZoomPercent = registerParam(fParams->fWEZoomPercent);
   fShowZeroCrossing = registerParam(fParams->fWEShowZeroCrossing);
+  fSnapToZeroCrossing = registerParam(fParams->fWESnapToZeroCrossing, false);
+  fZeroCrossingIndex = registerParam(fState->fZeroCrossingIndex);
   fNumSlices = registerParam(fParams->fNumSlices);
+  fSliceMap = registerParam(fState->fSliceMap);
   fHostInfo = registerParam(fState->fHostInfo);
   fZoomToSelection = registerParam(fParams->fWEZoomToSelection);
   registerParam(fState->fWESelectedSampleRange);
@@ -392,7 +412,8 @@ void SampleEditView::generateBitmap(CurrentSample const &iCurrentSample)
                                       *fOffsetPercent,
                                       *fZoomPercent,
                                       &startOffset,
-                                      &endOffset);
+                                      &endOffset,
+                                      getZeroCrossingIndex());
 
     if(fBitmap)
     {
@@ -506,8 +527,20 @@ CMouseEventResult SampleEditView::onMouseUp(CPoint &where, const CButtonState &b
     }
 
     if(!snap)
+    {
       fSelectionEditor->setValue(x);
 
+      if(*fSnapToZeroCrossing && buttons.getModifierState() != CButton::kAlt)
+      {
+        if(auto zeroCrossingIndex = getZeroCrossingIndex())
+        {
+          auto maxDistance =
+            static_cast<int32>(fState->fCurrentSample->getSampleRate() * ZERO_CROSSING_SNAP_MAX_DISTANCE_MS / 1000.0);
+          fSelectionEditor->snapToZeroCrossing(*zeroCrossingIndex, maxDistance);
+        }
+      }
+    }
+
     fSelectionEditor->commit();
     fSelectionEditor = nullptr;
 
@@ -537,7 +570,8 @@ void SampleEditView::onParameterChange(ParamID iParamID)
 {
   if(iParamID == fZoomPercent.getParamID() ||
      iParamID == fOffsetPercent.getParamID() ||
-     iParamID == fShowZeroCrossing.getParamID())
+     iParamID == fShowZeroCrossing.getParamID() ||
+     (iParamID == fZeroCrossingIndex.getParamID() && *fShowZeroCrossing))
     fBitmap = nullptr;
 
   if(iParamID == fCurrentSample.getParamID() || iParamID == fSampleRate.getParamID())
@@ -566,7 +600,7 @@ void SampleEditView::onParameterChange(ParamID iParamID)
     fSelectionEditor = nullptr;
   }
 
-  if(iParamID == fNumSlices.getParamID())
+  if(iParamID == fNumSlices.getParamID() || iParamID == fSliceMap.getParamID())
     fSlices = nullptr;
 
   if(iParamID == fZoomToSelection.getParamID() && *fZoomToSelection)
@@ -647,22 +681,32 @@ SampleEditView::Slices *SampleEditView::computeSlices(PixelRange const &iHorizon
 {
   if(!fSlices && fState->fCurrentSample->hasSamples())
   {
-    int numSlices = fNumSlices->intValue();
-    int32 numSamplesPerSlice = fState->fCurrentSample->getNumSamples() / fNumSlices->realValue();
+    auto sliceMap = SliceMap::resolve(fSliceMap->get(), fState->fCurrentSample->getNumSamples(), *fNumSlices);
 
-    fSlices = std::make_unique<Slices>(numSlices);
-
-    int32 start = 0;
-    for(int i = 0; i < numSlices; i++, start += numSamplesPerSlice)
-    {
-      fSlices->addSlice(start, std::min(start + numSamplesPerSlice, fState->fCurrentSample->getNumSamples()), fVisibleSampleRange, iHorizontalRange);
-    }
+    fSlices = std::make_unique<Slices>(sliceMap.getNumSlices());
 
+    for(int i = 0; i < sliceMap.getNumSlices(); i++)
+      fSlices->addSlice(sliceMap.getStart(i), sliceMap.getEnd(i), fVisibleSampleRange, iHorizontalRange);
   }
 
   return fSlices ? fSlices.get() : nullptr;
 }
 
+//------------------------------------------------------------------------
+// SampleEditView::getZeroCrossingIndex
+//------------------------------------------------------------------------
+ZeroCrossingIndex const *SampleEditView::getZeroCrossingIndex() const
+{
+  auto const &zeroCrossingIndex = *fZeroCrossingIndex;
+
+  // the index may not have been built yet for the current sample
+  if(zeroCrossingIndex && fState->fCurrentSample->hasSamples() &&
+     zeroCrossingIndex->getNumSamples() == fState->fCurrentSample->getNumSamples())
+    return zeroCrossingIndex.get();
+
+  return nullptr;
+}
+
 //------------------------------------------------------------------------
 // SampleEditView::zoomToSelection
 //------------------------------------------------------------------------
@@ -61,6 +61,9 @@ protected:
 
   Slices *computeSlices(PixelRange const &iHorizontalRange);
 
+  // getZeroCrossingIndex (`nullptr` if not available for the current sample)
+  ZeroCrossingIndex const *getZeroCrossingIndex() const;
+
   void updateSelectedSampleRange(SampleRange const &iRange);
 
   void initState(GUIState *iGUIState) override;
@@ -73,7 +76,10 @@ private:
   GUIRawVstParam fOffsetPercent{};
   GUIRawVstParam fZoomPercent{};
   GUIVstParam<bool> fShowZeroCrossing{};
+  GUIVstParam<bool> fSnapToZeroCrossing{};
+  GUIJmbParam<SharedZeroCrossingIndex> fZeroCrossingIndex{};
   GUIVstParam<NumSlice> fNumSlices{};
+  GUIJmbParam<SharedSliceMap> fSliceMap{};
   GUIJmbParam<HostInfo> fHostInfo{};
   GUIJmbParam<PlayingState> fPlayingState{};
   GUIVstParam<bool> fZoomToSelection{};
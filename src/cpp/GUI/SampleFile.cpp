@@ -18,15 +18,19 @@
 
 #include "SampleFile.h"
 #include "SampleFileLoader.h"
+#include "SampleBuffersCache.h"
 #include "../SampleBuffers.hpp"
 
 #include <pongasoft/logging/logging.h>
 
 #include <sndfile.hh>
 
+#include <vector>
+
 namespace pongasoft::VST::SampleSplitter::GUI {
 
-constexpr int32 BUFFER_SIZE = 1024;
+// size of the chunks used when copying the temporary file from/to the state (fewer calls for large samples)
+constexpr int32 BUFFER_SIZE = 1 << 20; // 1MB
 
 //------------------------------------------------------------------------
 // SampleFile::extractFilename
@@ -64,53 +68,22 @@ std::unique_ptr<SampleFile> SampleFile::create(UTF8Path const &iFromFilePath)
 {
   auto toFilePath = createTempFilePath(iFromFilePath);
 
-  std::ifstream ifs(iFromFilePath.toNativePath(), std::fstream::binary);
-  if(!ifs)
+  // the fast copy never brings the content in memory: the content is hashed the first time it is needed (when
+  // loading the file on the loader thread, see `getContentHash`)
+  if(!copyFile(iFromFilePath, toFilePath))
   {
-    LOG_F(ERROR, "Could not open (R) %s", iFromFilePath.c_str());
+    LOG_F(ERROR, "Could not copy %s -> %s", iFromFilePath.c_str(), toFilePath.c_str());
     return nullptr;
   }
 
-  std::ofstream ofs(toFilePath.toNativePath(), std::fstream::binary);
+  auto fileSize = computeFileSize(toFilePath);
 
-  if(!ofs)
+  if(fileSize < 0)
   {
-    LOG_F(ERROR, "Could not open (W) %s", toFilePath.c_str());
+    LOG_F(ERROR, "Could not open (R) %s", toFilePath.c_str());
     return nullptr;
   }
 
-  char buf[BUFFER_SIZE];
-
-  bool complete = false;
-
-  uint64 fileSize = 0;
-
-  while(!complete)
-  {
-    ifs.read(buf, BUFFER_SIZE);
-
-    if(ifs.bad())
-    {
-      LOG_F(ERROR, "Error while reading file %s", iFromFilePath.c_str());
-      return nullptr;
-    }
-
-    if(ifs.gcount() > 0)
-    {
-      ofs.write(buf, ifs.gcount());
-      if(ofs.bad())
-      {
-        LOG_F(ERROR, "Error while writing file %s", toFilePath.c_str());
-        return nullptr;
-      }
-      fileSize += ifs.gcount();
-    }
-
-    complete = ifs.eof();
-  }
-
-  ofs.close();
-
   DLOG_F(INFO, "SampleFile::create - copied %s -> %s", iFromFilePath.c_str(), toFilePath.c_str());
 
   return std::make_unique<SampleFile>(iFromFilePath, toFilePath, static_cast<uint64>(fileSize));
@@ -188,7 +161,9 @@ std::unique_ptr<SampleFile> SampleFile::create(IBStreamer &iFromStream, UTF8Path
     return nullptr;
   }
 
-  char buf[BUFFER_SIZE];
+  std::vector<char> buf(BUFFER_SIZE);
+
+  ContentHasher hasher{};
 
   bool complete = false;
 
@@ -197,7 +172,7 @@ std::unique_ptr<SampleFile> SampleFile::create(IBStreamer &iFromStream, UTF8Path
   while(!complete)
   {
     int32 count{0};
-    auto res = iFromStream.getStream()->read(buf,
+    auto res = iFromStream.getStream()->read(buf.data(),
                                              static_cast<int32>(std::min(static_cast<uint64>(BUFFER_SIZE), expectedFileSize)),
                                              &count);
 
@@ -209,7 +184,9 @@ std::unique_ptr<SampleFile> SampleFile::create(IBStreamer &iFromStream, UTF8Path
 
     if(count > 0)
     {
-      ofs.write(buf, count);
+      hasher.update(buf.data(), static_cast<size_t>(count));
+
+      ofs.write(buf.data(), count);
       if(ofs.bad())
       {
         LOG_F(ERROR, "Error while writing file %s", toFilePath.c_str());
@@ -229,7 +206,7 @@ std::unique_ptr<SampleFile> SampleFile::create(IBStreamer &iFromStream, UTF8Path
   if(expectedFileSize == 0)
   {
     DLOG_F(INFO, "SampleFile::create - copied [stream] -> %s", toFilePath.c_str());
-    return std::make_unique<SampleFile>(iFromFilePath, toFilePath, iFileSize);
+    return std::make_unique<SampleFile>(iFromFilePath, toFilePath, iFileSize, hasher.digest());
   }
   else
   {
@@ -241,10 +218,63 @@ std::unique_ptr<SampleFile> SampleFile::create(IBStreamer &iFromStream, UTF8Path
 //------------------------------------------------------------------------
 // SampleFile::load
 //------------------------------------------------------------------------
-std::pair<std::shared_ptr<SampleBuffers32>, SampleRate> SampleFile::load(SampleRate iSampleRate, IErrorHandler *iErrorHandler) const
+SampleFile::LoadedSample SampleFile::load(SampleRate iSampleRate,
+                                          IErrorHandler *iErrorHandler,
+                                          load_progress_callback_t const &iProgress,
+                                          decoded_callback_t const &iDecoded,
+                                          EResamplingQuality iQuality) const
 {
-  auto buffers = loadOriginal(iErrorHandler);
+  auto &cache = SampleBuffersCache::instance();
+
+  std::optional<SampleBuffersCache::Key> key{};
+
+  if(!empty())
+  {
+    key = SampleBuffersCache::Key{getContentHash(), fFileSize, iSampleRate, EResamplingQuality::kHigh};
+
+    // the highest quality is always better (and as fast)
+    auto cached = cache.find(*key);
+    auto cachedQuality = EResamplingQuality::kHigh;
+
+    if(!cached && iQuality != EResamplingQuality::kHigh)
+    {
+      cached = cache.find(SampleBuffersCache::Key{key->fContentHash, fFileSize, iSampleRate, iQuality});
+      cachedQuality = iQuality;
+    }
+
+    if(cached)
+    {
+      DLOG_F(INFO, "SampleFile::load - %s already loaded (shared)", getTemporaryFilePath().c_str());
+      iErrorHandler->clearError();
+      return { cached->fBuffers, cached->fOriginalSampleRate, cachedQuality };
+    }
+  }
+
+  // adapts the progress of each stage
+  auto progress = [&iProgress](ELoadingStage iStage) -> SampleBuffers32::progress_callback_t {
+    if(!iProgress)
+      return {};
+    return [&iProgress, iStage](float iStageProgress) { return iProgress(iStage, iStageProgress); };
+  };
+
+  // the sample may have already been decoded (and resampled to another sample rate)
+  std::shared_ptr<SampleBuffers32> buffers{};
+
+  if(key)
+  {
+    if(auto original = cache.findOriginal(key->fContentHash, fFileSize))
+    {
+      DLOG_F(INFO, "SampleFile::load - %s already decoded (shared)", getTemporaryFilePath().c_str());
+      iErrorHandler->clearError();
+      buffers = original->fBuffers;
+    }
+  }
+
+  if(!buffers)
+    buffers = loadOriginal(iErrorHandler, progress(ELoadingStage::kDecoding), iDecoded);
+
   SampleRate originalSampleRate{};
+  auto quality = EResamplingQuality::kHigh;
 
   if(buffers)
   {
@@ -252,19 +282,64 @@ std::pair<std::shared_ptr<SampleBuffers32>, SampleRate> SampleFile::load(SampleR
 
     if(buffers->getSampleRate() != iSampleRate)
     {
+      // keeps the decoded sample to resample it to another sample rate later
+      if(key)
+        cache.add({key->fContentHash, fFileSize, originalSampleRate, EResamplingQuality::kHigh},
+                  {buffers, originalSampleRate});
+
       DLOG_F(INFO, "Resampling %f -> %f", buffers->getSampleRate(), iSampleRate);
-      buffers = buffers->resample(iSampleRate);
+      buffers = buffers->resample(iSampleRate, progress(ELoadingStage::kResampling), iQuality);
+      quality = iQuality;
+
+      if(key)
+        key->fQuality = iQuality;
     }
 
   }
 
-  return std::make_pair(std::move(buffers), originalSampleRate);
+  if(buffers && key)
+  {
+    auto value = cache.add(*key, {std::move(buffers), originalSampleRate});
+    return { value.fBuffers, value.fOriginalSampleRate, quality };
+  }
+
+  return { std::move(buffers), originalSampleRate, quality };
+}
+
+//------------------------------------------------------------------------
+// SampleFile::getContentHash
+//------------------------------------------------------------------------
+ContentHash const &SampleFile::getContentHash() const
+{
+  DCHECK_F(!empty());
+
+  auto &temporaryFile = *fTemporaryFile;
+
+  std::call_once(temporaryFile.fContentHashFlag, [&temporaryFile] {
+    ContentHasher hasher{};
+
+    std::ifstream ifs(temporaryFile.fFilePath.toNativePath(), std::fstream::binary);
+    std::vector<char> buf(BUFFER_SIZE);
+
+    while(ifs)
+    {
+      ifs.read(buf.data(), BUFFER_SIZE);
+      if(ifs.gcount() > 0)
+        hasher.update(buf.data(), static_cast<size_t>(ifs.gcount()));
+    }
+
+    temporaryFile.fContentHash = hasher.digest();
+  });
+
+  return temporaryFile.fContentHash;
 }
 
 //------------------------------------------------------------------------
 // SampleFile::loadOriginal
 //------------------------------------------------------------------------
-std::unique_ptr<SampleBuffers32> SampleFile::loadOriginal(IErrorHandler *iErrorHandler) const
+std::unique_ptr<SampleBuffers32> SampleFile::loadOriginal(IErrorHandler *iErrorHandler,
+                                                          SampleBuffers32::progress_callback_t const &iProgress,
+                                                          decoded_callback_t const &iDecoded) const
 {
   // if there is no file, we cannot load it
   if(empty())
@@ -281,7 +356,7 @@ std::unique_ptr<SampleBuffers32> SampleFile::loadOriginal(IErrorHandler *iErrorH
 
   if(loader->isValid())
   {
-    auto res = loader->load();
+    auto res = loader->load(iProgress, iDecoded);
     if(std::holds_alternative<std::string>(res))
     {
       iErrorHandler->handleError(std::get<std::string>(res));
@@ -314,7 +389,7 @@ tresult SampleFile::copyTo(IBStreamer &oStreamer) const
     return kResultFalse;
   }
 
-  char buf[BUFFER_SIZE];
+  std::vector<char> buf(BUFFER_SIZE);
 
   bool complete = false;
 
@@ -322,7 +397,7 @@ tresult SampleFile::copyTo(IBStreamer &oStreamer) const
 
   while(!complete)
   {
-    ifs.read(buf, BUFFER_SIZE);
+    ifs.read(buf.data(), BUFFER_SIZE);
 
     if(ifs.bad())
     {
@@ -334,7 +409,7 @@ tresult SampleFile::copyTo(IBStreamer &oStreamer) const
     if(count > 0)
     {
       int32 streamCount{0};
-      auto res = oStreamer.getStream()->write(buf, count, &streamCount);
+      auto res = oStreamer.getStream()->write(buf.data(), count, &streamCount);
 
       if(res == kResultOk)
       {
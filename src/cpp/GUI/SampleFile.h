@@ -27,7 +27,11 @@
 #include "../FilePath.h"
 #include "../SampleBuffers.h"
 #include "../Model.h"
+#include "ContentHash.h"
 
+#include <functional>
+#include <mutex>
+#include <optional>
 #include <variant>
 
 namespace pongasoft::VST::SampleSplitter::GUI {
@@ -50,20 +54,55 @@ public:
     kSampleFormatPCM32
   };
 
+  // the stages of loading a sample from the file selected by the user
+  enum class ELoadingStage
+  {
+    kNone,
+    kCopying,
+    kDecoding,
+    kResampling
+  };
+
 public:
   using load_result_t = std::variant<std::unique_ptr<SampleBuffers32>, std::string>;
 
+  // the sample returned by `load`
+  struct LoadedSample
+  {
+    std::shared_ptr<SampleBuffers32> fBuffers{};
+    SampleRate fOriginalSampleRate{};
+    EResamplingQuality fQuality{EResamplingQuality::kHigh}; // the quality actually used (kHigh when not resampled)
+  };
+
+  /**
+   * Called while loading with the current stage and its progress (`[0, 1]`). Returning `false` cancels the load (which
+   * then returns `nullptr`). */
+  using load_progress_callback_t = std::function<bool(ELoadingStage iStage, float iProgress)>;
+
+  /**
+   * Called while decoding with the samples decoded so far (see `SampleFileLoader::decoded_callback_t`) */
+  using decoded_callback_t = std::function<void(SampleBuffers32 const &iBuffers, int32 iNumSamples)>;
+
 public:
   SampleFile() = default; // for param API
 
   SampleFile(SampleFile const &iOther) = default; // for param API
 
   /**
-   * Handle the sample as a (temporary) file which will be deleted when the destructor runs */
-  SampleFile(UTF8Path iOriginalFilePath, UTF8Path iTemporaryFilePath, uint64 iFileSize) :
+   * Handle the sample as a (temporary) file which will be deleted when the destructor runs. `iContentHash` is the
+   * hash of the content when already computed (while reading it from the state), computed the first time it is
+   * needed otherwise. */
+  SampleFile(UTF8Path iOriginalFilePath,
+             UTF8Path iTemporaryFilePath,
+             uint64 iFileSize,
+             std::optional<ContentHash> const &iContentHash = std::nullopt) :
     fOriginalFilePath(std::move(iOriginalFilePath)),
     fTemporaryFile{std::make_shared<TemporaryFile>(iTemporaryFilePath)},
-    fFileSize{iFileSize} {}
+    fFileSize{iFileSize}
+  {
+    if(iContentHash)
+      std::call_once(fTemporaryFile->fContentHashFlag, [this, &iContentHash] { fTemporaryFile->fContentHash = *iContentHash; });
+  }
 
   // Return `true` if this object is pointing to a valid sample file
   bool empty() const { return fTemporaryFile == nullptr; }
@@ -77,11 +116,30 @@ public:
   // getFileSize
   uint64 getFileSize() const { return fFileSize; }
 
-  // Loads the sample from the file and make sure it is the proper sample rate
-  std::pair<std::shared_ptr<SampleBuffers32>, SampleRate> load(SampleRate iSampleRate, IErrorHandler *iErrorHandler) const;
+  /**
+   * @return the hash of the content of the file (computed while reading it from the state or the first time it is
+   *         needed, see `ContentHasher`) */
+  ContentHash const &getContentHash() const;
+
+  /**
+   * Loads the sample from the file and make sure it is the proper sample rate. The buffers are shared (via
+   * `SampleBuffersCache`) with any other instance of the plugin which loaded the same sample at the same rate.
+   *
+   * `iDecoded` is only called when the sample is actually decoded (not when shared) and with the samples at the
+   * original sample rate.
+   *
+   * Asking for `EResamplingQuality::kFast` may return a sample resampled with the highest quality (if already
+   * available) which is reflected in `LoadedSample::fQuality`. */
+  LoadedSample load(SampleRate iSampleRate,
+                    IErrorHandler *iErrorHandler,
+                    load_progress_callback_t const &iProgress = {},
+                    decoded_callback_t const &iDecoded = {},
+                    EResamplingQuality iQuality = EResamplingQuality::kHigh) const;
 
   // Loads the sample from the file without resampling
-  std::unique_ptr<SampleBuffers32> loadOriginal(IErrorHandler *iErrorHandler) const;
+  std::unique_ptr<SampleBuffers32> loadOriginal(IErrorHandler *iErrorHandler,
+                                                SampleBuffers32::progress_callback_t const &iProgress = {},
+                                                decoded_callback_t const &iDecoded = {}) const;
 
   // copyTo
   tresult copyTo(IBStreamer &oStreamer) const;
@@ -119,6 +177,8 @@ private:
     }
     ~TemporaryFile();
     UTF8Path fFilePath{};
+    std::once_flag fContentHashFlag{};
+    ContentHash fContentHash{};
   };
 
 private:
@@ -47,7 +47,7 @@ public:
     return fError;
   }
 
-  load_result_t load() override;
+  load_result_t load(progress_callback_t const &iProgress, decoded_callback_t const &iDecoded) override;
 
   std::optional<SampleInfo> info() override;
 
@@ -92,7 +92,7 @@ public:
     return fError;
   }
 
-  load_result_t load() override;
+  load_result_t load(progress_callback_t const &iProgress, decoded_callback_t const &iDecoded) override;
 
   std::optional<SampleInfo> info() override;
 
@@ -121,7 +121,7 @@ public:
 
   bool isValid() const override { return false; }
   std::string error() const override { return fError; }
-  load_result_t load() override { return fError; }
+  load_result_t load(progress_callback_t const &, decoded_callback_t const &) override { return fError; }
   std::optional<SampleInfo> info() override { return std::nullopt; }
 
 private:
@@ -171,7 +171,7 @@ std::string printf(const std::string& format, Args... args )
 //------------------------------------------------------------------------
 // SndFileLoader::load
 //------------------------------------------------------------------------
-SampleFileLoader::load_result_t SndFileLoader::load()
+SampleFileLoader::load_result_t SndFileLoader::load(progress_callback_t const &iProgress, decoded_callback_t const &iDecoded)
 {
   if(!isValid())
     return fError;
@@ -228,6 +228,12 @@ SampleFileLoader::load_result_t SndFileLoader::load()
       // adjust number of frames to read
       expectedFrames -= frameCountRead;
       complete = expectedFrames == 0;
+
+      if(iProgress && !iProgress(static_cast<float>(frameCount - expectedFrames) / static_cast<float>(frameCount)))
+        return std::string("Loading cancelled");
+
+      if(iDecoded && !complete)
+        iDecoded(*ptr, sampleIndex);
     }
   }
 
@@ -254,7 +260,7 @@ std::optional<SampleFileLoader::SampleInfo> SndFileLoader::info()
 //------------------------------------------------------------------------
 // MiniaudioLoader::load
 //------------------------------------------------------------------------
-SampleFileLoader::load_result_t MiniaudioLoader::load()
+SampleFileLoader::load_result_t MiniaudioLoader::load(progress_callback_t const &iProgress, decoded_callback_t const &iDecoded)
 {
   if(!isValid())
     return fError;
@@ -319,6 +325,12 @@ SampleFileLoader::load_result_t MiniaudioLoader::load()
       // adjust number of frames to read
       expectedFrames -= frameCountRead;
       complete = expectedFrames == 0;
+
+      if(iProgress && !iProgress(static_cast<float>(frameCount - expectedFrames) / static_cast<float>(frameCount)))
+        return std::string("Loading cancelled");
+
+      if(iDecoded && !complete)
+        iDecoded(*ptr, sampleIndex);
     }
   }
 
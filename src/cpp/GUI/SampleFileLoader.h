@@ -19,6 +19,7 @@
 #ifndef VST_SAM_SPL_64_SAMPLE_FILE_LOADER_H
 #define VST_SAM_SPL_64_SAMPLE_FILE_LOADER_H
 
+#include <functional>
 #include <memory>
 #include <variant>
 #include <optional>
@@ -52,12 +53,22 @@ public:
 public:
   using load_result_t = std::variant<std::unique_ptr<SampleBuffers32>, std::string>;
 
+  /**
+   * Called while loading with the fraction of the sample loaded so far (`[0, 1]`). Returning `false` cancels the load
+   * (which then returns an error). */
+  using progress_callback_t = std::function<bool(float iProgress)>;
+
+  /**
+   * Called while loading with the samples decoded so far: only the first `iNumSamples` samples of `iBuffers` are
+   * decoded (the others are not yet). This allows for auditioning the beginning of the sample (progressive load). */
+  using decoded_callback_t = std::function<void(SampleBuffers32 const &iBuffers, int32 iNumSamples)>;
+
 public:
   virtual ~SampleFileLoader() = default;
 
   virtual bool isValid() const = 0;
   virtual std::string error() const = 0;
-  virtual load_result_t load() = 0;
+  virtual load_result_t load(progress_callback_t const &iProgress = {}, decoded_callback_t const &iDecoded = {}) = 0;
   virtual std::optional<SampleInfo> info() = 0;
 
   static std::unique_ptr<SampleFileLoader> create(UTF8Path const &iFilePath);
@@ -15,6 +15,7 @@ void SampleInfoView::registerParameters()
 {
   registerParam(fState->fCurrentSample);
   registerParam(fState->fWESelectedSampleRange);
+  registerParam(fState->fSampleLoadingState);
   computeInfo();
 }
 
@@ -57,6 +58,24 @@ Steinberg::String formatDuration(SampleRate iSampleRate, int32 iNumSamples)
                                       ms.count());
   }
 }
+
+//------------------------------------------------------------------------
+// formatLoadingStage
+//------------------------------------------------------------------------
+char const *formatLoadingStage(SampleFile::ELoadingStage iStage)
+{
+  switch(iStage)
+  {
+    case SampleFile::ELoadingStage::kCopying:
+      return "Copying";
+    case SampleFile::ELoadingStage::kDecoding:
+      return "Decoding";
+    case SampleFile::ELoadingStage::kResampling:
+      return "Resampling";
+    default:
+      return "";
+  }
+}
 }
 
 //------------------------------------------------------------------------
@@ -68,8 +87,16 @@ void SampleInfoView::computeInfo()
 
   auto const &currentSample = *fState->fCurrentSample;
   auto const &currentFile = *fState->fSampleFile;
+  auto const &loadingState = *fState->fSampleLoadingState;
 
-  if(currentSample.hasSamples() && !currentFile.empty())
+  if(loadingState.isLoading())
+  {
+    s.printf("Loading %s - %s %d%%",
+             SampleFile::extractFilename(loadingState.fFilePath).c_str(),
+             internal::formatLoadingStage(loadingState.fStage),
+             static_cast<int32>(loadingState.fProgress * 100));
+  }
+  else if(currentSample.hasSamples() && !currentFile.empty())
   {
     s.printf("%s @ %d | %llu bytes - %s - %d [%s]",
              SampleFile::extractFilename(currentFile.getOriginalFilePath()).c_str(),
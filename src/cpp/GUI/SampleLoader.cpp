@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "SampleLoader.h"
+
+#include <pongasoft/logging/logging.h>
+
+#include <exception>
+
+namespace pongasoft::VST::SampleSplitter::GUI {
+
+//------------------------------------------------------------------------
+// SampleLoader::load
+//------------------------------------------------------------------------
+void SampleLoader::load(UTF8Path const &iFilePath, SampleRate iSampleRate, EResamplingQuality iQuality)
+{
+  start(iFilePath, nullptr, iSampleRate, iQuality);
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::load
+//------------------------------------------------------------------------
+void SampleLoader::load(SampleFile const &iSampleFile, SampleRate iSampleRate, EResamplingQuality iQuality)
+{
+  if(iSampleFile.empty())
+    return;
+
+  start(iSampleFile.getOriginalFilePath(), std::make_unique<SampleFile>(iSampleFile), iSampleRate, iQuality);
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::start
+//------------------------------------------------------------------------
+void SampleLoader::start(UTF8Path const &iFilePath,
+                         std::unique_ptr<SampleFile> iSampleFile,
+                         SampleRate iSampleRate,
+                         EResamplingQuality iQuality)
+{
+  cancel();
+
+  DLOG_F(INFO, "SampleLoader::load(%s)", iFilePath.c_str());
+
+  fFilePath = iFilePath;
+  fLoading = true;
+  fStage.store(iSampleFile ? SampleFile::ELoadingStage::kDecoding : SampleFile::ELoadingStage::kCopying);
+  fProgress.store(0);
+  fCancel.store(false);
+
+  fThread = std::thread([this, filePath = iFilePath, sampleFile = std::move(iSampleFile), iSampleRate, iQuality]() mutable {
+    doLoad(filePath, std::move(sampleFile), iSampleRate, iQuality);
+  });
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::cancel
+//------------------------------------------------------------------------
+void SampleLoader::cancel()
+{
+  fCancel.store(true);
+  if(fThread.joinable())
+    fThread.join();
+
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    fResult = std::nullopt;
+    fPreview = std::nullopt;
+  }
+
+  fLoading = false;
+  fStage.store(SampleFile::ELoadingStage::kNone);
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::getState
+//------------------------------------------------------------------------
+SampleLoadingState SampleLoader::getState() const
+{
+  if(!fLoading)
+    return {};
+
+  return {fStage.load(), fProgress.load(), fFilePath};
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::popResult
+//------------------------------------------------------------------------
+std::optional<SampleLoader::Result> SampleLoader::popResult()
+{
+  std::optional<Result> res{};
+
+  {
+    std::lock_guard<std::mutex> lock{fMutex};
+    std::swap(res, fResult);
+  }
+
+  if(res)
+  {
+    // the worker thread is done (publishing the result is the last thing it does)
+    if(fThread.joinable())
+      fThread.join();
+    fLoading = false;
+    fStage.store(SampleFile::ELoadingStage::kNone);
+  }
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::popPreview
+//------------------------------------------------------------------------
+std::optional<SampleLoader::Preview> SampleLoader::popPreview()
+{
+  std::optional<Preview> res{};
+
+  std::lock_guard<std::mutex> lock{fMutex};
+  std::swap(res, fPreview);
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// SampleLoader::doLoad
+//------------------------------------------------------------------------
+void SampleLoader::doLoad(UTF8Path const &iFilePath,
+                          std::unique_ptr<SampleFile> iSampleFile,
+                          SampleRate iSampleRate,
+                          EResamplingQuality iQuality)
+{
+  // the error handler of the plugin can only be used from the UI thread => errors are captured and reported with
+  // the result
+  struct ErrorHandler : public IErrorHandler
+  {
+    void handleError(std::string const &iErrorMessage) override { fError = iErrorMessage; }
+    void clearError() override { fError = std::nullopt; }
+    std::optional<std::string> fError{};
+  };
+
+  auto progress = [this](SampleFile::ELoadingStage iStage, float iProgress) {
+    fStage.store(iStage);
+    fProgress.store(iProgress);
+    return !fCancel.load();
+  };
+
+  int32 nextPreviewNumSamples = -1;
+
+  auto decoded = [this, iSampleRate, &nextPreviewNumSamples](SampleBuffers32 const &iBuffers, int32 iNumSamples) {
+    if(nextPreviewNumSamples < 0)
+      nextPreviewNumSamples = static_cast<int32>(iBuffers.getSampleRate() * PROGRESSIVE_LOAD_MIN_DURATION_SECONDS);
+
+    if(iNumSamples < nextPreviewNumSamples || fCancel.load())
+      return;
+
+    // the next preview is (at least) twice as long
+    nextPreviewNumSamples = iNumSamples * 2;
+
+    std::shared_ptr<SampleBuffers32> buffers = iBuffers.first(iNumSamples);
+
+    // the preview has the length of the entire sample (same formula as `resample`) so that the slices are the same
+    // as the ones of the loaded sample
+    auto numSamples = iBuffers.getNumSamples();
+
+    // the preview is temporary => always as fast as possible
+    if(buffers && buffers->getSampleRate() != iSampleRate)
+    {
+      buffers = buffers->resample(iSampleRate, [this](float) { return !fCancel.load(); }, EResamplingQuality::kFast);
+      numSamples = static_cast<int32>(numSamples * iSampleRate / iBuffers.getSampleRate());
+    }
+
+    // the part not decoded yet is silent
+    if(buffers)
+      buffers = buffers->pad(numSamples);
+
+    if(buffers)
+    {
+      std::lock_guard<std::mutex> lock{fMutex};
+      fPreview = Preview{std::move(buffers), iBuffers.getSampleRate()};
+    }
+  };
+
+  Result result{};
+  result.fFilePath = iFilePath;
+
+  ErrorHandler errorHandler{};
+
+  // an exception (for example running out of memory for a very large sample) must not escape the worker thread: it
+  // is reported like any other error so that the UI restores the previous sample
+  try
+  {
+    // a file selected by the user is copied first (and can be auditioned while loading)
+    auto sampleFile = std::move(iSampleFile);
+    SampleFile::decoded_callback_t decodedCallback{};
+    if(!sampleFile)
+    {
+      sampleFile = SampleFile::create(iFilePath);
+      progress(SampleFile::ELoadingStage::kCopying, 1.0f);
+      decodedCallback = decoded;
+    }
+
+    if(sampleFile && !fCancel.load())
+    {
+      auto [buffers, originalSampleRate, quality] = sampleFile->load(iSampleRate, &errorHandler, progress, decodedCallback, iQuality);
+      if(buffers)
+      {
+        result.fSampleFile = std::move(sampleFile);
+        result.fBuffers = std::move(buffers);
+        result.fOriginalSampleRate = originalSampleRate;
+        result.fQuality = quality;
+      }
+    }
+  }
+  catch(std::exception const &e)
+  {
+    LOG_F(ERROR, "SampleLoader::doLoad(%s) - %s", iFilePath.c_str(), e.what());
+    result = Result{iFilePath};
+    errorHandler.handleError(std::string("Could not load the sample (") + e.what() + ")");
+  }
+  catch(...)
+  {
+    LOG_F(ERROR, "SampleLoader::doLoad(%s) - unknown error", iFilePath.c_str());
+    result = Result{iFilePath};
+    errorHandler.handleError("Could not load the sample");
+  }
+
+  // a cancelled load has no result (and the temporary file, if any, is deleted)
+  if(fCancel.load())
+  {
+    DLOG_F(INFO, "SampleLoader::doLoad(%s) - cancelled", iFilePath.c_str());
+    return;
+  }
+
+  result.fError = errorHandler.fError;
+
+  std::lock_guard<std::mutex> lock{fMutex};
+  fPreview = std::nullopt; // superseded by the result
+  fResult = std::move(result);
+}
+
+}
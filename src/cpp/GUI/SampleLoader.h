@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_SAMPLELOADER_H
+#define VST_SAM_SPL_64_SAMPLELOADER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "SampleFile.h"
+
+namespace pongasoft::VST::SampleSplitter::GUI {
+
+/**
+ * The progress of the sample being loaded in the background (see `SampleLoader`), so that the views can show it */
+struct SampleLoadingState
+{
+  SampleFile::ELoadingStage fStage{SampleFile::ELoadingStage::kNone};
+  float fProgress{}; // progress of the current stage [0, 1]
+  UTF8Path fFilePath{};
+
+  // isLoading
+  inline bool isLoading() const { return fStage != SampleFile::ELoadingStage::kNone; }
+
+  bool operator==(SampleLoadingState const &rhs) const
+  {
+    return fStage == rhs.fStage && fProgress == rhs.fProgress && fFilePath.cpp_str() == rhs.fFilePath.cpp_str();
+  }
+
+  bool operator!=(SampleLoadingState const &rhs) const
+  {
+    return !(rhs == *this);
+  }
+};
+
+/**
+ * Loads a sample selected by the user (copy to a temporary file, decode and resample) on a worker thread so that the
+ * UI is never blocked, even for very long files. Starting a new load cancels the one in progress (if any).
+ *
+ * While decoding, the beginning of the sample is made available (`popPreview`) so that it can be auditioned without
+ * waiting for the entire sample to be loaded (progressive load). A preview has the length of the entire sample (the
+ * part not decoded yet is silent) so that each slice plays the same region during and after the load. The decoded
+ * part grows geometrically (each preview decodes at least twice as much as the previous one) so that there are only a
+ * few previews (logarithmic in the size of the sample).
+ *
+ * All methods must be called from the UI thread which polls `getState` (for the progress), `popPreview` (for the
+ * beginning of the sample) and `popResult` (for the outcome). */
+class SampleLoader
+{
+public:
+  struct Result
+  {
+    UTF8Path fFilePath{};
+    std::unique_ptr<SampleFile> fSampleFile{};
+    std::shared_ptr<SampleBuffers32> fBuffers{};
+    SampleRate fOriginalSampleRate{};
+    EResamplingQuality fQuality{EResamplingQuality::kHigh}; // the quality actually used (see `SampleFile::load`)
+    std::optional<std::string> fError{}; // when the sample could not be loaded
+  };
+
+  // the beginning of the sample being loaded (resampled and padded with silence to the length of the sample)
+  struct Preview
+  {
+    std::shared_ptr<SampleBuffers32> fBuffers{};
+    SampleRate fOriginalSampleRate{};
+  };
+
+public:
+  // Destructor (cancels and waits for the worker thread)
+  ~SampleLoader() { cancel(); }
+
+  /**
+   * Starts loading the sample (resampled to `iSampleRate`) on the worker thread, cancelling the current load (if
+   * any) */
+  void load(UTF8Path const &iFilePath,
+            SampleRate iSampleRate,
+            EResamplingQuality iQuality = EResamplingQuality::kHigh);
+
+  /**
+   * Same as above for a sample file already owned by the plugin (no copy and no preview), for example to resample it
+   * again with a higher quality */
+  void load(SampleFile const &iSampleFile,
+            SampleRate iSampleRate,
+            EResamplingQuality iQuality = EResamplingQuality::kHigh);
+
+  /**
+   * Cancels the current load (if any) and waits for the worker thread to be done (which is quick since the worker
+   * checks for cancellation regularly) */
+  void cancel();
+
+  /**
+   * @return `true` while a sample is being loaded (including when it is loaded but `popResult` has not been called
+   *         yet) */
+  inline bool isLoading() const { return fLoading; }
+
+  /**
+   * @return the progress of the current load */
+  SampleLoadingState getState() const;
+
+  /**
+   * @return the result of the load once it is complete (only once), `std::nullopt` while loading */
+  std::optional<Result> popResult();
+
+  /**
+   * @return the most recent (and longest) beginning of the sample decoded so far (only once), `std::nullopt` if
+   *         there is none since the last call */
+  std::optional<Preview> popPreview();
+
+private:
+  // starts the worker thread (loading `iSampleFile` or copying `iFilePath` first when there is none)
+  void start(UTF8Path const &iFilePath,
+             std::unique_ptr<SampleFile> iSampleFile,
+             SampleRate iSampleRate,
+             EResamplingQuality iQuality);
+
+  // the load itself (worker thread)
+  void doLoad(UTF8Path const &iFilePath,
+              std::unique_ptr<SampleFile> iSampleFile,
+              SampleRate iSampleRate,
+              EResamplingQuality iQuality);
+
+private:
+  UTF8Path fFilePath{}; // UI thread only
+  bool fLoading{}; // UI thread only
+
+  std::atomic<SampleFile::ELoadingStage> fStage{SampleFile::ELoadingStage::kNone};
+  std::atomic<float> fProgress{};
+  std::atomic<bool> fCancel{};
+
+  std::mutex fMutex{};
+  std::optional<Result> fResult{}; // guarded by fMutex
+  std::optional<Preview> fPreview{}; // guarded by fMutex
+
+  std::thread fThread{};
+};
+
+}
+
+#endif //VST_SAM_SPL_64_SAMPLELOADER_H
@@ -37,16 +37,27 @@ void SampleMgr::initState(VST::GUI::GUIState *iGUIState)
 void SampleMgr::registerParameters()
 {
   DLOG_F(INFO, "SampleMgr::registerParameters()");
-  registerCallback<SharedSampleBuffersVersion>(fParams->fRTNewSampleMessage,
-                                               [this] (GUIJmbParam<SharedSampleBuffersVersion> &iParam) {
-                                                 loadSampleFromSampling(*iParam);
-                                               });
+  registerCallback<RTNewSample>(fParams->fRTNewSampleMessage,
+                                [this] (GUIJmbParam<RTNewSample> &iParam) {
+                                  loadSampleFromSampling(*iParam);
+                                });
 
   registerCallback<SharedSampleBuffersMgr32 *>(fParams->fSharedSampleBuffersMgrPtr,
                                                [this] (GUIJmbParam<SharedSampleBuffersMgr32 *> &iParam) {
                                                  onMgrReceived(*iParam);
                                                });
 
+  fSharedSliceMapMgrPtr =
+    registerCallback<SharedSliceMapMgr *>(fParams->fSharedSliceMapMgrPtr,
+                                          [this] (GUIJmbParam<SharedSliceMapMgr *> &) {
+                                            publishSliceMap();
+                                          });
+
+  registerCallback<SamplerBuffersRequest>(fParams->fSamplerBuffersRequest,
+                                          [this] (GUIJmbParam<SamplerBuffersRequest> &iParam) {
+                                            onSamplerBuffersRequest(*iParam);
+                                          });
+
   // we need to be notified when:
   // there is a new sample rate (GUI does not have access to it otherwise)
   registerCallback<SampleRate>(fState->fSampleRate, [this](GUIJmbParam<SampleRate> &iParam) {
@@ -56,8 +67,38 @@ void SampleMgr::registerParameters()
 
   fOffsetPercent = registerParam(fParams->fWEOffsetPercent, false);
   fZoomPercent = registerParam(fParams->fWEZoomPercent, false);
-  fNumSlices = registerParam(fParams->fNumSlices, false);
+  fNumSlices = registerCallback(fParams->fNumSlices, [this]() { updateSliceMap(); });
+  fSlicingMode = registerCallback(fParams->fSlicingMode, [this]() { updateSliceMap(); });
+  fSlicingSensitivity = registerCallback(fParams->fSlicingSensitivity, [this]() { updateSliceMap(); });
+  fShowZeroCrossing = registerCallback(fParams->fWEShowZeroCrossing, [this]() { updateZeroCrossingIndex(); });
+  fSnapToZeroCrossing = registerCallback(fParams->fWESnapToZeroCrossing, [this]() {
+    updateZeroCrossingIndex();
+    updateSliceMap();
+  });
+
+  // the slices (and zero crossings) of a new sample must be computed again
+  registerCallback<CurrentSample>(fState->fCurrentSample, [this](GUIJmbParam<CurrentSample> &) {
+    updateZeroCrossingIndex();
+    updateSliceMap();
+  });
+  // RT could not start sampling (the previous take streamed to disk is still being written)
+  registerCallback<SamplingState>(fState->fSamplingState, [this](GUIJmbParam<SamplingState> &iParam) {
+    if(iParam->fPercentSampled == PERCENT_SAMPLED_BUSY)
+      fState->handleError("Cannot sample while the previous take is being saved");
+  });
   fGUINewSampleMessage = registerParam(fParams->fGUINewSampleMessage, false);
+  fGUISamplerBuffersMessage = registerParam(fParams->fGUISamplerBuffersMessage, false);
+  fGUINewSliceMapMessage = registerParam(fParams->fGUINewSliceMapMessage, false);
+  fResamplingPolicy = registerParam(fParams->fResamplingPolicy, false);
+  fOfflineRendering = registerCallback<bool>(fParams->fOfflineRendering, [this](GUIJmbParam<bool> &iParam) {
+    if(*iParam)
+      onOfflineRendering();
+  });
+
+  // RT never releases the objects it drops: they are released here, even when nothing else happens on the UI side
+  fReclaimTimer = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer>([this](VSTGUI::CVSTGUITimer *) {
+    reclaimSharedObjects();
+  }, SHARED_OBJECTS_RECLAIM_PERIOD_MS, true);
 }
 
 //------------------------------------------------------------------------
@@ -72,7 +113,8 @@ tresult SampleMgr::loadSampleFromUser(UTF8Path const &iFilePath)
 
   if(executeAction(action))
   {
-    resetSettings();
+    // the sample is loaded in the background: the settings are reset once it is loaded (see onSampleLoaded)
+    fPendingLoad.fResetSettings = true;
     return kResultOk;
   }
 
@@ -82,16 +124,23 @@ tresult SampleMgr::loadSampleFromUser(UTF8Path const &iFilePath)
 //------------------------------------------------------------------------
 // SampleMgr::loadSampleFromSampling (from RT sampling)
 //------------------------------------------------------------------------
-tresult SampleMgr::loadSampleFromSampling(SharedSampleBuffersVersion iVersion)
+tresult SampleMgr::loadSampleFromSampling(RTNewSample const &iNewSample)
 {
   DLOG_F(INFO, "SampleMgr::loadSampleFromSampling");
 
+  // the new sample replaces the sample being loaded (if any)
+  cancelLoad();
+
   auto action = SampleAction{SampleAction::Type::kSample};
-  action.fRTVersion = iVersion;
+  action.fRTNewSample = iNewSample;
 
   if(executeAction(action))
   {
-    resetSettings();
+    // a take streamed to disk is loaded in the background: the settings are reset once it is loaded
+    if(iNewSample.fStreamTakeId > 0)
+      fPendingLoad.fResetSettings = true;
+    else
+      resetSettings();
     return kResultOk;
   }
 
@@ -105,11 +154,14 @@ tresult SampleMgr::loadSampleFromState()
 {
   DLOG_F(INFO, "SampleMgr::loadSampleFromState");
 
+  // the state replaces the sample being loaded (if any)
+  cancelLoad();
+
   auto const &sampleFile = *fState->fSampleFile;
 
   if(!sampleFile.empty())
   {
-    auto [buffers, originalSampleRate] = sampleFile.load(*fState->fSampleRate, fState);
+    auto [buffers, originalSampleRate, quality] = sampleFile.load(*fState->fSampleRate, fState, {}, {}, getResamplingQuality());
 
     if(buffers)
     {
@@ -127,6 +179,8 @@ tresult SampleMgr::loadSampleFromState()
       // notifying RT of slices settings right after loading
       fState->fSlicesSettings.broadcast();
 
+      refineCurrentSample(quality);
+
       return kResultOk;
     }
 
@@ -142,8 +196,9 @@ tresult SampleMgr::loadSampleFromState()
 //------------------------------------------------------------------------
 void SampleMgr::resetSettings()
 {
-  // reset number of slices
-  fState->getGUIVstParameter(fParams->fNumSlices)->resetToDefault();
+  // reset number of slices (unless determined by the transients)
+  if(*fSlicingMode == ESlicingMode::kSlicingUniform)
+    fState->getGUIVstParameter(fParams->fNumSlices)->resetToDefault();
 
   // reset slice settings
   fState->fSlicesSettings.resetToDefault();
@@ -152,6 +207,128 @@ void SampleMgr::resetSettings()
   fState->fWESelectedSampleRange.resetToDefault();
 }
 
+//------------------------------------------------------------------------
+// SampleMgr::updateSliceMap
+//------------------------------------------------------------------------
+void SampleMgr::updateSliceMap()
+{
+  auto const &currentSample = *fState->fCurrentSample;
+
+  auto numSamples = currentSample.hasSamples() ? currentSample.getNumSamples() : 0;
+
+  std::vector<int32> starts{};
+
+  // a preview is mostly silence and replaced shortly after => not worth analyzing (uniform slices until loaded)
+  if(currentSample.hasSamples() && !isPreviewing())
+  {
+    if(*fSlicingMode == ESlicingMode::kSlicingTransients)
+    {
+      if(auto detectionFunction = fTransientAnalyzer.getResult(currentSample.getSharedBuffers()))
+      {
+        starts = TransientDetector::pickSlices(*detectionFunction, *fSlicingSensitivity, numSamples, NUM_SLICES);
+
+        // the number of slices is determined by the transients (which calls this method again)
+        fNumSlices.setValue(NumSlice{static_cast<NumSlice::int_type>(starts.size())});
+      }
+      else
+        waitForAnalysis();
+    }
+    else if(*fSnapToZeroCrossing)
+    {
+      auto uniform = SliceMap::uniform(numSamples, *fNumSlices);
+      for(int32 i = 0; i < uniform.getNumSlices(); i++)
+        starts.emplace_back(uniform.getStart(i));
+    }
+
+    if(!starts.empty() && *fSnapToZeroCrossing)
+    {
+      if(auto zeroCrossingIndex = fZeroCrossingAnalyzer.getResult(currentSample.getSharedBuffers()))
+      {
+        auto maxDistance =
+          static_cast<int32>(currentSample.getSampleRate() * ZERO_CROSSING_SNAP_MAX_DISTANCE_MS / 1000.0);
+        zeroCrossingIndex->snap(starts, maxDistance);
+      }
+      else
+        waitForAnalysis();
+    }
+  }
+
+  auto sliceMap = starts.empty() ? SliceMap::uniform(numSamples, *fNumSlices) : SliceMap{numSamples, starts};
+
+  // the views and RT only need to be updated when the slices actually change
+  auto const &currentSliceMap = *fState->fSliceMap;
+  if(!currentSliceMap || *currentSliceMap != sliceMap)
+  {
+    fState->fSliceMap.update(std::make_shared<SliceMap const>(sliceMap));
+    publishSliceMap();
+  }
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::publishSliceMap
+//------------------------------------------------------------------------
+void SampleMgr::publishSliceMap()
+{
+  auto sliceMapMgr = *fSharedSliceMapMgrPtr;
+  auto const &sliceMap = *fState->fSliceMap;
+
+  if(sliceMapMgr && sliceMap)
+    fGUINewSliceMapMessage.broadcast(sliceMapMgr->uiSetObject(sliceMap));
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::updateZeroCrossingIndex
+//------------------------------------------------------------------------
+void SampleMgr::updateZeroCrossingIndex()
+{
+  SharedZeroCrossingIndex zeroCrossingIndex{};
+
+  auto const &currentSample = *fState->fCurrentSample;
+
+  // the index is only built when needed (it can be as large as the sample itself) and never for a preview
+  if((*fShowZeroCrossing || *fSnapToZeroCrossing) && currentSample.hasSamples() && !isPreviewing())
+  {
+    zeroCrossingIndex = fZeroCrossingAnalyzer.getResult(currentSample.getSharedBuffers());
+    if(!zeroCrossingIndex)
+      waitForAnalysis();
+  }
+
+  fState->fZeroCrossingIndex.update(zeroCrossingIndex);
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::waitForAnalysis
+//------------------------------------------------------------------------
+void SampleMgr::waitForAnalysis()
+{
+  if(!fAnalysisTimer)
+  {
+    fAnalysisTimer = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer>([this](VSTGUI::CVSTGUITimer *iTimer) {
+      if(!fTransientAnalyzer.isComputing() && !fZeroCrossingAnalyzer.isComputing())
+      {
+        iTimer->stop();
+        updateZeroCrossingIndex();
+        updateSliceMap();
+      }
+    }, 50, false);
+  }
+  fAnalysisTimer->start();
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::reclaimSharedObjects
+//------------------------------------------------------------------------
+void SampleMgr::reclaimSharedObjects()
+{
+  getSharedMgr()->uiReclaim();
+
+  if(auto sliceMapMgr = *fSharedSliceMapMgrPtr)
+    sliceMapMgr->uiReclaim();
+
+  if(fSamplerBuffersMgr)
+    fSamplerBuffersMgr->uiReclaim();
+}
+
 //------------------------------------------------------------------------
 // SampleMgr::getSharedMgr
 //------------------------------------------------------------------------
@@ -207,27 +384,115 @@ tresult SampleMgr::onSampleRateChanged(SampleRate iSampleRate)
 {
   DLOG_F(INFO, "SampleMgr::onSampleRateChanged(%f)", iSampleRate);
 
+  // the sample being loaded (if any) must be resampled to the new sample rate => start again (once the sample it
+  // replaces, if previewed, is restored)
+  std::optional<PendingLoad> pendingLoad{};
+  if(fSampleLoader.isLoading())
+  {
+    pendingLoad = fPendingLoad;
+    cancelLoad();
+  }
+
   auto currentSample = fState->fCurrentSample;
 
   if(currentSample->hasSamples() && currentSample->getSampleRate() != iSampleRate)
   {
-    auto [buffers, originalSampleRate] = fState->fSampleFile->load(*fState->fSampleRate, fState);
+    auto [buffers, originalSampleRate, quality] = fState->fSampleFile->load(*fState->fSampleRate, fState, {}, {}, getResamplingQuality());
     if(buffers)
     {
       currentSample.setValue({ buffers, originalSampleRate, currentSample->getSource(), currentSample->getUpdateType() });
       auto version = getSharedMgr()->uiSetObject(currentSample->getSharedBuffers());
       fGUINewSampleMessage.broadcast(version);
+      refineCurrentSample(quality);
     }
   }
 
+  if(pendingLoad)
+  {
+    loadSampleInBackground(pendingLoad->fAction, pendingLoad->fClearRedoHistory);
+    fPendingLoad.fResetSettings = pendingLoad->fResetSettings;
+  }
+
   return kResultOk;
 }
 
+//------------------------------------------------------------------------
+// SampleMgr::onSamplerBuffersRequest
+//------------------------------------------------------------------------
+tresult SampleMgr::onSamplerBuffersRequest(SamplerBuffersRequest const &iRequest)
+{
+  DLOG_F(INFO, "SampleMgr::onSamplerBuffersRequest(%f, %d, %d, %s)",
+         iRequest.fSampleRate, iRequest.fNumChannels, iRequest.fNumSamples, iRequest.fStream ? "stream" : "buffers");
+
+  if(!iRequest.fMgr)
+    return kResultFalse;
+
+  fSamplerBuffersMgr = iRequest.fMgr;
+
+  std::shared_ptr<SamplerBuffers> buffers{};
+
+  // Implementation note: the spare buffers are not touched until the sampler actually records in them so they do
+  // not use physical memory until then
+  if(iRequest.fStream)
+  {
+    buffers = std::make_shared<SamplerBuffers>();
+    buffers->fStream =
+      std::make_shared<SampleStreamWriter>(iRequest.fSampleRate, iRequest.fNumChannels, iRequest.fNumSamples);
+  }
+  else if(iRequest.fNumSamples > 0)
+  {
+    buffers = std::make_shared<SamplerBuffers>();
+    buffers->fBuffers =
+      std::make_shared<SampleBuffers32>(iRequest.fSampleRate, iRequest.fNumChannels, iRequest.fNumSamples);
+    buffers->fSpareBuffers =
+      std::make_shared<SampleBuffers32>(iRequest.fSampleRate, iRequest.fNumChannels, iRequest.fNumSamples);
+  }
+
+  // Implementation note: this also frees the buffers RT handed back (when RT does not need buffers anymore, setting
+  // nullptr releases the ones held by the UI as well)
+  fSampleStream = buffers ? buffers->fStream : nullptr;
+
+  auto version = iRequest.fMgr->uiSetObject(std::move(buffers));
+
+  // we tell RT
+  if(iRequest.fNumSamples > 0)
+    fGUISamplerBuffersMessage.broadcast(version);
+
+  return kResultOk;
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::recycleSamplerBuffers
+//------------------------------------------------------------------------
+void SampleMgr::recycleSamplerBuffers(SharedSampleBuffers<Vst::Sample32> iTakeBuffers)
+{
+  if(!fSamplerBuffersMgr)
+    return;
+
+  auto current = fSamplerBuffersMgr->uiGetObject();
+
+  // the sampler has moved on to other buffers (different size, streaming...) => they are simply freed
+  if(!current || current->fBuffers != iTakeBuffers || !current->fSpareBuffers)
+    return;
+
+  // the sampler switched to the spare buffers after the take: the buffers of the take become the new spare ones
+  auto buffers = std::make_shared<SamplerBuffers>();
+  buffers->fBuffers = current->fSpareBuffers;
+  buffers->fSpareBuffers = std::move(iTakeBuffers);
+  buffers->fRecycled = true;
+
+  fGUISamplerBuffersMessage.broadcast(fSamplerBuffersMgr->uiSetObject(std::move(buffers)));
+}
+
 //------------------------------------------------------------------------
 // SampleMgr::executeAction
 //------------------------------------------------------------------------
 bool SampleMgr::executeAction(SampleAction const &iAction)
 {
+  // the sample is not entirely loaded yet (only its beginning can be auditioned) => it cannot be edited
+  if(isPreviewing() && iAction.fType != SampleAction::Type::kLoad)
+    return false;
+
   auto action = iAction;
 
   // we capture the current state so that we can restore on undo
@@ -251,28 +516,37 @@ bool SampleMgr::doExecuteAction(SampleAction const &iAction, bool clearRedoHisto
   switch(iAction.fType)
   {
     case SampleAction::Type::kLoad:
+      // copying, decoding and resampling a (potentially very long) file would block the UI
+      loadSampleInBackground(iAction, clearRedoHistory);
+      return true;
+
+    case SampleAction::Type::kSample:
     {
-      auto sampleFile = SampleFile::create(iAction.fFilePath);
-      if(sampleFile)
+      auto const &newSample = iAction.fRTNewSample;
+
+      // the take was streamed to disk: it is loaded like a file (in the background) once it is written
+      if(newSample.fStreamTakeId > 0)
       {
-        auto [buffers, originalSampleRate] = sampleFile->load(*fState->fSampleRate, fState);
-        if(buffers)
-        {
-          currentSample = { buffers, originalSampleRate, CurrentSample::Source::kFile, CurrentSample::UpdateType::kNone };
-          currentFile = *sampleFile;
-        }
+        loadTakeInBackground(iAction, clearRedoHistory);
+        return true;
       }
-    }
-      break;
 
-    case SampleAction::Type::kSample:
-    {
       notifyRT = false;
 
-      auto buffers = getSharedMgr()->uiAdjustObjectFromRT(iAction.fRTVersion);
+      auto buffers = getSharedMgr()->uiAdjustObjectFromRT(newSample.fVersion);
 
       if(buffers)
       {
+        // unless the take fills the buffers of the sampler entirely (in which case RT already plays them), a right
+        // sized copy is made and sent to RT (the buffers of the sampler are never modified nor kept)
+        if(newSample.fStartOffset != 0 || newSample.fNumSamples != buffers->getNumSamples())
+        {
+          auto samplerBuffers = std::move(buffers);
+          buffers = samplerBuffers->unroll(newSample.fStartOffset, newSample.fNumSamples);
+          recycleSamplerBuffers(std::move(samplerBuffers));
+          notifyRT = true;
+        }
+
         std::ostringstream filePath;
         filePath << "samspl64://sampling@" << buffers->getSampleRate() << "/sam_spl64_sampling.wav";
 
@@ -303,28 +577,338 @@ bool SampleMgr::doExecuteAction(SampleAction const &iAction, bool clearRedoHisto
 
   if(currentSample.hasSamples() && !currentFile.empty())
   {
-    if(!fState->fCurrentSample->empty())
+    commitAction(iAction,
+                 clearRedoHistory,
+                 currentSample,
+                 currentFile,
+                 notifyRT,
+                 *fState->fCurrentSample,
+                 *fState->fSampleFile);
+    return true;
+  }
+
+  return false;
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::commitAction
+//------------------------------------------------------------------------
+void SampleMgr::commitAction(SampleAction const &iAction,
+                             bool iClearRedoHistory,
+                             CurrentSample const &iCurrentSample,
+                             SampleFile const &iCurrentFile,
+                             bool iNotifyRT,
+                             CurrentSample const &iPreviousSample,
+                             SampleFile const &iPreviousFile)
+{
+  if(!iPreviousSample.empty())
+  {
+    fState->fUndoHistory.updateIf([&iAction, iClearRedoHistory, &iPreviousSample, &iPreviousFile] (UndoHistory *iUndoHistory) {
+      iUndoHistory->addEntry(iAction, iPreviousSample, iPreviousFile);
+      if(iClearRedoHistory)
+        iUndoHistory->clearRedoHistory();
+      return true;
+    });
+  }
+
+  auto version = getSharedMgr()->uiSetObject(iCurrentSample.getSharedBuffers());
+
+  if(iNotifyRT)
+    fGUINewSampleMessage.broadcast(version);
+
+  fState->fCurrentSample.setValue(iCurrentSample);
+  fState->fSampleFile.setValue(iCurrentFile);
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::loadSampleInBackground
+//------------------------------------------------------------------------
+void SampleMgr::loadSampleInBackground(SampleAction const &iAction, bool iClearRedoHistory)
+{
+  DLOG_F(INFO, "SampleMgr::loadSampleInBackground(%s)", iAction.fFilePath.c_str());
+
+  // replaces the sample being loaded (if any) but not the sample it replaces (if previewed)
+  auto pendingLoad = PendingLoad{iAction, iClearRedoHistory};
+  if(isPreviewing())
+  {
+    pendingLoad.fPreviewed = true;
+    pendingLoad.fPreviousSample = fPendingLoad.fPreviousSample;
+    pendingLoad.fPreviousFile = fPendingLoad.fPreviousFile;
+  }
+  pendingLoad.fQuality = getResamplingQuality();
+  fPendingLoad = std::move(pendingLoad);
+
+  fSampleLoader.load(iAction.fFilePath, *fState->fSampleRate, fPendingLoad.fQuality);
+  waitForLoad();
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::loadTakeInBackground
+//------------------------------------------------------------------------
+void SampleMgr::loadTakeInBackground(SampleAction const &iAction, bool iClearRedoHistory)
+{
+  DLOG_F(INFO, "SampleMgr::loadTakeInBackground(%lld)", iAction.fRTNewSample.fStreamTakeId);
+
+  fPendingLoad = PendingLoad{iAction, iClearRedoHistory};
+  fPendingLoad.fQuality = getResamplingQuality();
+  fPendingStreamTakeId = iAction.fRTNewSample.fStreamTakeId;
+
+  waitForLoad();
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::acquireStreamTake
+//------------------------------------------------------------------------
+void SampleMgr::acquireStreamTake()
+{
+  std::optional<UTF8Path> filePath{UTF8Path{}};
+  int64 numDroppedFrames{};
+  if(fSampleStream)
+    filePath = fSampleStream->uiAcquireTake(fPendingStreamTakeId, &numDroppedFrames);
+
+  // the writer thread is still writing the take
+  if(!filePath)
+    return;
+
+  auto takeId = fPendingStreamTakeId;
+  fPendingStreamTakeId = 0;
+
+  // the take is only loaded if it is still the one expected (not cancelled or replaced since)
+  auto expected = fPendingLoad.fAction.fType == SampleAction::Type::kSample &&
+                  fPendingLoad.fAction.fRTNewSample.fStreamTakeId == takeId;
+
+  if(filePath->cpp_str().empty())
+  {
+    if(expected)
     {
-      fState->fUndoHistory.updateIf([this, &iAction, clearRedoHistory] (UndoHistory *iUndoHistory) {
-        iUndoHistory->addEntry(iAction, *fState->fCurrentSample, *fState->fSampleFile);
-        if(clearRedoHistory)
-          iUndoHistory->clearRedoHistory();
-        return true;
-      });
+      fState->handleError("Could not write the sample to disk");
+      fPendingLoad = {};
+    }
+    return;
+  }
+
+  std::ostringstream originalFilePath;
+  originalFilePath << "samspl64://sampling@" << fSampleStream->getSampleRate() << "/sam_spl64_sampling.wav";
+
+  // the file is deleted when the last sample file pointing to it goes away (right away when not expected anymore)
+  SampleFile sampleFile{originalFilePath.str(),
+                        *filePath,
+                        static_cast<uint64>(SampleFile::computeFileSize(*filePath))};
+
+  if(expected)
+  {
+    // the take is still loaded (it has gaps where the frames were dropped)
+    if(numDroppedFrames > 0)
+    {
+      std::ostringstream message;
+      message << "Could not write the sample to disk fast enough (" << numDroppedFrames << " frames dropped)";
+      fState->handleError(message.str());
     }
 
-    auto version = getSharedMgr()->uiSetObject(currentSample.getSharedBuffers());
+    fSampleLoader.load(sampleFile, *fState->fSampleRate, fPendingLoad.fQuality);
+  }
+}
 
-    if(notifyRT)
-      fGUINewSampleMessage.broadcast(version);
+//------------------------------------------------------------------------
+// SampleMgr::waitForLoad
+//------------------------------------------------------------------------
+void SampleMgr::waitForLoad()
+{
+  if(!fLoadingTimer)
+  {
+    fLoadingTimer = VSTGUI::makeOwned<VSTGUI::CVSTGUITimer>([this](VSTGUI::CVSTGUITimer *iTimer) {
+      if(auto preview = fSampleLoader.popPreview())
+        onSamplePreview(*preview);
 
-    fState->fCurrentSample.setValue(currentSample);
-    fState->fSampleFile.setValue(currentFile);
+      if(auto result = fSampleLoader.popResult())
+        onSampleLoaded(*result);
 
-    return true;
+      if(auto result = fSampleRefiner.popResult())
+        onSampleRefined(*result);
+
+      if(fPendingStreamTakeId > 0)
+        acquireStreamTake();
+
+      fState->fSampleLoadingState.update(fSampleLoader.getState());
+
+      // done (or cancelled)
+      if(!fSampleLoader.isLoading() && !fSampleRefiner.isLoading() && fPendingStreamTakeId == 0)
+        iTimer->stop();
+    }, 50, false);
   }
+  fState->fSampleLoadingState.update(fSampleLoader.getState());
+  fLoadingTimer->start();
+}
 
-  return false;
+//------------------------------------------------------------------------
+// SampleMgr::onSamplePreview
+//------------------------------------------------------------------------
+void SampleMgr::onSamplePreview(SampleLoader::Preview const &iPreview)
+{
+  DLOG_F(INFO, "SampleMgr::onSamplePreview(%d)", iPreview.fBuffers->getNumSamples());
+
+  // the sample being replaced goes in the undo history once the sample is loaded (or is restored if it fails)
+  if(!fPendingLoad.fPreviewed)
+  {
+    fPendingLoad.fPreviewed = true;
+    fPendingLoad.fPreviousSample = *fState->fCurrentSample;
+    fPendingLoad.fPreviousFile = *fState->fSampleFile;
+  }
+
+  setCurrentSample({ iPreview.fBuffers, iPreview.fOriginalSampleRate, CurrentSample::Source::kFile, CurrentSample::UpdateType::kNone });
+
+  if(fPendingLoad.fResetSettings)
+  {
+    resetSettings();
+    fPendingLoad.fResetSettings = false;
+  }
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::onSampleLoaded
+//------------------------------------------------------------------------
+void SampleMgr::onSampleLoaded(SampleLoader::Result &iResult)
+{
+  DLOG_F(INFO, "SampleMgr::onSampleLoaded(%s)", iResult.fFilePath.c_str());
+
+  if(iResult.fError)
+    fState->handleError(*iResult.fError);
+
+  if(iResult.fBuffers && iResult.fSampleFile)
+  {
+    fState->clearError();
+
+    auto previousSample = fPendingLoad.fPreviewed ? fPendingLoad.fPreviousSample : *fState->fCurrentSample;
+    auto previousFile = fPendingLoad.fPreviewed ? fPendingLoad.fPreviousFile : *fState->fSampleFile;
+
+    auto source = fPendingLoad.fAction.fType == SampleAction::Type::kSample ?
+                  CurrentSample::Source::kSampling :
+                  CurrentSample::Source::kFile;
+
+    commitAction(fPendingLoad.fAction,
+                 fPendingLoad.fClearRedoHistory,
+                 { iResult.fBuffers, iResult.fOriginalSampleRate, source, CurrentSample::UpdateType::kNone },
+                 *iResult.fSampleFile,
+                 true,
+                 previousSample,
+                 previousFile);
+
+    if(fPendingLoad.fResetSettings)
+      resetSettings();
+
+    refineCurrentSample(iResult.fQuality);
+  }
+  else if(fPendingLoad.fPreviewed)
+    setCurrentSample(fPendingLoad.fPreviousSample);
+
+  fPendingLoad = {};
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::getResamplingQuality
+//------------------------------------------------------------------------
+EResamplingQuality SampleMgr::getResamplingQuality() const
+{
+  // when rendering offline, nobody is waiting for the sample to be playable
+  if(*fOfflineRendering || *fResamplingPolicy == EResamplingPolicy::kResamplingHighQuality)
+    return EResamplingQuality::kHigh;
+
+  return EResamplingQuality::kFast;
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::refineCurrentSample
+//------------------------------------------------------------------------
+void SampleMgr::refineCurrentSample(EResamplingQuality iQuality)
+{
+  auto const &currentSample = *fState->fCurrentSample;
+  auto const &sampleFile = *fState->fSampleFile;
+
+  // nothing to refine when the sample is already the highest quality (for example shared) or was not resampled
+  if(iQuality == EResamplingQuality::kHigh ||
+     !currentSample.hasSamples() ||
+     sampleFile.empty() ||
+     currentSample.getOriginalSampleRate() == currentSample.getSampleRate())
+    return;
+
+  DLOG_F(INFO, "SampleMgr::refineCurrentSample(%s)", sampleFile.getOriginalFilePath().c_str());
+
+  fRefinement.start(currentSample.getSharedBuffers());
+  fSampleRefiner.load(sampleFile, currentSample.getSampleRate(), EResamplingQuality::kHigh);
+  waitForLoad();
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::onSampleRefined
+//------------------------------------------------------------------------
+void SampleMgr::onSampleRefined(SampleLoader::Result &iResult)
+{
+  auto const &currentSample = *fState->fCurrentSample;
+
+  // the current sample may have changed since (new sample, action, undo...) in which case the result is discarded
+  if(fRefinement.complete(currentSample.getSharedBuffers(), iResult.fBuffers))
+  {
+    DLOG_F(INFO, "SampleMgr::onSampleRefined(%s)", iResult.fFilePath.c_str());
+
+    setCurrentSample({ iResult.fBuffers, currentSample.getOriginalSampleRate(), currentSample.getSource(), currentSample.getUpdateType() });
+  }
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::onOfflineRendering
+//------------------------------------------------------------------------
+void SampleMgr::onOfflineRendering()
+{
+  auto const &currentSample = *fState->fCurrentSample;
+
+  if(!currentSample.hasSamples() || !fRefinement.isRefining(currentSample.getSharedBuffers()))
+    return;
+
+  DLOG_F(INFO, "SampleMgr::onOfflineRendering - refining current sample now");
+
+  fSampleRefiner.cancel();
+
+  auto loaded = fState->fSampleFile->load(currentSample.getSampleRate(), fState);
+  if(loaded.fBuffers)
+    setCurrentSample({ loaded.fBuffers, loaded.fOriginalSampleRate, currentSample.getSource(), currentSample.getUpdateType() });
+
+  fRefinement.reset();
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::cancelLoad
+//------------------------------------------------------------------------
+void SampleMgr::cancelLoad()
+{
+  // Implementation note: a take still being written keeps being polled (see `acquireStreamTake`) so that it is
+  // handed over (and discarded) and RT can begin a new one
+  if(!fSampleLoader.isLoading() && fPendingStreamTakeId == 0)
+    return;
+
+  DLOG_F(INFO, "SampleMgr::cancelLoad()");
+
+  auto previewed = isPreviewing();
+
+  fSampleLoader.cancel();
+
+  if(previewed)
+    setCurrentSample(fPendingLoad.fPreviousSample);
+
+  fPendingLoad = {};
+  fState->fSampleLoadingState.update({});
+}
+
+//------------------------------------------------------------------------
+// SampleMgr::setCurrentSample
+//------------------------------------------------------------------------
+void SampleMgr::setCurrentSample(CurrentSample const &iCurrentSample)
+{
+  auto version = getSharedMgr()->uiSetObject(iCurrentSample.getSharedBuffers());
+
+  // we tell RT
+  fGUINewSampleMessage.broadcast(version);
+
+  fState->fCurrentSample.setValue(iCurrentSample);
 }
 
 constexpr Sample32 NORMALIZE_3DB = static_cast<const Sample32>(0.707945784384138); // 10 ^ (-3/20)
@@ -396,6 +980,9 @@ CurrentSample SampleMgr::executeBufferAction(SampleAction const &iAction)
 //------------------------------------------------------------------------
 bool SampleMgr::undoLastAction()
 {
+  // undo applies to the current sample, not the one being loaded
+  cancelLoad();
+
   return fState->fUndoHistory.updateIf([this] (UndoHistory *iUndoHistory) {
 
     if(!iUndoHistory->hasUndoHistory())
@@ -403,7 +990,7 @@ bool SampleMgr::undoLastAction()
 
     auto lastExecutedAction = iUndoHistory->undo();
 
-    auto [buffers, originalSampleRate] = lastExecutedAction.fFile.load(*fState->fSampleRate, fState);
+    auto [buffers, originalSampleRate, quality] = lastExecutedAction.fFile.load(*fState->fSampleRate, fState, {}, {}, getResamplingQuality());
 
     if(buffers)
     {
@@ -427,6 +1014,8 @@ bool SampleMgr::undoLastAction()
       fOffsetPercent.setValue(lastExecutedAction.fAction.fOffsetPercent);
       fZoomPercent.setValue(lastExecutedAction.fAction.fZoomPercent);
 
+      refineCurrentSample(quality);
+
       return true;
     }
 
@@ -439,6 +1028,8 @@ bool SampleMgr::undoLastAction()
 //------------------------------------------------------------------------
 bool SampleMgr::redoLastUndo()
 {
+  cancelLoad();
+
   return fState->fUndoHistory.updateIf([this] (UndoHistory *iUndoHistory) {
     if(!iUndoHistory->hasRedoHistory())
       return false;
@@ -22,12 +22,18 @@
 
 #include <pongasoft/VST/GUI/Params/ParamAware.hpp>
 #include <pongasoft/VST/GUI/Views/StateAware.h>
+#include <vstgui4/vstgui/lib/cvstguitimer.h>
 
 #include "../SharedSampleBuffersMgr.h"
 #include "../Plugin.h"
 
 #include "UndoHistory.h"
 #include "SampleFile.h"
+#include "SampleLoader.h"
+#include "SampleAnalyzer.h"
+#include "SampleRefinement.h"
+#include "../TransientDetector.hpp"
+#include "../ZeroCrossingIndex.hpp"
 
 namespace pongasoft::VST::SampleSplitter::GUI {
 
@@ -99,12 +105,22 @@ protected:
    */
   bool doExecuteAction(SampleAction const &iAction, bool iClearUndoHistory);
 
+  /**
+   * Makes the sample resulting from the action the current one (adding the previous one to the undo history) */
+  void commitAction(SampleAction const &iAction,
+                    bool iClearRedoHistory,
+                    CurrentSample const &iCurrentSample,
+                    SampleFile const &iCurrentFile,
+                    bool iNotifyRT,
+                    CurrentSample const &iPreviousSample,
+                    SampleFile const &iPreviousFile);
+
 protected:
   // getSharedMgr
   SharedSampleBuffersMgr32 *getSharedMgr() const;
 
   // loadSampleFromSampling
-  tresult loadSampleFromSampling(SharedSampleBuffersVersion iVersion);
+  tresult loadSampleFromSampling(RTNewSample const &iNewSample);
 
   // Called when RT sends the mgr pointer to UI (need to copy UI buffer)
   tresult onMgrReceived(SharedSampleBuffersMgr32 *iMgr);
@@ -112,23 +128,166 @@ protected:
   // Called when sample rate changes
   tresult onSampleRateChanged(SampleRate iSampleRate);
 
+  // Called when RT needs (new) buffers for the sampler (allocated here so that RT never allocates/frees them)
+  tresult onSamplerBuffersRequest(SamplerBuffersRequest const &iRequest);
+
   // executeBufferAction
   CurrentSample executeBufferAction(SampleAction const &iAction);
 
   // resetSettings
   void resetSettings();
 
+  /**
+   * Computes where each slice starts and ends (uniformly, on transients and/or snapped to zero crossings) and shares
+   * it with the views and RT (when it changes). The analysis happens on a worker thread the first time for a given
+   * sample, in which case the sample is split uniformly until it is done. */
+  void updateSliceMap();
+
+  // sends the current slice map to RT (when RT has shared its slice map mgr)
+  void publishSliceMap();
+
+  /**
+   * Makes the zero crossing index of the current sample available to the views (when needed), building it on a
+   * worker thread the first time for a given sample. */
+  void updateZeroCrossingIndex();
+
+  // checks (on the UI thread) when the analysis running on the worker threads is done and updates what depends on it
+  void waitForAnalysis();
+
+  // releases (on the UI thread) the objects RT has dropped (called periodically, see SharedObjectMgr)
+  void reclaimSharedObjects();
+
+  // hands the buffers of a take (once copied) back to the sampler as spare buffers (see `SamplerBuffers::fRecycled`)
+  void recycleSamplerBuffers(SharedSampleBuffers<Vst::Sample32> iTakeBuffers);
+
+  /**
+   * Loads the sample in the background (see `SampleLoader`): the action is committed when the sample is loaded
+   * (`onSampleLoaded`) */
+  void loadSampleInBackground(SampleAction const &iAction, bool iClearRedoHistory);
+
+  /**
+   * Loads a take streamed to disk in the background: it is acquired from the writer thread once written
+   * (`acquireStreamTake`) then loaded like a file (see `loadSampleInBackground`) */
+  void loadTakeInBackground(SampleAction const &iAction, bool iClearRedoHistory);
+
+  // called (on the UI thread) until the take streamed to disk has been written and handed over by the writer thread
+  void acquireStreamTake();
+
+  // checks (on the UI thread) the progress of the samples being loaded (or refined) in the background
+  void waitForLoad();
+
+  // the quality to resample with (depends on the policy and whether the host is rendering offline)
+  EResamplingQuality getResamplingQuality() const;
+
+  /**
+   * When the current sample was resampled with a lower quality (`iQuality` is the quality actually used, as returned
+   * by `SampleFile::load`), resamples it again with the highest quality in the background: the current sample is then
+   * replaced (`onSampleRefined`) */
+  void refineCurrentSample(EResamplingQuality iQuality);
+
+  // called (on the UI thread) when the current sample has been resampled with the highest quality
+  void onSampleRefined(SampleLoader::Result &iResult);
+
+  /**
+   * Called when the host starts rendering offline (the current sample must be refined right away).
+   *
+   * Implementation note: RT notifies the UI asynchronously (`setupProcessing`) so the first blocks rendered offline
+   * may still play the fast resampled sample until the refined one reaches RT. RT does not wait for it since some
+   * hosts render offline from the UI thread which would then never get to refine it (deadlock). The "High Quality"
+   * policy (`EResamplingPolicy::kResamplingHighQuality`) never has this issue. */
+  void onOfflineRendering();
+
+  // called (on the UI thread) when the beginning of the sample being loaded can be auditioned
+  void onSamplePreview(SampleLoader::Preview const &iPreview);
+
+  // called (on the UI thread) when the sample being loaded in the background is loaded (or failed to load)
+  void onSampleLoaded(SampleLoader::Result &iResult);
+
+  // cancels the sample being loaded in the background (if any), restoring the previous sample if previewed
+  void cancelLoad();
+
+  // sets the sample (not in the undo history) and tells RT
+  void setCurrentSample(CurrentSample const &iCurrentSample);
+
+  // returns `true` while the beginning of the sample being loaded is the current sample
+  inline bool isPreviewing() const { return fSampleLoader.isLoading() && fPendingLoad.fPreviewed; }
+
 private:
   GUIRawVstParam fOffsetPercent{};
   GUIRawVstParam fZoomPercent{};
   GUIVstParam<NumSlice> fNumSlices{};
+  GUIVstParam<ESlicingMode> fSlicingMode{};
+  GUIVstParam<ParamValue> fSlicingSensitivity{};
+  GUIVstParam<bool> fShowZeroCrossing{};
+  GUIVstParam<bool> fSnapToZeroCrossing{};
+  GUIVstParam<EResamplingPolicy> fResamplingPolicy{};
+  GUIJmbParam<bool> fOfflineRendering{};
   GUIJmbParam<SharedSampleBuffersVersion> fGUINewSampleMessage;
+  GUIJmbParam<SharedSampleBuffersVersion> fGUISamplerBuffersMessage;
+  GUIJmbParam<SharedSliceMapMgr *> fSharedSliceMapMgrPtr;
+  GUIJmbParam<SharedSliceMapVersion> fGUINewSliceMapMessage;
 
   // this is for the case when we have not received the mgr from the RT which could be due to
   // 1. using only the editor (so RT will never send it)
   // 2. order in which events happen (since messaging is asynchronous, I am not sure there is a guarantee to when
   //    the message is actually delivered!
   mutable std::unique_ptr<SharedSampleBuffersMgr32> fGUIOnlyMgr{};
+
+  // the mgr used to share the sampler buffers with RT (received with the first request)
+  SharedSamplerBuffersMgr *fSamplerBuffersMgr{};
+
+  // releases the objects RT has dropped (periodically)
+  VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> fReclaimTimer{};
+
+  // the writer used by RT when streaming the takes to disk (the UI acquires the takes from it)
+  std::shared_ptr<SampleStreamWriter> fSampleStream{};
+
+  // detects the transients (in the background) when slicing on transients
+  SampleAnalyzer<TransientDetector::DetectionFunction> fTransientAnalyzer{
+    [](SampleBuffers32 const &iBuffers, std::atomic<bool> const &iCancel) {
+      return TransientDetector::computeDetectionFunction(iBuffers.getBuffer(),
+                                                         iBuffers.getNumChannels(),
+                                                         iBuffers.getNumSamples(),
+                                                         &iCancel);
+    }};
+
+  // builds the zero crossing index (in the background) when showing or snapping to zero crossings
+  SampleAnalyzer<ZeroCrossingIndex> fZeroCrossingAnalyzer{
+    [](SampleBuffers32 const &iBuffers, std::atomic<bool> const &iCancel) {
+      return ZeroCrossingIndex::build(iBuffers.getBuffer(),
+                                      iBuffers.getNumChannels(),
+                                      iBuffers.getNumSamples(),
+                                      &iCancel);
+    }};
+
+  // checks (on the UI thread) when the analysis is done
+  VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> fAnalysisTimer{};
+
+  // loads the samples selected by the user (in the background)
+  SampleLoader fSampleLoader{};
+
+  // the action to commit once the sample is loaded
+  struct PendingLoad
+  {
+    SampleAction fAction{SampleAction::Type::kLoad};
+    bool fClearRedoHistory{};
+    bool fResetSettings{}; // when loaded by the user (as opposed to redo)
+    EResamplingQuality fQuality{EResamplingQuality::kHigh};
+    bool fPreviewed{}; // the beginning of the sample is the current sample
+    CurrentSample fPreviousSample{}; // the current sample before the preview (for the undo history)
+    SampleFile fPreviousFile{};
+  };
+  PendingLoad fPendingLoad{};
+
+  // the take (streamed to disk) being written by the writer thread (`0` when none)
+  int64 fPendingStreamTakeId{};
+
+  // resamples the current sample with the highest quality (in the background) when it was resampled fast
+  SampleLoader fSampleRefiner{};
+  SampleRefinement fRefinement{}; // the current sample when it is being refined
+
+  // checks (on the UI thread) the progress of the sample being loaded
+  VSTGUI::SharedPointer<VSTGUI::CVSTGUITimer> fLoadingTimer{};
 };
 
 }
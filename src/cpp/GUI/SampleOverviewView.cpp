@@ -40,6 +40,7 @@ public:
     WaveformView::registerParameters();
 
     fNumSlices = registerParam(fParams->fNumSlices);
+    fSliceMap = registerParam(fState->fSliceMap);
 //    fHostInfo = registerParam(fState->fHostInfo);
   }
 
@@ -60,14 +61,13 @@ public:
       auto color = getSliceLineColor();
       if(!CColorUtils::isTransparent(color))
       {
-        auto sliceSizeInPixels = getWidth() / fNumSlices->realValue();
+        auto sliceMap = SliceMap::resolve(fSliceMap->get(), fNumSamples, *fNumSlices);
+        auto numPixelsPerSample = getWidth() / fNumSamples;
 
-        auto sliceIndex = sliceSizeInPixels;
-
-        for(auto i = 1; i < fNumSlices->intValue(); i++)
+        for(auto i = 1; i < sliceMap.getNumSlices(); i++)
         {
+          auto sliceIndex = sliceMap.getStart(i) * numPixelsPerSample;
           rdc.drawLine(sliceIndex, 0, sliceIndex, getHeight(), color);
-          sliceIndex += sliceSizeInPixels;
         }
       }
     }
@@ -101,6 +101,7 @@ protected:
   CColor fBPMLineColor{kTransparentCColor};
 
   GUIVstParam<NumSlice> fNumSlices{};
+  GUIJmbParam<SharedSliceMap> fSliceMap{};
 //  GUIJmbParam<HostInfo> fHostInfo{};
 
   int32 fNumSamples{-1};
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_SAMPLEREFINEMENT_H
+#define VST_SAM_SPL_64_SAMPLEREFINEMENT_H
+
+#include <memory>
+
+#include "../SampleBuffers.h"
+
+namespace pongasoft::VST::SampleSplitter::GUI {
+
+/**
+ * Keeps track of the current sample while it is being refined (resampled again with the highest quality in the
+ * background) to decide whether the refined sample can replace it: the refined sample is discarded when the current
+ * sample has changed in the meantime (new sample, action, undo, sample rate change...).
+ *
+ * Only a weak reference is kept so that the sample being refined is not kept alive once replaced. */
+class SampleRefinement
+{
+public:
+  // start (`iCurrent` is being refined)
+  void start(std::shared_ptr<SampleBuffers32> const &iCurrent) { fUnrefinedBuffers = iCurrent; }
+
+  // reset (no longer refining)
+  void reset() { fUnrefinedBuffers.reset(); }
+
+  /**
+   * @return `true` if `iCurrent` is the sample being refined */
+  bool isRefining(std::shared_ptr<SampleBuffers32> const &iCurrent) const
+  {
+    return iCurrent && iCurrent == fUnrefinedBuffers.lock();
+  }
+
+  /**
+   * Called when the refined sample is available (`nullptr` if it failed): this object no longer tracks the current
+   * sample afterwards.
+   *
+   * @return `true` if `iRefined` must replace `iCurrent` */
+  bool complete(std::shared_ptr<SampleBuffers32> const &iCurrent, std::shared_ptr<SampleBuffers32> const &iRefined)
+  {
+    auto res = iRefined &&
+               isRefining(iCurrent) &&
+               iCurrent != iRefined &&
+               iCurrent->getSampleRate() == iRefined->getSampleRate();
+
+    reset();
+
+    return res;
+  }
+
+private:
+  std::weak_ptr<SampleBuffers32> fUnrefinedBuffers{};
+};
+
+}
+
+#endif //VST_SAM_SPL_64_SAMPLEREFINEMENT_H
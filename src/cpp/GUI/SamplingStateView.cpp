@@ -42,6 +42,8 @@ public:
 
       if(percentSampled == PERCENT_SAMPLED_WAITING)
         setText("Waiting...");
+      else if(percentSampled == PERCENT_SAMPLED_BUSY)
+        setText("Busy...");
       else
       {
         if(percentSampled == 0)
@@ -37,7 +37,7 @@ struct SampleAction
   Percent fOffsetPercent{}; // used in undo
   Percent fZoomPercent{}; // used in undo
   UTF8Path fFilePath{}; // used with kLoad
-  SharedSampleBuffersVersion fRTVersion; // used with kSample
+  RTNewSample fRTNewSample{}; // used with kSample
 };
 
 class UndoHistory
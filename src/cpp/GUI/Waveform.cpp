@@ -32,11 +32,17 @@ BitmapPtr Waveform::createBitmap(COffscreenContext *iContext,
                                  double iOffsetPercent,
                                  double iZoomPercent,
                                  int32 *oStartOffset,
-                                 int32 *oEndOffset)
+                                 int32 *oEndOffset,
+                                 ZeroCrossingIndex const *iZeroCrossingIndex)
 {
   if(!iContext || !iSamples || !iSamples->hasSamples())
     return nullptr;
 
+  // the index must have been built for these samples
+  if(iZeroCrossingIndex && (iZeroCrossingIndex->getNumSamples() != iSamples->getNumSamples() ||
+                            iZeroCrossingIndex->getNumChannels() != iSamples->getNumChannels()))
+    iZeroCrossingIndex = nullptr;
+
   auto w = iContext->getWidth() - iLAF.fMargin.fLeft - iLAF.fMargin.fRight;
   auto h = iContext->getHeight() - iLAF.fMargin.fTop - iLAF.fMargin.fBottom;
 
@@ -155,9 +161,21 @@ BitmapPtr Waveform::createBitmap(COffscreenContext *iContext,
         p2.y = lerp.computeY(currentSample);
 
         if(showZeroCrossing)
-          iContext->setFrameColor(internal::isZeroCrossing(previousSample, currentSample) ?
-                                  iLAF.fZeroCrossingColor :
-                                  iLAF.fColor);
+        {
+          bool isZeroCrossing;
+
+          if(iZeroCrossingIndex)
+          {
+            // is there a zero crossing in the samples covered by this line (no matter how many samples are averaged)
+            auto from = startOffset + static_cast<int32>((i - 1) * numSamplesPerBucket);
+            auto to = startOffset + static_cast<int32>(i * numSamplesPerBucket);
+            isZeroCrossing = iZeroCrossingIndex->hasCrossing(c, from, to);
+          }
+          else
+            isZeroCrossing = internal::isZeroCrossing(previousSample, currentSample);
+
+          iContext->setFrameColor(isZeroCrossing ? iLAF.fZeroCrossingColor : iLAF.fColor);
+        }
 
         iContext->drawLine(p1, p2);
         p1 = p2;
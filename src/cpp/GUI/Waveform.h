@@ -5,6 +5,7 @@
 #include <pongasoft/VST/GUI/LookAndFeel.h>
 
 #include "../SampleBuffers.h"
+#include "../ZeroCrossingIndex.hpp"
 
 
 namespace pongasoft {
@@ -35,6 +36,9 @@ public:
 public:
   /**
    * Generates a bitmap (waveform graphics representation) for the samples
+   *
+   * @param iZeroCrossingIndex the zero crossings of the samples (when available) used to show the zero crossings
+   *                           (when `nullptr`, they are computed from the displayed values)
    */
   static BitmapPtr createBitmap(COffscreenContext *iContext,
                                 SampleBuffers32 const *iSamples,
@@ -42,7 +46,8 @@ public:
                                 double iOffsetPercent = 0,
                                 double iZoomPercent = 0,
                                 int32 *oStartOffset = nullptr,
-                                int32 *oEndOffset = nullptr);
+                                int32 *oEndOffset = nullptr,
+                                ZeroCrossingIndex const *iZeroCrossingIndex = nullptr);
 
   /**
    * Compute oOffsetPercent and oZoomPercent from start/end offset
@@ -7,6 +7,8 @@
 #include <pongasoft/VST/AudioUtils.h>
 #include <pongasoft/Utils/Lerp.h>
 
+#include <algorithm>
+
 namespace pongasoft::VST::SampleSplitter {
 
 using namespace Steinberg;
@@ -25,6 +27,44 @@ constexpr int32 NUM_XFADE_SAMPLES = 65;
 // the maximum number of channels supported for the input (sample): support stereo max at this time
 constexpr int32 MAX_NUM_INPUT_CHANNELS = 2;
 
+// number of extra voices (preallocated) used when a slice is retriggered while still playing (the previous instance
+// keeps playing in one of these voices)
+constexpr int32 NUM_EXTRA_VOICES = 16;
+
+// the maximum number of voices playing at the same time in polyphonic mode (0 means no limit)
+constexpr int MAX_VOICE_LIMIT = 5;
+constexpr int32 VOICE_LIMITS[MAX_VOICE_LIMIT + 1] = {0, 4, 8, 16, 32, 64};
+
+// the maximum pre-roll (in beats) that can be included in a take when capturing the sampling input
+constexpr int MAX_SAMPLING_PRE_ROLL_IN_BEATS = 4;
+
+// how often (in ms) the UI releases the objects RT has dropped (see SharedObjectMgr)
+constexpr uint32 SHARED_OBJECTS_RECLAIM_PERIOD_MS = 100;
+
+// how much audio (in ms) RT can write ahead of the writer thread when streaming a take to disk
+constexpr uint32 SAMPLING_STREAM_FIFO_SIZE_MS = 4000;
+
+// the range (in dB) of the threshold above which the input triggers sampling (trigger "on sound"). The minimum
+// means "any sound" (the threshold is then the one used by VST::isSilent)
+constexpr double SAMPLING_TRIGGER_THRESHOLD_MIN_DB = -96.0;
+constexpr double SAMPLING_TRIGGER_THRESHOLD_MAX_DB = 0.0;
+
+// once triggered, how much (in dB) the input can fall below the threshold and still be considered held
+constexpr double SAMPLING_TRIGGER_HYSTERESIS_DB = 6.0;
+
+// how long (in ms) the input must be held above the threshold to trigger sampling (trigger "on sound")
+constexpr int MAX_SAMPLING_TRIGGER_HOLD = 4;
+constexpr uint32 SAMPLING_TRIGGER_HOLD_MS[MAX_SAMPLING_TRIGGER_HOLD + 1] = {0, 5, 10, 20, 50};
+
+// how far (in ms) a slice boundary (or the selection) can move to land on a zero crossing
+constexpr double ZERO_CROSSING_SNAP_MAX_DISTANCE_MS = 10.0;
+
+// how much memory (in bytes) the decoded samples no longer in use can take in the cache shared by all instances
+constexpr size_t SAMPLE_BUFFERS_CACHE_MEMORY_BUDGET = 512 * 1024 * 1024; // 512Mb
+
+// how much of a sample (in seconds) must be decoded before it can be auditioned while the rest is loading
+constexpr double PROGRESSIVE_LOAD_MIN_DURATION_SECONDS = 5.0;
+
 // the size of the sample which triggers a confirmation screen
 constexpr int64 LARGE_SAMPLE_SIZE = 20 * 1024 * 1024; // 20Mb
 
@@ -127,10 +167,37 @@ struct PlayingState
 
   // percentage for the selection
   float fWESelectionPercentPlayer{PERCENT_PLAYED_NOT_PLAYING};
+
+  // @return a mask where bit i is set when slice i is playing
+  uint64 getPlayingSlicesMask() const
+  {
+    uint64 res = 0;
+    for(int slice = 0; slice < NUM_SLICES; slice++)
+    {
+      if(fPercentPlayed[slice] != PERCENT_PLAYED_NOT_PLAYING)
+        res |= uint64{1} << slice;
+    }
+    return res;
+  }
+
+  bool operator==(const PlayingState &rhs) const
+  {
+    return fWESelectionPercentPlayer == rhs.fWESelectionPercentPlayer &&
+           std::equal(std::begin(fPercentPlayed), std::end(fPercentPlayed), std::begin(rhs.fPercentPlayed));
+  }
+
+  bool operator!=(const PlayingState &rhs) const
+  {
+    return !(rhs == *this);
+  }
 };
 
+static_assert(NUM_SLICES <= 64, "playing slices are serialized as a 64 bits mask");
+
 //------------------------------------------------------------------------
 // PlayingStateParamSerializer
+// Compact format: a mask of the slices which are playing followed by the percentage of those slices only (the
+// others are PERCENT_PLAYED_NOT_PLAYING) and the percentage for the selection
 //------------------------------------------------------------------------
 class PlayingStateParamSerializer : public IParamSerializer<PlayingState>
 {
@@ -138,11 +205,18 @@ public:
   // readFromStream
   tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue) const override
   {
-    tresult res = kResultOk;
+    uint64 playingSlices;
+
+    tresult res = IBStreamHelper::readInt64u(iStreamer, playingSlices);
+    if(res != kResultOk)
+      return res;
 
-    for(float &slice : oValue.fPercentPlayed)
+    for(int slice = 0; slice < NUM_SLICES; slice++)
     {
-      res |= IBStreamHelper::readFloat(iStreamer, slice);
+      if(playingSlices & (uint64{1} << slice))
+        res |= IBStreamHelper::readFloat(iStreamer, oValue.fPercentPlayed[slice]);
+      else
+        oValue.fPercentPlayed[slice] = PERCENT_PLAYED_NOT_PLAYING;
     }
 
     res |= IBStreamHelper::readFloat(iStreamer, oValue.fWESelectionPercentPlayer);
@@ -153,10 +227,15 @@ public:
   // writeToStream
   tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const override
   {
+    auto playingSlices = iValue.getPlayingSlicesMask();
+
+    if(!oStreamer.writeInt64u(playingSlices))
+      return kResultFalse;
+
     tresult res = kResultOk;
-    for(float slice : iValue.fPercentPlayed)
+    for(int slice = 0; slice < NUM_SLICES; slice++)
     {
-      if(!oStreamer.writeFloat(slice))
+      if((playingSlices & (uint64{1} << slice)) && !oStreamer.writeFloat(iValue.fPercentPlayed[slice]))
         res = kResultFalse;
     }
     if(!oStreamer.writeFloat(iValue.fWESelectionPercentPlayer))
@@ -167,6 +246,8 @@ public:
 };
 
 constexpr float PERCENT_SAMPLED_WAITING = 10.0f;
+// the sampler could not start (the previous take streamed to disk has not been handed over to the UI yet)
+constexpr float PERCENT_SAMPLED_BUSY = 11.0f;
 
 //------------------------------------------------------------------------
 // SamplingState (for now using only a float but will likely expand...)
@@ -264,6 +345,38 @@ enum ESamplingTrigger
   kSamplingTriggerOnSound
 };
 
+//------------------------------------------------------------------------
+// SamplingTriggerThresholdParamConverter: the threshold (in dB) above which the input triggers sampling
+// mapping [0.0, 1.0] to [SAMPLING_TRIGGER_THRESHOLD_MIN_DB, SAMPLING_TRIGGER_THRESHOLD_MAX_DB]
+//------------------------------------------------------------------------
+class SamplingTriggerThresholdParamConverter : public IParamConverter<double>
+{
+public:
+  inline ParamValue normalize(ParamType const &iValue) const override
+  {
+    return Utils::mapValueDP(std::clamp(iValue, SAMPLING_TRIGGER_THRESHOLD_MIN_DB, SAMPLING_TRIGGER_THRESHOLD_MAX_DB),
+                             SAMPLING_TRIGGER_THRESHOLD_MIN_DB, SAMPLING_TRIGGER_THRESHOLD_MAX_DB,
+                             0.0, 1.0);
+  }
+
+  inline ParamType denormalize(ParamValue iNormalizedValue) const override
+  {
+    return Utils::mapValueDP(iNormalizedValue, 0.0, 1.0, SAMPLING_TRIGGER_THRESHOLD_MIN_DB, SAMPLING_TRIGGER_THRESHOLD_MAX_DB);
+  }
+
+  inline void toString(ParamType const &iValue, String128 oString, int32 iPrecision) const override
+  {
+    Steinberg::UString wrapper(oString, str16BufferSize (String128));
+    if(iValue <= SAMPLING_TRIGGER_THRESHOLD_MIN_DB)
+      wrapper.assign(STR16("Any"));
+    else
+    {
+      wrapper.printFloat(iValue, iPrecision);
+      wrapper.append(STR16(" dB"));
+    }
+  }
+};
+
 //------------------------------------------------------------------------
 // SlicesSettings
 // Each bit represent a boolean flag per slice
@@ -347,6 +460,24 @@ public:
   }
 };
 
+//------------------------------------------------------------------------
+// ESlicingMode
+//------------------------------------------------------------------------
+enum ESlicingMode
+{
+  kSlicingUniform,   // all slices have the same size
+  kSlicingTransients // slices start on the transients detected in the sample
+};
+
+//------------------------------------------------------------------------
+// EResamplingPolicy
+//------------------------------------------------------------------------
+enum EResamplingPolicy
+{
+  kResamplingFastThenRefine, // resampled fast (playable right away) then refined with the highest quality in the background
+  kResamplingHighQuality     // always resampled with the highest quality (slower)
+};
+
 //------------------------------------------------------------------------
 // HostInfo
 //------------------------------------------------------------------------
@@ -436,6 +567,15 @@ enum class EPlayMode
   kHold     // Pad is played only when held => looping allowed
 };
 
+//------------------------------------------------------------------------
+// EVoiceStealing
+//------------------------------------------------------------------------
+enum class EVoiceStealing
+{
+  kOldest,  // the voice which started playing first is stopped
+  kQuietest // the voice with the lowest level (RMS of what it is about to play) is stopped
+};
+
 //------------------------------------------------------------------------
 // EInputRouting
 //------------------------------------------------------------------------
@@ -98,6 +98,25 @@ SampleSplitterParameters::SampleSplitterParameters()
       .shortTitle(STR16("Slices"))
       .add();
 
+  // how the sample is split into slices (uniformly or on the transients detected in the sample)
+  fSlicingMode =
+    vst<EnumParamConverter<ESlicingMode, ESlicingMode::kSlicingTransients>>(ESampleSplitterParamID::kSlicingMode,
+                                                                             STR16("Slicing Mode"),
+                                                                             {{STR16("Uniform"),
+                                                                                STR16("Transients")}})
+      .defaultValue(ESlicingMode::kSlicingUniform)
+      .shortTitle(STR16("SliceMode"))
+      .guiOwned()
+      .add();
+
+  // how sensitive the transient detection is (the higher, the more slices)
+  fSlicingSensitivity =
+    vst<PercentParamConverter>(ESampleSplitterParamID::kSlicingSensitivity, STR16("Slicing Sensitivity"))
+      .defaultValue(0.5)
+      .shortTitle(STR16("SliceSens"))
+      .guiOwned()
+      .add();
+
   // the bank/page representing 16 pads (4 banks of 16 pads => 64 pads)
   fPadBank =
     vst<DiscreteValueParamConverter<NUM_PAD_BANKS - 1, int>>(ESampleSplitterParamID::kPadBank, STR16("Bank"),
@@ -144,6 +163,40 @@ SampleSplitterParameters::SampleSplitterParameters()
       .shortTitle(STR16("XFade"))
       .add();
 
+  // the shape of the cross fade (when enabled)
+  fXFadeCurve =
+    vst<EnumParamConverter<EXFadeCurve, EXFadeCurve::kSCurve>>(ESampleSplitterParamID::kXFadeCurve,
+                                                               STR16("Cross Fade Curve"),
+                                                               {{STR16("Linear"),
+                                                                  STR16("Equal Power"),
+                                                                  STR16("S-Curve")}})
+      .defaultValue(EXFadeCurve::kLinear)
+      .shortTitle(STR16("XFadeCurve"))
+      .add();
+
+  // the maximum number of voices playing at the same time in polyphonic mode
+  fVoiceLimit =
+    vst<DiscreteValueParamConverter<MAX_VOICE_LIMIT, int>>(ESampleSplitterParamID::kVoiceLimit, STR16("Voice Limit"),
+                                                           {{STR16("No Limit"),
+                                                              STR16("4 Voices"),
+                                                              STR16("8 Voices"),
+                                                              STR16("16 Voices"),
+                                                              STR16("32 Voices"),
+                                                              STR16("64 Voices")}})
+      .defaultValue(0)
+      .shortTitle(STR16("Voices"))
+      .add();
+
+  // which voice is stopped when a slice starts while the voice limit is reached
+  fVoiceStealing =
+    vst<EnumParamConverter<EVoiceStealing, EVoiceStealing::kQuietest>>(ESampleSplitterParamID::kVoiceStealing,
+                                                                       STR16("Voice Stealing"),
+                                                                       {{STR16("Oldest"),
+                                                                          STR16("Quietest")}})
+      .defaultValue(EVoiceStealing::kOldest)
+      .shortTitle(STR16("Stealing"))
+      .add();
+
   // how to handle input routing (mono->mono or mono->stereo)
   fInputRouting =
     vst<EnumParamConverter<EInputRouting, EInputRouting::kMonoInStereoOut>>(ESampleSplitterParamID::kInputRouting,
@@ -195,6 +248,67 @@ SampleSplitterParameters::SampleSplitterParameters()
       .shortTitle(STR16("SampTrig"))
       .add();
 
+  // the threshold (in dB) above which the input triggers sampling (when triggered by sound)
+  fSamplingTriggerThreshold =
+    vst<SamplingTriggerThresholdParamConverter>(ESampleSplitterParamID::kSamplingTriggerThreshold,
+                                                STR16("Trigger Threshold"))
+      .defaultValue(SAMPLING_TRIGGER_THRESHOLD_MIN_DB)
+      .shortTitle(STR16("TrigThrs"))
+      .precision(1)
+      .add();
+
+  // how long the input must be held above the threshold to trigger sampling (when triggered by sound)
+  fSamplingTriggerHold =
+    vst<DiscreteValueParamConverter<MAX_SAMPLING_TRIGGER_HOLD, int>>(ESampleSplitterParamID::kSamplingTriggerHold,
+                                                                     STR16("Trigger Hold"),
+                                                                     {{STR16("None"),
+                                                                        STR16("5 ms"),
+                                                                        STR16("10 ms"),
+                                                                        STR16("20 ms"),
+                                                                        STR16("50 ms")}})
+      .defaultValue(0)
+      .shortTitle(STR16("TrigHold"))
+      .add();
+
+  // when true, RT keeps recording the sampling input so that a take can be committed after the fact or include
+  // what was recorded before the trigger (pre-roll)
+  fSamplingRetroCapture =
+    vst<BooleanParamConverter>(ESampleSplitterParamID::kSamplingRetroCapture, STR16("Retro Capture"))
+      .defaultValue(false)
+      .shortTitle(STR16("RetroCap"))
+      .add();
+
+  // how many beats recorded before the trigger are included in the take (requires retro capture)
+  fSamplingPreRollInBeats =
+    vst<DiscreteValueParamConverter<MAX_SAMPLING_PRE_ROLL_IN_BEATS, int>>(ESampleSplitterParamID::kSamplingPreRoll,
+                                                                          STR16("Pre-Roll"),
+                                                                          {{STR16("None"),
+                                                                             STR16("1 Beat"),
+                                                                             STR16("2 Beats"),
+                                                                             STR16("3 Beats"),
+                                                                             STR16("4 Beats")}})
+      .defaultValue(0)
+      .shortTitle(STR16("PreRoll"))
+      .add();
+
+  // momentary: commits what was recorded during the last "sampling duration" as if it had been sampled (requires
+  // retro capture)
+  fSamplingRetroCommit =
+    vst<BooleanParamConverter>(ESampleSplitterParamID::kSamplingRetroCommit, STR16("Retro Commit"))
+      .defaultValue(false)
+      .shortTitle(STR16("RetroCmt"))
+      .transient()
+      .add();
+
+  // when true, RT streams the take to disk (from a background thread) so that its length is not limited by the
+  // sampler buffers (sampling goes on until stopped). The take is still loaded in memory once done (like any sample).
+  fSamplingToDisk =
+    vst<BooleanParamConverter>(ESampleSplitterParamID::kSamplingToDisk, STR16("Sample To Disk"))
+      .defaultValue(false)
+      .shortTitle(STR16("ToDisk"))
+      .transient()
+      .add();
+
 
   // which view to display (main/edit)
   fViewType =
@@ -220,6 +334,17 @@ SampleSplitterParameters::SampleSplitterParameters()
       .flags(0)
       .add();
 
+  // how the samples are resampled to the sample rate of the host
+  fResamplingPolicy =
+    vst<EnumParamConverter<EResamplingPolicy, EResamplingPolicy::kResamplingHighQuality>>(ESampleSplitterParamID::kResamplingPolicy,
+                                                                                          STR16("Resampling"),
+                                                                                          {{STR16("Fast Then Refine"),
+                                                                                             STR16("High Quality")}})
+      .defaultValue(EResamplingPolicy::kResamplingFastThenRefine)
+      .shortTitle(STR16("Resampling"))
+      .guiOwned()
+      .add();
+
   // when true, RT will sample Stereo Input
   fSampling =
     vst<BooleanParamConverter>(ESampleSplitterParamID::kSampling, STR16("Sampling"))
@@ -257,6 +382,14 @@ SampleSplitterParameters::SampleSplitterParameters()
       .transient()
       .add();
 
+  // snaps the slice boundaries and the selection to the nearest zero crossing
+  fWESnapToZeroCrossing =
+    vst<BooleanParamConverter>(ESampleSplitterParamID::kWESnapToZeroCrossing, STR16("Snap To Zero Crossing"))
+      .defaultValue(false)
+      .shortTitle(STR16("Snap0X"))
+      .guiOwned()
+      .add();
+
   // play selection
   fWEPlaySelection =
     vst<BooleanParamConverter>(ESampleSplitterParamID::kWEPlaySelection, STR16("Play Selection"))
@@ -360,6 +493,14 @@ SampleSplitterParameters::SampleSplitterParameters()
       .shared()
       .add();
 
+  // whether the host is rendering offline
+  fOfflineRendering =
+    jmb<BooleanParamSerializer>(ESampleSplitterParamID::kOfflineRendering, STR16 ("Offline Rendering"))
+      .rtOwned()
+      .transient()
+      .shared()
+      .add();
+
   // playing state
   fPlayingState =
     jmb<PlayingStateParamSerializer>(ESampleSplitterParamID::kPlayingState, STR16 ("Playing State"))
@@ -384,7 +525,7 @@ SampleSplitterParameters::SampleSplitterParameters()
 
   // The sample buffers sent from the RT to the GUI after sampling (message)
   fRTNewSampleMessage =
-    jmb<Int64ParamSerializer>(ESampleSplitterParamID::fRTNewSampleMessage, STR16 ("RT Sample (msg)"))
+    jmb<RTNewSampleParamSerializer>(ESampleSplitterParamID::fRTNewSampleMessage, STR16 ("RT Sample (msg)"))
       .rtOwned()
       .shared()
       .transient()
@@ -405,6 +546,21 @@ SampleSplitterParameters::SampleSplitterParameters()
       .shared()
       .add();
 
+  // where each slice starts and ends (computed by the UI, for the views)
+  fSliceMap =
+    jmbFromType<SharedSliceMap>(ESampleSplitterParamID::kSliceMap, STR16 ("Slice Map"))
+      .guiOwned()
+      .transient()
+      .add();
+
+  // The GUI computed a new slice map (message)
+  fGUINewSliceMapMessage =
+    jmb<Int64ParamSerializer>(ESampleSplitterParamID::kGUINewSliceMapMessage, STR16 ("GUI Slice Map (msg)"))
+      .guiOwned()
+      .shared()
+      .transient()
+      .add();
+
   // the samples selected in the waveform edit window
   fWESelectedSampleRange =
     jmb<SampleRangeParamSerializer>(ESampleSplitterParamID::kWESelectedSampleRange, STR16 ("Selected Samples"))
@@ -450,6 +606,32 @@ SampleSplitterParameters::SampleSplitterParameters()
       .shared()
       .add();
 
+  // the slice map manager pointer (shared between UI and RT)
+  fSharedSliceMapMgrPtr =
+    jmb<PointerSerializer<SharedSliceMapMgr>>(ESampleSplitterParamID::kSharedSliceMapMgr,
+                                              STR16 ("Shared Slice Map Mgr"))
+      .transient()
+      .rtOwned()
+      .shared()
+      .add();
+
+  // RT requests the buffers used by the sampler (message)
+  fSamplerBuffersRequest =
+    jmb<SamplerBuffersRequestParamSerializer>(ESampleSplitterParamID::kSamplerBuffersRequest,
+                                              STR16 ("Sampler Buffers Request (msg)"))
+      .transient()
+      .rtOwned()
+      .shared()
+      .add();
+
+  // The GUI allocated the buffers used by the sampler (message)
+  fGUISamplerBuffersMessage =
+    jmb<Int64ParamSerializer>(ESampleSplitterParamID::kGUISamplerBuffersMessage, STR16 ("GUI Sampler Buffers (msg)"))
+      .guiOwned()
+      .shared()
+      .transient()
+      .add();
+
   // the current sample (so that views and controllers have access to it)
   fCurrentSample =
     jmb<CurrentSampleSerializer>(ESampleSplitterParamID::kCurrentSample, STR16 ("Current Sample"))
@@ -464,6 +646,20 @@ SampleSplitterParameters::SampleSplitterParameters()
       .transient()
       .add();
 
+  // the zero crossings of the current sample (computed in the background, only when needed)
+  fZeroCrossingIndex =
+    jmbFromType<SharedZeroCrossingIndex>(ESampleSplitterParamID::kZeroCrossingIndex, STR16 ("Zero Crossing Index"))
+      .guiOwned()
+      .transient()
+      .add();
+
+  // the progress of the sample being loaded in the background (if any)
+  fSampleLoadingState =
+    jmbFromType<SampleLoadingState>(ESampleSplitterParamID::kSampleLoadingState, STR16 ("Sample Loading State"))
+      .guiOwned()
+      .transient()
+      .add();
+
   // RT save state order
   setRTSaveStateOrder(kProcessorStateLatest,
                       fNumSlices,
@@ -478,7 +674,14 @@ SampleSplitterParameters::SampleSplitterParameters()
                       fRootKey,
                       fFollowMidiSelection,
                       fXFade,
-                      fInputRouting);
+                      fInputRouting,
+                      fVoiceLimit,
+                      fVoiceStealing,
+                      fXFadeCurve,
+                      fSamplingRetroCapture,
+                      fSamplingPreRollInBeats,
+                      fSamplingTriggerThreshold,
+                      fSamplingTriggerHold);
 
   // GUI save state order
   setGUISaveStateOrder(kControllerStateLatest,
@@ -487,7 +690,11 @@ SampleSplitterParameters::SampleSplitterParameters()
                        fSlicesSettings,
                        fViewType,
                        fExportSampleMajorFormat,
-                       fExportSampleMinorFormat);
+                       fExportSampleMinorFormat,
+                       fResamplingPolicy,
+                       fSlicingMode,
+                       fSlicingSensitivity,
+                       fWESnapToZeroCrossing);
 
   // Deprecation
   // deprecated number of slices (kept for backward compatibility)
@@ -615,9 +822,12 @@ SampleSplitterGUIState::SampleSplitterGUIState(SampleSplitterParameters const &i
   fPlayingState{add(iParams.fPlayingState)},
   fCurrentSample({add(iParams.fCurrentSample)}),
   fUndoHistory({add(iParams.fUndoHistory)}),
+  fZeroCrossingIndex({add(iParams.fZeroCrossingIndex)}),
   fSampleFile{add(iParams.fSampleFile)},
+  fSampleLoadingState{add(iParams.fSampleLoadingState)},
   fSamplingState{add(iParams.fSamplingState)},
   fSlicesSettings{add(iParams.fSlicesSettings)},
+  fSliceMap{add(iParams.fSliceMap)},
   fWESelectedSampleRange{add(iParams.fWESelectedSampleRange)},
   fLargeFilePath({add(iParams.fLargeFilePath)}),
   fErrorMessage({add(iParams.fErrorMessage)}),
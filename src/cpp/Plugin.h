@@ -6,7 +6,10 @@
 #include "SampleSlices.hpp"
 #include "GUI/CurrentSample.h"
 #include "GUI/SampleFile.h"
+#include "GUI/SampleLoader.h"
 #include "GUI/UndoHistory.h"
+#include "ZeroCrossingIndex.hpp"
+#include "SliceMap.h"
 #include "Model.h"
 #include <optional>
 
@@ -45,8 +48,11 @@ class SampleSplitterParameters : public Parameters
 {
 public:
   VstParam<NumSlice> fNumSlices;
+  VstParam<ESlicingMode> fSlicingMode; // uniform or on transients
+  VstParam<ParamValue> fSlicingSensitivity; // how sensitive the transient detection is (more slices when higher)
   VstParam<EViewType> fViewType; // which view to show (main/edit)
   VstParam<EEditingMode> fEditingMode; // which subtab to show (edit/sample)
+  VstParam<EResamplingPolicy> fResamplingPolicy; // how the samples are resampled to the sample rate of the host
 
   VstParam<int> fPadBank; // the bank/page representing 16 pads (4 banks of 16 pads => 64 pads)
   VstParam<int> fSelectedSlice; // keep track of which slice is selected (for settings editing purpose)
@@ -55,6 +61,9 @@ public:
   VstParam<bool> fPlayModeHold; // hold (true) trigger (false)
   VstParam<bool> fPolyphonic; // if true => multiple pads can be "played" at the same time, if false => only 1
   VstParam<bool> fXFade; // whether to cross fade (start/stop and looping can create clicks and pops)
+  VstParam<EXFadeCurve> fXFadeCurve; // the shape of the cross fade
+  VstParam<int> fVoiceLimit; // maximum number of voices playing at the same time (index in VOICE_LIMITS)
+  VstParam<EVoiceStealing> fVoiceStealing; // which voice is stopped when the voice limit is reached
   VstParam<EInputRouting> fInputRouting; // how to handle input routing (mono->mono or mono->stereo)
   VstParam<RootKey> fRootKey; // the root key to use (first pad)
   VstParam<bool> fPads[NUM_PADS]; // 16 pads that are either on (momentary button pressed) or off
@@ -69,11 +78,18 @@ public:
   RawVstParam fSamplingLeftVuPPM; // VU PPM (left channel) for the selected input for sampling
   RawVstParam fSamplingRightVuPPM; // VU PPM (right channel) for the selected input for sampling
   VstParam<ESamplingTrigger> fSamplingTrigger; // what triggers sampling
+  VstParam<double> fSamplingTriggerThreshold; // threshold (in dB) above which the input triggers sampling (on sound)
+  VstParam<int> fSamplingTriggerHold; // how long the input must stay above the threshold (on sound)
+  VstParam<bool> fSamplingRetroCapture; // when true, RT keeps recording the input (circular buffer)
+  VstParam<int> fSamplingPreRollInBeats; // how much of what was recorded before the trigger to include (capture only)
+  VstParam<bool> fSamplingRetroCommit; // momentary: commits the last "sampling duration" recorded (capture only)
+  VstParam<bool> fSamplingToDisk; // when true, RT streams the take to disk (length not limited by the duration)
 
   ///// editing (WE = WaveformEdit)
   RawVstParam fWEOffsetPercent;
   RawVstParam fWEZoomPercent;
   VstParam<bool> fWEShowZeroCrossing;
+  VstParam<bool> fWESnapToZeroCrossing;
   JmbParam<SampleRange> fWESelectedSampleRange;
   VstParam<bool> fWEPlaySelection;
   VstParam<bool> fWEZoomToSelection;
@@ -83,18 +99,26 @@ public:
 
   JmbParam<double> fSampleRate;
   JmbParam<HostInfo> fHostInfoMessage;
+  JmbParam<bool> fOfflineRendering; // RT tells the UI when the host renders offline
   JmbParam<PlayingState> fPlayingState;
 
   JmbParam<GUI::CurrentSample> fCurrentSample; // the current sample in the GUI
   JmbParam<GUI::SampleFile> fSampleFile; // the sample file
+  JmbParam<GUI::SampleLoadingState> fSampleLoadingState; // the progress of the sample being loaded (if any)
   JmbParam<GUI::UndoHistory> fUndoHistory; // the undo history
+  JmbParam<SharedZeroCrossingIndex> fZeroCrossingIndex; // the zero crossings of the current sample (when computed)
   JmbParam<SharedSampleBuffersVersion> fGUINewSampleMessage; // when a sample is loaded in the GUI, it notifies RT about it
-  JmbParam<SharedSampleBuffersVersion> fRTNewSampleMessage; // after sampling in RT, it notifies GUI about it
+  JmbParam<RTNewSample> fRTNewSampleMessage; // after sampling in RT, it notifies GUI about it
   JmbParam<SamplingState> fSamplingState; // during sampling, RT will provide updates
   JmbParam<SlicesSettings> fSlicesSettings; // maintain the settings per slice (forward/reverse, one shot/loop)
+  JmbParam<SharedSliceMap> fSliceMap; // where each slice starts and ends (for the views)
+  JmbParam<SharedSliceMapVersion> fGUINewSliceMapMessage; // the GUI notifies RT when the slice map changes
   JmbParam<UTF8Path> fLargeFilePath;
   JmbParam<error_message_t> fErrorMessage;
   JmbParam<SharedSampleBuffersMgr32 *> fSharedSampleBuffersMgrPtr; // the shared mgr
+  JmbParam<SharedSliceMapMgr *> fSharedSliceMapMgrPtr; // the shared slice map mgr
+  JmbParam<SamplerBuffersRequest> fSamplerBuffersRequest; // RT asks the GUI to allocate the sampler buffers
+  JmbParam<SharedSampleBuffersVersion> fGUISamplerBuffersMessage; // the GUI notifies RT when they are allocated
 
   JmbParam<std::string> fPluginVersion;
 
@@ -123,6 +147,9 @@ public:
   RTVstParam<bool> fPlayModeHold;
   RTVstParam<bool> fPolyphonic;
   RTVstParam<bool> fXFade;
+  RTVstParam<EXFadeCurve> fXFadeCurve;
+  RTVstParam<int> fVoiceLimit;
+  RTVstParam<EVoiceStealing> fVoiceStealing;
   RTVstParam<EInputRouting> fInputRouting;
   RTVstParam<RootKey> fRootKey;
   RTVstParam<bool> *fPads[NUM_PADS];
@@ -135,23 +162,38 @@ public:
   RTRawVstParam fSamplingLeftVuPPM;
   RTRawVstParam fSamplingRightVuPPM;
   RTVstParam<ESamplingTrigger> fSamplingTrigger;
+  RTVstParam<double> fSamplingTriggerThreshold;
+  RTVstParam<int> fSamplingTriggerHold;
+  RTVstParam<bool> fSamplingRetroCapture;
+  RTVstParam<int> fSamplingPreRollInBeats;
+  RTVstParam<bool> fSamplingRetroCommit;
+  RTVstParam<bool> fSamplingToDisk;
 
   RTJmbOutParam<SampleRate> fSampleRate;
   RTJmbOutParam<HostInfo> fHostInfoMessage;
+  RTJmbOutParam<bool> fOfflineRendering;
   RTJmbOutParam<PlayingState> fPlayingState;
 
   // When a new sample is loaded, the UI will let the RT know
   RTJmbInParam<SharedSampleBuffersVersion> fGUINewSampleMessage;
 
   // When sampling is complete, the RT will let the UI know
-  RTJmbOutParam<SharedSampleBuffersVersion> fRTNewSampleMessage;
+  RTJmbOutParam<RTNewSample> fRTNewSampleMessage;
 
   RTJmbOutParam<SamplingState> fSamplingState;
   RTJmbOutParam<SharedSampleBuffersMgr32 *> fSharedSampleBuffersMgrPtr; // the shared mgr
+  RTJmbOutParam<SharedSliceMapMgr *> fSharedSliceMapMgrPtr; // the shared slice map mgr
+
+  // The sampler buffers are allocated by the UI (on request from RT)
+  RTJmbOutParam<SamplerBuffersRequest> fSamplerBuffersRequest;
+  RTJmbInParam<SharedSampleBuffersVersion> fGUISamplerBuffersMessage;
 
   // UI maintains the slices settings (RT cannot handle this type)
   RTJmbInParam<SlicesSettings> fSlicesSettings;
 
+  // UI computes where each slice starts and ends (shared via fSharedSliceMapMgr)
+  RTJmbInParam<SharedSliceMapVersion> fGUINewSliceMapMessage;
+
   // Selected range
   RTJmbInParam<SampleRange> fWESelectedSampleRange;
   RTVstParam<bool> fWEPlaySelection;
@@ -159,6 +201,8 @@ public:
   SampleSlices<NUM_SLICES> fSampleSlices;
 
   SharedSampleBuffersMgr32 fSharedSampleBuffersMgr{};
+  SharedSliceMapMgr fSharedSliceMapMgr{};
+  SharedSamplerBuffersMgr fSamplerBuffersMgr{};
 
 //  SampleSlice fWESelectionSlice{};
   HostInfo fHostInfo;
@@ -173,6 +217,9 @@ public:
     fPlayModeHold{add(iParams.fPlayModeHold)},
     fPolyphonic{add(iParams.fPolyphonic)},
     fXFade{add(iParams.fXFade)},
+    fXFadeCurve{add(iParams.fXFadeCurve)},
+    fVoiceLimit{add(iParams.fVoiceLimit)},
+    fVoiceStealing{add(iParams.fVoiceStealing)},
     fInputRouting{add(iParams.fInputRouting)},
     fRootKey{add(iParams.fRootKey)},
     fPads{nullptr},
@@ -184,14 +231,25 @@ public:
     fSamplingLeftVuPPM{add(iParams.fSamplingLeftVuPPM)},
     fSamplingRightVuPPM{add(iParams.fSamplingRightVuPPM)},
     fSamplingTrigger{add(iParams.fSamplingTrigger)},
+    fSamplingTriggerThreshold{add(iParams.fSamplingTriggerThreshold)},
+    fSamplingTriggerHold{add(iParams.fSamplingTriggerHold)},
+    fSamplingRetroCapture{add(iParams.fSamplingRetroCapture)},
+    fSamplingPreRollInBeats{add(iParams.fSamplingPreRollInBeats)},
+    fSamplingRetroCommit{add(iParams.fSamplingRetroCommit)},
+    fSamplingToDisk{add(iParams.fSamplingToDisk)},
     fSampleRate{addJmbOut(iParams.fSampleRate)},
     fHostInfoMessage{addJmbOut(iParams.fHostInfoMessage)},
+    fOfflineRendering{addJmbOut(iParams.fOfflineRendering)},
     fPlayingState{addJmbOut(iParams.fPlayingState)},
     fGUINewSampleMessage{addJmbIn(iParams.fGUINewSampleMessage)},
     fRTNewSampleMessage{addJmbOut(iParams.fRTNewSampleMessage)},
     fSharedSampleBuffersMgrPtr{addJmbOut(iParams.fSharedSampleBuffersMgrPtr)},
+    fSharedSliceMapMgrPtr{addJmbOut(iParams.fSharedSliceMapMgrPtr)},
     fSamplingState{addJmbOut(iParams.fSamplingState)},
+    fSamplerBuffersRequest{addJmbOut(iParams.fSamplerBuffersRequest)},
+    fGUISamplerBuffersMessage{addJmbIn(iParams.fGUISamplerBuffersMessage)},
     fSlicesSettings{addJmbIn(iParams.fSlicesSettings)},
+    fGUINewSliceMapMessage{addJmbIn(iParams.fGUINewSliceMapMessage)},
     fWESelectedSampleRange{addJmbIn(iParams.fWESelectedSampleRange)},
     fWEPlaySelection{add(iParams.fWEPlaySelection)},
     fSampleSlices{},
@@ -206,6 +264,9 @@ public:
     fSampleSlices.setPlayMode(*fPlayModeHold ? EPlayMode::kHold : EPlayMode::kTrigger);
     fSampleSlices.setPolyphonic(*fPolyphonic);
     fSampleSlices.setCrossFade(*fXFade);
+    fSampleSlices.setCrossFadeCurve(*fXFadeCurve);
+    fSampleSlices.setMaxNumVoices(VOICE_LIMITS[*fVoiceLimit]);
+    fSampleSlices.setVoiceStealing(*fVoiceStealing);
   }
 
   ~SampleSplitterRTState() override
@@ -256,9 +317,12 @@ public:
   GUIJmbParam<PlayingState> fPlayingState;
   GUIJmbParam<GUI::CurrentSample> fCurrentSample;
   GUIJmbParam<GUI::UndoHistory> fUndoHistory;
+  GUIJmbParam<SharedZeroCrossingIndex> fZeroCrossingIndex;
   GUIJmbParam<SampleFile> fSampleFile;
+  GUIJmbParam<GUI::SampleLoadingState> fSampleLoadingState;
   GUIJmbParam<SamplingState> fSamplingState;
   GUIJmbParam<SlicesSettings> fSlicesSettings;
+  GUIJmbParam<SharedSliceMap> fSliceMap;
   GUIJmbParam<SampleRange> fWESelectedSampleRange;
   GUIJmbParam<UTF8Path> fLargeFilePath;
   GUIJmbParam<error_message_t> fErrorMessage;
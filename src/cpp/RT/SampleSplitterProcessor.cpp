@@ -6,6 +6,7 @@
 #include <pluginterfaces/vst/ivstevents.h>
 
 #include "SampleSplitterProcessor.h"
+#include "../AudioKernels.hpp"
 
 #include "version.h"
 #include "jamba_version.h"
@@ -124,10 +125,14 @@ tresult SampleSplitterProcessor::setupProcessing(ProcessSetup &setup)
 
   // sending the shared pointer to the UI
   fState.fSharedSampleBuffersMgrPtr.broadcast(&fState.fSharedSampleBuffersMgr);
+  fState.fSharedSliceMapMgrPtr.broadcast(&fState.fSharedSliceMapMgr);
 
   // sending the sample rate to the UI
   fState.fSampleRate.broadcast(setup.sampleRate);
 
+  // the UI always resamples with the highest quality when rendering offline
+  fState.fOfflineRendering.broadcast(setup.processMode == kOffline);
+
   return result;
 }
 
@@ -157,9 +162,8 @@ tresult SampleSplitterProcessor::genericProcessInputs(ProcessData &data)
   if(!fState.fSampleSlices.empty())
   {
     handlePadSelection();
-    handleNoteSelection(data);
 
-    clearOut = !fState.fSampleSlices.play(out);
+    clearOut = !playSlices(data, out);
   }
 
   if(clearOut)
@@ -173,6 +177,104 @@ tresult SampleSplitterProcessor::genericProcessInputs(ProcessData &data)
   return kResultOk;
 }
 
+//------------------------------------------------------------------------
+// ::clearSection
+//------------------------------------------------------------------------
+template<typename SampleType>
+void clearSection(AudioBuffers<SampleType> &oBuffers, int32 iStartOffset, int32 iEndOffset)
+{
+  if(iStartOffset >= iEndOffset)
+    return;
+
+  for(int32 c = 0; c < oBuffers.getNumChannels(); c++)
+  {
+    auto buffer = oBuffers.getAudioChannel(c).getBuffer();
+    if(buffer)
+      std::fill(buffer + iStartOffset, buffer + iEndOffset, 0);
+  }
+}
+
+//------------------------------------------------------------------------
+// SampleSplitterProcessor::playSlices
+//------------------------------------------------------------------------
+template<typename SampleType>
+bool SampleSplitterProcessor::playSlices(ProcessData &data, AudioBuffers<SampleType> &out)
+{
+  auto events = data.inputEvents;
+  auto numEvents = events ? events->getEventCount() : 0;
+  auto numSamples = out.getNumSamples();
+
+  bool played = false;
+  int32 lastSelectedSlice = -1;
+
+  // the frame is split in sections delimited by the offset of each (note) event so that the slice starts (resp.
+  // stops) playing at the exact sample the event happened
+  int32 startOffset = 0;
+  int32 eventIndex = 0;
+
+  while(startOffset < numSamples)
+  {
+    // handle all the events happening at startOffset
+    int32 endOffset = numSamples;
+
+    while(eventIndex < numEvents)
+    {
+      Vst::Event e{};
+      events->getEvent(eventIndex, e);
+
+      // events are supposed to be sorted but the host could send an offset outside of the frame
+      auto eventOffset = Utils::clamp(e.sampleOffset, startOffset, numSamples - 1);
+
+      if(eventOffset > startOffset)
+      {
+        endOffset = eventOffset;
+        break;
+      }
+
+      auto slice = handleNoteSelection(e, getTimestamp(startOffset));
+      if(slice != -1)
+        lastSelectedSlice = slice;
+
+      eventIndex++;
+    }
+
+    if(fState.fSampleSlices.play(out, startOffset, endOffset, true))
+    {
+      // the section(s) before the first one played need to be cleared
+      if(!played)
+        clearSection(out, 0, startOffset);
+      played = true;
+    }
+    else
+    {
+      if(played)
+        clearSection(out, startOffset, endOffset);
+    }
+
+    startOffset = endOffset;
+  }
+
+  // only happens when the frame is empty (no samples) in which case events are still processed
+  for(; eventIndex < numEvents; eventIndex++)
+  {
+    Vst::Event e{};
+    events->getEvent(eventIndex, e);
+    auto slice = handleNoteSelection(e, getTimestamp(0));
+    if(slice != -1)
+      lastSelectedSlice = slice;
+  }
+
+  if(played)
+    fState.fSampleSlices.adjustSilenceFlags(out);
+
+  if(lastSelectedSlice > -1 && *fState.fFollowMidiSelection)
+  {
+    fState.fSelectedSliceViaMidi.update(lastSelectedSlice, data);
+  }
+
+  return played;
+}
+
 //------------------------------------------------------------------------
 // processMonoInput
 //------------------------------------------------------------------------
@@ -208,38 +310,97 @@ void SampleSplitterProcessor::processMonoInput(AudioBuffers<SampleType> &out) co
 }
 
 //------------------------------------------------------------------------
-// ::getNonSilentOffset
+// SampleSplitterProcessor::getOnSoundOffset
 //------------------------------------------------------------------------
 template<typename SampleType>
-int32 getNonSilentOffset(AudioBuffers<SampleType> &iBuffers)
+int32 SampleSplitterProcessor::getOnSoundOffset(AudioBuffers<SampleType> &iBuffers)
 {
-  int32 res = iBuffers.getNumSamples();
+  constexpr int32 CHUNK_SIZE = 64;
 
-  for(int c = 0; c < iBuffers.getNumChannels(); c++)
+  auto silentThreshold = getSampleSilentThreshold<SampleType>();
+
+  auto thresholdInDb = *fState.fSamplingTriggerThreshold;
+  auto threshold = thresholdInDb <= SAMPLING_TRIGGER_THRESHOLD_MIN_DB ?
+                   silentThreshold :
+                   dbToSample<SampleType>(thresholdInDb);
+
+  // once above the threshold, the input only needs to stay above this (lower) threshold to be held
+  auto releaseThreshold =
+    std::max<SampleType>(threshold * dbToSample<SampleType>(-SAMPLING_TRIGGER_HYSTERESIS_DB), silentThreshold);
+
+  auto holdCount = getSamplingTriggerHoldCount();
+
+  auto numSamples = iBuffers.getNumSamples();
+
+  // when the input was already held during the previous frame(s), the onset precedes this frame: sampling starts at
+  // the beginning of this one and the sampler looks back for what was captured since the onset
+  int32 onset = 0;
+  fSamplingLookBackCount = fSamplingTriggerHeldCount;
+
+  for(int32 i = 0; i < numSamples; i += CHUNK_SIZE)
   {
-    auto buffer = iBuffers.getAudioChannel(c).getBuffer();
-    if(buffer)
+    auto chunkSize = std::min(CHUNK_SIZE, numSamples - i);
+
+    if(fSamplingTriggerHeldCount == 0)
+    {
+      // first sample above the threshold across all channels (each channel only scanned up to the best so far)
+      auto first = chunkSize;
+      for(int32 c = 0; c < iBuffers.getNumChannels(); c++)
+      {
+        auto buffer = iBuffers.getAudioChannel(c).getBuffer();
+        if(buffer)
+          first = std::min(first, Kernels::findFirstAbove(buffer + i, first, threshold));
+      }
+
+      if(first == chunkSize)
+        continue;
+
+      onset = i + first;
+      fSamplingLookBackCount = 0;
+      fSamplingTriggerHeldCount = chunkSize - first;
+    }
+    else
     {
-      auto found = std::find_if(buffer,
-                                buffer + iBuffers.getNumSamples(),
-                                [](auto sample) {return !pongasoft::VST::isSilent(sample);});
-      res = std::min<int32>(res, static_cast<int32>(found - buffer));
+      SampleType peak = 0;
+      for(int32 c = 0; c < iBuffers.getNumChannels(); c++)
+      {
+        auto buffer = iBuffers.getAudioChannel(c).getBuffer();
+        if(buffer)
+          peak = std::max(peak, Kernels::peak(buffer + i, chunkSize));
+      }
+
+      if(peak <= releaseThreshold)
+      {
+        fSamplingTriggerHeldCount = 0;
+        continue;
+      }
+
+      fSamplingTriggerHeldCount += chunkSize;
     }
+
+    if(fSamplingTriggerHeldCount >= holdCount)
+      return onset;
   }
 
-  if(res == iBuffers.getNumSamples())
-    res = -1;
+  return -1;
+}
 
-  return res;
+//------------------------------------------------------------------------
+// SampleSplitterProcessor::getSamplingTriggerHoldCount
+//------------------------------------------------------------------------
+int32 SampleSplitterProcessor::getSamplingTriggerHoldCount() const
+{
+  return static_cast<int32>(fClock.getSampleCountFor(SAMPLING_TRIGGER_HOLD_MS[*fState.fSamplingTriggerHold]));
 }
 
 //------------------------------------------------------------------------
 // SampleSplitterProcessor::getStartSamplingOffset
 //------------------------------------------------------------------------
 template<typename SampleType>
-int32 SampleSplitterProcessor::getStartSamplingOffset(ProcessData &iData, AudioBuffers<SampleType> &iBuffers) const
+int32 SampleSplitterProcessor::getStartSamplingOffset(ProcessData &iData, AudioBuffers<SampleType> &iBuffers)
 {
   int32 offset = 0;
+  fSamplingLookBackCount = 0;
 
   switch(fState.fSamplingTrigger)
   {
@@ -255,7 +416,7 @@ int32 SampleSplitterProcessor::getStartSamplingOffset(ProcessData &iData, AudioB
       break;
 
     case ESamplingTrigger::kSamplingTriggerOnSound:
-      offset = getNonSilentOffset(iBuffers);
+      offset = getOnSoundOffset(iBuffers);
       break;
   }
 
@@ -263,32 +424,37 @@ int32 SampleSplitterProcessor::getStartSamplingOffset(ProcessData &iData, AudioB
 }
 
 //------------------------------------------------------------------------
-// GainMaxSilentOp
+// GainMaxSilent
 //------------------------------------------------------------------------
 template<typename SampleType>
-struct GainMaxSilentOp
+struct GainMaxSilent
 {
-  SampleType operator()(SampleType const iSample)
-  {
-    auto res = static_cast<SampleType>(iSample * fGain.getValue());
+  SampleType fAbsoluteMax{0};
+  bool fSilent{true};
+};
 
-    // keep track of silent flag
-    if(fSilent)
-      fSilent = pongasoft::VST::isSilent(res);
+//------------------------------------------------------------------------
+// ::copyWithGain
+// Copies the input channel into the output channel applying gain and computes the max + silent flag (in one pass)
+//------------------------------------------------------------------------
+template<typename SampleType>
+GainMaxSilent<SampleType> copyWithGain(SampleType const *iIn, SampleType *oOut, int32 iNumSamples, Gain const &iGain)
+{
+  GainMaxSilent<SampleType> res{};
 
-    // keep track of max
-    if(iSample < 0)
-      fAbsoluteMax = std::max(fAbsoluteMax, -res);
+  if(oOut)
+  {
+    if(iIn)
+    {
+      res.fAbsoluteMax = Kernels::copyWithGain(iIn, oOut, iNumSamples, iGain.getValue());
+      res.fSilent = res.fAbsoluteMax <= getSampleSilentThreshold<SampleType>();
+    }
     else
-      fAbsoluteMax = std::max(fAbsoluteMax, res);
-
-    return res;
+      std::fill(oOut, oOut + iNumSamples, 0);
   }
 
-  Gain fGain;
-  SampleType fAbsoluteMax{0};
-  bool fSilent{true};
-};
+  return res;
+}
 
 //------------------------------------------------------------------------
 // SampleSplitterProcessor::processSampling
@@ -313,10 +479,14 @@ tresult SampleSplitterProcessor::processSampling(ProcessData &data)
   const AudioBuffers<SampleType> in(data.inputs[input], data.numSamples);
 
   // we start by applying gain and computing max + silent flag
-  auto left =
-    out.getLeftChannel().copyFrom(in.getLeftChannel(), GainMaxSilentOp<SampleType>{*fState.fSamplingInputGain});
-  auto right =
-    out.getRightChannel().copyFrom(in.getRightChannel(), GainMaxSilentOp<SampleType>{*fState.fSamplingInputGain});
+  auto left = copyWithGain(in.getLeftChannel().getBuffer(),
+                           out.getLeftChannel().getBuffer(),
+                           data.numSamples,
+                           *fState.fSamplingInputGain);
+  auto right = copyWithGain(in.getRightChannel().getBuffer(),
+                            out.getRightChannel().getBuffer(),
+                            data.numSamples,
+                            *fState.fSamplingInputGain);
 
   bool broadcastSample = false;
 
@@ -324,22 +494,21 @@ tresult SampleSplitterProcessor::processSampling(ProcessData &data)
   {
     if(*fState.fSampling)
     {
-      int32 offset = getStartSamplingOffset(data, out);
+      fSamplingTriggerHeldCount = 0;
+
+      // the sampler may still be waiting for its buffers (allocated by the UI)
+      int32 offset = fSampler.isInitialized() ? getStartSamplingOffset(data, out) : -1;
 
       fWaitingForSampling = offset == -1;
 
       if(fWaitingForSampling)
       {
         DLOG_F(INFO, "waiting for sampling...");
+        fSampler.sample(out); // keeps capturing (pre-roll)
         fState.fSamplingState.broadcast(SamplingState{PERCENT_SAMPLED_WAITING});
       }
       else
-      {
-        DLOG_F(INFO, "start sampling... offset=%d", offset);
-        fSampler.start();
-        fSampler.sample(out, offset, -1);
-        fState.fSamplingState.broadcast(SamplingState{fSampler.getPercentSampled()});
-      }
+        startSampling(data, out, offset);
     }
     else
     {
@@ -351,6 +520,8 @@ tresult SampleSplitterProcessor::processSampling(ProcessData &data)
         fSampler.stop();
         broadcastSample = true;
       }
+      else
+        fSampler.sample(out); // captures (when enabled)
 
       fState.fSamplingState.broadcast(SamplingState{0});
     }
@@ -361,17 +532,14 @@ tresult SampleSplitterProcessor::processSampling(ProcessData &data)
     {
       if(fWaitingForSampling)
       {
-        int32 offset = getStartSamplingOffset(data, out);
+        int32 offset = fSampler.isInitialized() ? getStartSamplingOffset(data, out) : -1;
 
         fWaitingForSampling = offset == -1;
 
         if(!fWaitingForSampling)
-        {
-          DLOG_F(INFO, "start sampling... offset=%d", offset);
-          fSampler.start();
-          fSampler.sample(out, offset, -1);
-          fState.fSamplingState.broadcast(SamplingState{fSampler.getPercentSampled()});
-        }
+          startSampling(data, out, offset);
+        else
+          fSampler.sample(out); // keeps capturing (pre-roll)
       }
       else
       {
@@ -390,22 +558,61 @@ tresult SampleSplitterProcessor::processSampling(ProcessData &data)
 
       }
     }
+    else
+      fSampler.sample(out); // captures (when enabled)
+  }
+
+  // commits what was captured during the last "sampling duration" (as if it had just been sampled)
+  if(fState.fSamplingRetroCommit.hasChanged() && *fState.fSamplingRetroCommit)
+  {
+    if(!*fState.fSampling && *fState.fSamplingRetroCapture && fSampler.commit())
+    {
+      DLOG_F(INFO, "retro commit...");
+      broadcastSample = true;
+    }
+    fState.fSamplingRetroCommit.update(false, data);
   }
 
   if(broadcastSample)
   {
-    auto buffers = fSampler.acquireBuffers();
+    // the sampler hands over the buffers it sampled into (no copy) and switches to the spare ones
+    auto take = fSampler.acquireBuffers();
 
-    if(buffers)
+    if(take.fStreamTakeId > 0)
     {
-      // we use the buffer we just sampled for playing in RT
-      fState.fSampleSlices.setBuffers(buffers.get());
+      // the take was streamed to disk: the UI loads it (like a file) once the writer thread is done with it
+      fState.fRTNewSampleMessage.broadcast(RTNewSample{0, 0, take.fNumSamples, take.fStreamTakeId});
+    }
+    else if(take.fBuffers)
+    {
+      // we use the buffer we just sampled for playing in RT only when the take fills it entirely (otherwise the UI
+      // sends back a right sized copy: the buffers are never modified once handed over)
+      auto useAsIs = take.fStartOffset == 0 && take.fNumSamples == take.fBuffers->getNumSamples();
+      if(useAsIs)
+      {
+        fState.fSampleSlices.setBuffers(take.fBuffers);
+        fState.fSharedSampleBuffersMgr.rtRelease(std::move(fReplacedSampleBuffers));
+      }
+      else if(!fReplacedSampleBuffers)
+      {
+        // the buffers being played are handed to the UI by rtSetObject (below) but are still played until the UI
+        // sends back the copy: keep them alive until then (only the first time if several takes are in flight)
+        fReplacedSampleBuffers = fState.fSharedSampleBuffersMgr.rtGetObject();
+      }
 
-      // we store it in the mgr
-      auto version = fState.fSharedSampleBuffersMgr.rtSetObject(std::move(buffers));
+      // we store it in the mgr (sharing the pointer allocated by the UI => no allocation)
+      auto samplerBuffers = fState.fSamplerBuffersMgr.rtGetObject().get(); // see SharedObjectMgr note 3
+      auto version = fState.fSharedSampleBuffersMgr.rtSetObject(samplerBuffers->fBuffers.get() == take.fBuffers ?
+                                                                samplerBuffers->fBuffers :
+                                                                samplerBuffers->fSpareBuffers);
 
       // and notify the UI of the new sample
-      fState.fRTNewSampleMessage.broadcast(version);
+      fState.fRTNewSampleMessage.broadcast(RTNewSample{version, take.fStartOffset, take.fNumSamples});
+
+      // the UI hands the buffers back (as spare buffers) once it has copied the take. When the take is used as is
+      // (or the UI has not handed back the buffers of the previous take yet), a fresh pair is needed for next time.
+      if(useAsIs || !fSampler.isInitialized())
+        requestSamplerBuffers(fSamplerBuffersRequest.fNumSamples);
     }
   }
 
@@ -429,6 +636,30 @@ tresult SampleSplitterProcessor::processSampling(ProcessData &data)
     return out.clear();
 }
 
+//------------------------------------------------------------------------
+// SampleSplitterProcessor::startSampling
+//------------------------------------------------------------------------
+template<typename SampleType>
+void SampleSplitterProcessor::startSampling(ProcessData &iData, AudioBuffers<SampleType> &iBuffers, int32 iOffset)
+{
+  DLOG_F(INFO, "start sampling... offset=%d", iOffset);
+  fSampler.sample(iBuffers, 0, iOffset); // captures what precedes the trigger (pre-roll)
+  fSampler.start(fSamplingLookBackCount);
+
+  // when streaming, the previous take may still be written to disk (see SampleStreamWriter::rtBeginTake): the
+  // sampling toggle is turned off and the UI is told why
+  if(fSampler.isStreaming() && !fSampler.isSampling())
+  {
+    DLOG_F(WARNING, "cannot start sampling: the previous take has not been handed over yet");
+    fState.fSampling.update(false, iData);
+    fState.fSamplingState.broadcast(SamplingState{PERCENT_SAMPLED_BUSY});
+    return;
+  }
+
+  fSampler.sample(iBuffers, iOffset, -1);
+  fState.fSamplingState.broadcast(SamplingState{fSampler.getPercentSampled()});
+}
+
 //------------------------------------------------------------------------
 // SampleSplitterProcessor::maybeInitSampler
 //------------------------------------------------------------------------
@@ -445,18 +676,121 @@ bool SampleSplitterProcessor::maybeInitSampler(ProcessData &iData)
   // we make sure we have the most up to date info about the host
   processHostInfo(iData);
 
-  auto sampleCount = fClock.getSampleCountFor1Bar(fState.fHostInfo.fTempo,
-                                                  fState.fHostInfo.fTimeSigNumerator,
-                                                  fState.fHostInfo.fTimeSigDenominator)
-                     * *fState.fSamplingDurationInBars;
+  // when streaming to disk, RT only needs the (fixed size) FIFO of the writer
+  if(*fState.fSamplingToDisk)
+  {
+    fSampler.setCapture(false);
+
+    auto fifoSampleCount = static_cast<int32>(fClock.getSampleCountFor(SAMPLING_STREAM_FIFO_SIZE_MS));
 
-  // Implementation note: this call allocates memory but it is ok as this happens only when switching between
-  // sampling and not sampling... as a user request
-  fSampler.init(fClock.getSampleRate(), sampleCount);
+    if(!fSamplerBuffersRequest.fStream ||
+       fSamplerBuffersRequest.fSampleRate != fClock.getSampleRate() ||
+       fSamplerBuffersRequest.fNumSamples != fifoSampleCount)
+      requestSamplerBuffers(fifoSampleCount, true);
+
+    return true;
+  }
+
+  auto barSampleCount = fClock.getSampleCountFor1Bar(fState.fHostInfo.fTempo,
+                                                     fState.fHostInfo.fTimeSigNumerator,
+                                                     fState.fHostInfo.fTimeSigDenominator);
+
+  // when capturing, the buffers also hold the pre-roll
+  auto preRollCount = *fState.fSamplingRetroCapture ?
+                      static_cast<int32>(barSampleCount / std::max(fState.fHostInfo.fTimeSigNumerator, 1)
+                                         * *fState.fSamplingPreRollInBeats) :
+                      0;
+
+  // when triggered on sound, the onset may precede the frame sampling starts in (the hold spanning several frames):
+  // the sampler captures (at least) the hold duration so that the take still starts at the onset
+  auto lookBackCount = fState.fSamplingTrigger == ESamplingTrigger::kSamplingTriggerOnSound ?
+                       getSamplingTriggerHoldCount() :
+                       0;
+
+  auto sampleCount = static_cast<int32>(barSampleCount * *fState.fSamplingDurationInBars) + preRollCount + lookBackCount;
+
+  fSampler.setCapture(*fState.fSamplingRetroCapture || lookBackCount > 0, preRollCount, lookBackCount);
+
+  // no need to reallocate when the buffers (already provided or about to be) have the right size
+  if(fSamplerBuffersRequest.fStream ||
+     fSamplerBuffersRequest.fSampleRate != fClock.getSampleRate() ||
+     fSamplerBuffersRequest.fNumSamples != sampleCount)
+    requestSamplerBuffers(sampleCount);
 
   return true;
 }
 
+//------------------------------------------------------------------------
+// SampleSplitterProcessor::requestSamplerBuffers
+//------------------------------------------------------------------------
+void SampleSplitterProcessor::requestSamplerBuffers(int32 iNumSamples, bool iStream)
+{
+  auto request = SamplerBuffersRequest{&fState.fSamplerBuffersMgr,
+                                      fClock.getSampleRate(),
+                                      fSampler.getNumChannels(),
+                                      iNumSamples,
+                                      iStream && iNumSamples > 0};
+
+  // the sampler cannot use the current buffers (wrong size) and must wait for the new ones
+  if(request.fSampleRate != fSamplerBuffersRequest.fSampleRate ||
+     request.fNumSamples != fSamplerBuffersRequest.fNumSamples ||
+     request.fStream != fSamplerBuffersRequest.fStream)
+    fSampler.dispose();
+
+  // the current buffers are handed back to the UI (which frees them)
+  if(iNumSamples == 0)
+    fState.fSamplerBuffersMgr.rtSetObject(nullptr);
+
+  fSamplerBuffersRequest = request;
+
+  fState.fSamplerBuffersRequest.broadcast(fSamplerBuffersRequest);
+}
+
+//------------------------------------------------------------------------
+// SampleSplitterProcessor::onSamplerBuffersReceived
+//------------------------------------------------------------------------
+void SampleSplitterProcessor::onSamplerBuffersReceived(SharedSampleBuffersVersion iVersion)
+{
+  bool updated{};
+  auto samplerBuffers = fState.fSamplerBuffersMgr.rtAdjustObjectFromUI(iVersion, &updated).get();
+
+  if(updated)
+  {
+    // the buffers of a previous take handed back by the UI: the sampler keeps using the buffers it is using (which
+    // the recycled pair holds as well) so this can happen while sampling. They are ignored when the sampler is not
+    // using these buffers anymore (a fresh pair has been requested in this case).
+    if(samplerBuffers && samplerBuffers->fRecycled)
+    {
+      fSampler.setSpareBuffers(samplerBuffers->fBuffers.get(), samplerBuffers->fSpareBuffers.get());
+      return;
+    }
+
+    // the previous buffers are handed back to the UI so this must not happen while sampling into them
+    DCHECK_F(!fSampler.isSampling());
+
+    // streaming to disk (the same writer is used for all the takes)
+    if(samplerBuffers && samplerBuffers->fStream)
+    {
+      if(fSamplerBuffersRequest.fStream &&
+         samplerBuffers->fStream->getSampleRate() == fSamplerBuffersRequest.fSampleRate)
+        fSampler.init(samplerBuffers->fStream.get());
+      else
+        fSampler.dispose();
+      return;
+    }
+
+    auto buffers = samplerBuffers ? samplerBuffers->fBuffers.get() : nullptr;
+
+    // ignoring buffers for an outdated request (the UI will soon provide the right ones)
+    if(buffers &&
+       buffers->getSampleRate() == fSamplerBuffersRequest.fSampleRate &&
+       buffers->getNumSamples() == fSamplerBuffersRequest.fNumSamples)
+      fSampler.init(buffers, samplerBuffers->fSpareBuffers.get());
+    else
+      fSampler.dispose();
+  }
+}
+
 //------------------------------------------------------------------------
 // SampleSplitterProcessor::processHostInfo
 //------------------------------------------------------------------------
@@ -525,6 +859,11 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
   // increment the number of frames
   fFrameCount++;
 
+  // sends what could not be sent to the UI to be released (if anything) since the UI may have made room
+  fState.fSharedSampleBuffersMgr.rtFlush();
+  fState.fSharedSliceMapMgr.rtFlush();
+  fState.fSamplerBuffersMgr.rtFlush();
+
 //  DLOG_F(INFO, "[%d] processInputs()", fFrameCount);
 
   // Detect the fact that the GUI has sent a message to the RT.
@@ -542,6 +881,17 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
     }
 
     fState.fSampleSlices.setBuffers(buffers.get());
+
+    // no longer played => the UI can release them
+    fState.fSharedSampleBuffersMgr.rtRelease(std::move(fReplacedSampleBuffers));
+  }
+
+  // Detect the fact that the GUI has allocated the buffers for the sampler (left for later while sampling since
+  // the sampler is using the current ones)
+  if(!fSampler.isSampling())
+  {
+    if(auto samplerVersion = fState.fGUISamplerBuffersMessage.pop())
+      onSamplerBuffersReceived(*samplerVersion);
   }
 
   // Detect a slice settings change
@@ -554,12 +904,25 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
     }
   }
 
+  // Detect a change in where each slice starts and ends
+  if(auto sliceMapVersion = fState.fGUINewSliceMapMessage.pop())
+  {
+    bool updated = false;
+    auto sliceMap = fState.fSharedSliceMapMgr.rtAdjustObjectFromUI(*sliceMapVersion, &updated);
+    if(updated)
+      fState.fSampleSlices.setSliceMap(sliceMap.get());
+  }
+
   // Detect XFade change
   if(fState.fXFade.hasChanged())
   {
     fState.fSampleSlices.setCrossFade(*fState.fXFade);
   }
 
+  // Detect XFade curve change
+  if(fState.fXFadeCurve.hasChanged())
+    fState.fSampleSlices.setCrossFadeCurve(*fState.fXFadeCurve);
+
   // Detect polyphonic change
   if(fState.fPolyphonic.hasChanged())
     fState.fSampleSlices.setPolyphonic(*fState.fPolyphonic);
@@ -568,6 +931,14 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
   if(fState.fPlayModeHold.hasChanged())
     fState.fSampleSlices.setPlayMode(*fState.fPlayModeHold ? EPlayMode::kHold : EPlayMode::kTrigger);
 
+  // Detect voice limit change
+  if(fState.fVoiceLimit.hasChanged())
+    fState.fSampleSlices.setMaxNumVoices(VOICE_LIMITS[*fState.fVoiceLimit]);
+
+  // Detect voice stealing change
+  if(fState.fVoiceStealing.hasChanged())
+    fState.fSampleSlices.setVoiceStealing(*fState.fVoiceStealing);
+
   // handle selected range change
   auto selectedRange = fState.fWESelectedSampleRange.pop();
   if(selectedRange)
@@ -599,9 +970,8 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
       // we make sure that sampling is not on anymore
       fState.fSampling.update(false, data);
       fState.fSamplingState.broadcast(SamplingState{0});
-      // Implementation note: this call frees memory but it is ok as this happens only when switching between
-      // sampling and not sampling... as a user request
-      fSampler.dispose();
+      // the sampler buffers are freed by the UI
+      requestSamplerBuffers(0);
 
       // we reset the vu ppms
       fState.fSamplingLeftVuPPM.update(0, data);
@@ -616,8 +986,13 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
     }
   }
 
-  // the sampling duration has changed
-  if(fState.fSamplingDurationInBars.hasChanged())
+  // the sampling duration (or capture/streaming/look back when triggered on sound) has changed
+  if(fState.fSamplingDurationInBars.hasChanged() ||
+     fState.fSamplingRetroCapture.hasChanged() ||
+     fState.fSamplingPreRollInBeats.hasChanged() ||
+     fState.fSamplingToDisk.hasChanged() ||
+     fState.fSamplingTrigger.hasChanged() ||
+     fState.fSamplingTriggerHold.hasChanged())
     maybeInitSampler(data);
 
   tresult res = RTProcessor::processInputs(data);
@@ -626,13 +1001,19 @@ tresult SampleSplitterProcessor::processInputs(ProcessData &data)
   {
     if(fRateLimiter.shouldUpdate(static_cast<uint32>(data.numSamples)))
     {
-      fState.fPlayingState.broadcast([this](PlayingState *oPlayingState) {
-        for(int slice = 0; slice < NUM_SLICES; slice++)
-        {
-          oPlayingState->fPercentPlayed[slice] = fState.fSampleSlices.getPercentPlayed(slice);
-        }
-        oPlayingState->fWESelectionPercentPlayer = fState.fSampleSlices.getWESlicePercentPlayed();
-      });
+      PlayingState playingState{};
+      for(int slice = 0; slice < NUM_SLICES; slice++)
+      {
+        playingState.fPercentPlayed[slice] = fState.fSampleSlices.getPercentPlayed(slice);
+      }
+      playingState.fWESelectionPercentPlayer = fState.fSampleSlices.getWESlicePercentPlayed();
+
+      // nothing to send when nothing changed (ex: nothing playing)
+      if(playingState != fLastPlayingState)
+      {
+        fState.fPlayingState.broadcast(playingState);
+        fLastPlayingState = playingState;
+      }
 
       // update host info (if changed)
       processHostInfo(data);
@@ -658,7 +1039,7 @@ void SampleSplitterProcessor::handlePadSelection()
     for(int i = 0; i < numSlices; i++)
     {
       if(i < start || i >= end)
-        fState.fSampleSlices.setPadSelected(i, false, fFrameCount);
+        fState.fSampleSlices.setPadSelected(i, false, getTimestamp(0));
     }
   }
 
@@ -667,60 +1048,42 @@ void SampleSplitterProcessor::handlePadSelection()
     auto padState = fState.fPads[pad];
 
     if(padState->hasChanged())
-      fState.fSampleSlices.setPadSelected(slice, padState->value(), fFrameCount);
+      fState.fSampleSlices.setPadSelected(slice, padState->value(), getTimestamp(0));
   }
 }
 
 //------------------------------------------------------------------------
-// SampleSplitterProcessor::handlePadSelection
+// SampleSplitterProcessor::handleNoteSelection
 //------------------------------------------------------------------------
-void SampleSplitterProcessor::handleNoteSelection(ProcessData &data)
+int32 SampleSplitterProcessor::handleNoteSelection(Vst::Event const &iEvent, uint64 iTimestamp)
 {
-  auto events = data.inputEvents;
+  int32 slice = -1;
+  bool selected = false;
 
-  int32 lastSelectedSlice = -1;
-
-  if(events && events->getEventCount() > 0)
+  switch(iEvent.type)
   {
-    auto numSlices = fState.fNumSlices->intValue();
-
-    for(int32 i = 0; i < events->getEventCount(); i++)
-    {
-      int32 slice = -1;
-      bool selected = false;
-
-      Vst::Event e{};
-      events->getEvent(i, e);
+    case Vst::Event::kNoteOnEvent:
+      slice = iEvent.noteOn.pitch - *fState.fRootKey;
+      selected = true;
+//      DLOG_F(INFO, "Note on %d, %d, %f, %d", slice, iEvent.sampleOffset, iEvent.ppqPosition, iEvent.flags);
+      break;
 
-      switch(e.type)
-      {
-        case Vst::Event::kNoteOnEvent:
-          slice = e.noteOn.pitch - *fState.fRootKey;
-          lastSelectedSlice = slice;
-          selected = true;
-//          DLOG_F(INFO, "Note on %d, %d, %f, %d", slice, e.sampleOffset, e.ppqPosition, e.flags);
-          break;
-
-        case Vst::Event::kNoteOffEvent:
-          slice = e.noteOn.pitch - *fState.fRootKey;
-          selected = false;
-          break;
-
-        default:
-          break;
-      }
+    case Vst::Event::kNoteOffEvent:
+      slice = iEvent.noteOff.pitch - *fState.fRootKey;
+      selected = false;
+      break;
 
-      if(slice >= 0 && slice < numSlices)
-      {
-        fState.fSampleSlices.setNoteSelected(slice, selected, fFrameCount);
-      }
-    }
+    default:
+      break;
   }
 
-  if(lastSelectedSlice > -1 && *fState.fFollowMidiSelection)
+  if(slice >= 0 && slice < fState.fNumSlices->intValue())
   {
-    fState.fSelectedSliceViaMidi.update(lastSelectedSlice, data);
+    fState.fSampleSlices.setNoteSelected(slice, selected, iTimestamp);
+    return selected ? slice : -1;
   }
+
+  return -1;
 }
 
 }
@@ -2,6 +2,7 @@
 
 #include <pongasoft/VST/RT/RTProcessor.h>
 #include <pongasoft/VST/SampleRateBasedClock.h>
+#include <pluginterfaces/vst/ivstevents.h>
 #include "../Plugin.h"
 #include "../Sampler.hpp"
 
@@ -74,10 +75,27 @@ protected:
    */
   void handlePadSelection();
 
+  /**
+   * Plays the slices, splitting the frame at each (note) event offset so that slices start and stop at the exact
+   * sample the event happened (and not at the beginning of the frame)
+   *
+   * @return `true` if anything was played at all or `false` if `out` was left untouched */
+  template<typename SampleType>
+  bool playSlices(ProcessData &data, AudioBuffers<SampleType> &out);
+
   /**
    * will determine which note is selected
+   *
+   * @return the slice selected by this event (`-1` if the event does not select a slice)
    */
-  void handleNoteSelection(ProcessData &data);
+  int32 handleNoteSelection(Vst::Event const &iEvent, uint64 iTimestamp);
+
+  /**
+   * @return a value which orders events (pads and notes) in time across frames (used for monophonic mode) */
+  inline uint64 getTimestamp(int32 iSampleOffset) const
+  {
+    return (static_cast<uint64>(fFrameCount) << 32) | static_cast<uint32>(iSampleOffset);
+  }
 
   /**
    * @return `-1` if the host is not playing, otherwise the playing offset */
@@ -88,15 +106,48 @@ protected:
    * @return `-1` if should not start
    */
   template<typename SampleType>
-  int32 getStartSamplingOffset(ProcessData &iData, AudioBuffers<SampleType> &iBuffers) const;
+  int32 getStartSamplingOffset(ProcessData &iData, AudioBuffers<SampleType> &iBuffers);
 
   /**
-   * Initializes the sampler if it is possible (for example, cannot initialize the sampler while sampling...)
+   * Determines the offset at which sampling should start when triggered by sound: the input must go above the
+   * threshold and then be held (above the threshold minus the hysteresis) for the hold duration, which may span
+   * several frames. In this case the onset precedes this frame (by `fSamplingLookBackCount` samples, which the sampler
+   * looks back for) and the offset is `0`.
    *
-   * @return `true` if the sampler was initialized, `false` otherwise
+   * @return `-1` if should not start (yet) */
+  template<typename SampleType>
+  int32 getOnSoundOffset(AudioBuffers<SampleType> &iBuffers);
+
+  // how long (in samples) the input must be held above the threshold when triggered by sound
+  int32 getSamplingTriggerHoldCount() const;
+
+  /**
+   * Starts sampling at `iOffset` in `iBuffers` (what precedes it being captured as pre-roll) and tells the UI. When
+   * the sampler cannot start (streaming and the previous take not handed over yet), the sampling toggle is turned
+   * off and the UI is told (`PERCENT_SAMPLED_BUSY`). */
+  template<typename SampleType>
+  void startSampling(ProcessData &iData, AudioBuffers<SampleType> &iBuffers, int32 iOffset);
+
+  /**
+   * Initializes the sampler if it is possible (for example, cannot initialize the sampler while sampling...). Unless
+   * the current buffers already have the right size, the sampler is only ready once the UI has allocated the buffers
+   * (see `requestSamplerBuffers`).
+   *
+   * @return `true` if the sampler was initialized (or new buffers requested), `false` otherwise
    */
   bool maybeInitSampler(ProcessData &iData);
 
+  /**
+   * Requests the UI to allocate the buffers for the sampler (`iNumSamples == 0` means that the current buffers
+   * are no longer needed and are handed back to the UI to be freed). This way memory is never allocated nor freed
+   * in the audio thread. When `iStream` is `true`, requests a writer (with a FIFO of `iNumSamples`) to stream the
+   * takes to disk instead. */
+  void requestSamplerBuffers(int32 iNumSamples, bool iStream = false);
+
+  /**
+   * Called when the UI has allocated the buffers for the sampler */
+  void onSamplerBuffersReceived(SharedSampleBuffersVersion iVersion);
+
 private:
   // The processor gets its own copy of the parameters (defined in Plugin.h)
   SampleSplitterParameters fParams;
@@ -111,11 +162,21 @@ private:
   SampleRateBasedClock::RateLimiter fRateLimiter;
   SampleRateBasedClock::RateLimiter fSamplingRateLimiter;
 
+  // Last playing state sent to the UI (only sent again when it changes)
+  PlayingState fLastPlayingState{};
+
   // The sampler
   Sampler32 fSampler;
   bool fWaitingForSampling;
+  int32 fSamplingTriggerHeldCount{}; // how long (in samples) the input has been held above the trigger threshold
+  int32 fSamplingLookBackCount{}; // how long (in samples) before the start offset the trigger onset happened
+  SamplerBuffersRequest fSamplerBuffersRequest{}; // last request sent to the UI
+
+  // The buffers still being played after a (partial) take replaced them in fSharedSampleBuffersMgr: they are kept
+  // alive until the UI sends back the copy of the take (then handed back to the UI to be released, see rtRelease)
+  std::shared_ptr<SampleBuffers32> fReplacedSampleBuffers{};
 
-  // Counter to keep track of frames (used in pad selection)
+  // Counter to keep track of frames (used in slice selection)
   uint32 fFrameCount{};
 };
 
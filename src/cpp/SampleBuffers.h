@@ -3,6 +3,7 @@
 #include <pluginterfaces/base/ftypes.h>
 #include <pluginterfaces/vst/vsttypes.h>
 #include <algorithm>
+#include <functional>
 #include <vector>
 
 #include <pongasoft/VST/ParamSerializers.h>
@@ -15,6 +16,14 @@ namespace pongasoft::VST::SampleSplitter {
 
 using namespace Steinberg;
 
+/**
+ * The quality of `SampleBuffers::resample`: the higher the quality, the slower the resampling. */
+enum class EResamplingQuality
+{
+  kFast, // 16 bits quality (~3 times faster)
+  kHigh  // 24 bits quality
+};
+
 /**
  * Helper class which maintains buffers (one per channel) of samples (in a given SampleType type).
  */
@@ -67,16 +76,36 @@ public:
    * Save this buffer to the file and return the file size */
   tresult save(SndfileHandle &iFileHandle) const;
 
+  /**
+   * Called periodically by long operations (like `resample`) with the fraction done so far (`[0, 1]`). Returning
+   * `false` cancels the operation (which then returns `nullptr`). */
+  using progress_callback_t = std::function<bool(float iProgress)>;
+
   /**
    * Generate a new sample with a different sample rate
    * @return a new instance (caller takes ownership)
    */
-  std::unique_ptr<SampleBuffers> resample(SampleRate iSampleRate) const;
+  std::unique_ptr<SampleBuffers> resample(SampleRate iSampleRate,
+                                          progress_callback_t const &iProgress = {},
+                                          EResamplingQuality iQuality = EResamplingQuality::kHigh) const;
 
   /**
    * Returns new buffers containing (up to) iNumSamples from this buffer */
   std::unique_ptr<SampleBuffers<SampleType>> first(int32 iNumSamples) const;
 
+  /**
+   * Returns new buffers containing iNumSamples: this buffer followed by silence (or truncated if longer)
+   * @return a new instance (caller takes ownership)
+   */
+  std::unique_ptr<SampleBuffers> pad(int32 iNumSamples) const;
+
+  /**
+   * Treats this buffer as a circular buffer and returns new (right sized) buffers containing the (up to)
+   * iNumSamples starting at iStartOffset (wrapping around at the end).
+   * @return a new instance (caller takes ownership)
+   */
+  std::unique_ptr<SampleBuffers> unroll(int32 iStartOffset, int32 iNumSamples) const;
+
   /**
    * Generate a mono version of this buffer. The result will have only 1 channel with the average of all channels.
    * @return a new instance (caller takes ownership)
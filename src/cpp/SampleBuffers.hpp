@@ -2,6 +2,10 @@
 
 #define NOMINMAX
 
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "SampleBuffers.h"
 #include <sndfile.hh>
@@ -179,11 +183,66 @@ std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::first(int3
   return ptr;
 }
 
+//------------------------------------------------------------------------
+// SampleBuffers::pad
+//------------------------------------------------------------------------
+template<typename SampleType>
+std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::pad(int32 iNumSamples) const
+{
+  if(iNumSamples < 0)
+    return nullptr;
+
+  auto ptr = std::make_unique<SampleBuffers<SampleType>>(fSampleRate, fNumChannels, iNumSamples);
+
+  if(ptr->hasSamples())
+  {
+    auto numSamples = fSamples ? std::min(iNumSamples, fNumSamples) : 0;
+
+    for(int32 c = 0; c < fNumChannels; c++)
+    {
+      std::copy(fSamples[c], fSamples[c] + numSamples, ptr->fSamples[c]);
+      std::fill(ptr->fSamples[c] + numSamples, ptr->fSamples[c] + iNumSamples, 0);
+    }
+  }
+
+  return ptr;
+}
+
+//------------------------------------------------------------------------
+// SampleBuffers::unroll
+//------------------------------------------------------------------------
+template<typename SampleType>
+std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::unroll(int32 iStartOffset,
+                                                                            int32 iNumSamples) const
+{
+  iNumSamples = std::clamp(iNumSamples, Utils::ZERO_INT32, fNumSamples);
+  iStartOffset = fNumSamples > 0 ? std::clamp(iStartOffset, Utils::ZERO_INT32, fNumSamples - 1) : 0;
+
+  auto ptr = std::make_unique<SampleBuffers<SampleType>>(fSampleRate, fNumChannels, iNumSamples);
+
+  // the take is made of (up to) 2 contiguous parts: from the start offset to the end, then from the beginning
+  auto firstPartNumSamples = std::min(iNumSamples, fNumSamples - iStartOffset);
+
+  if(fSamples && iNumSamples > 0)
+  {
+    for(int32 c = 0; c < fNumChannels; c++)
+    {
+      auto channel = fSamples[c];
+      auto out = std::copy(channel + iStartOffset, channel + iStartOffset + firstPartNumSamples, ptr->fSamples[c]);
+      std::copy(channel, channel + iNumSamples - firstPartNumSamples, out);
+    }
+  }
+
+  return ptr;
+}
+
 //------------------------------------------------------------------------
 // SampleBuffers::resample
 //------------------------------------------------------------------------
 template<typename SampleType>
-std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::resample(SampleRate iSampleRate) const
+std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::resample(SampleRate iSampleRate,
+                                                                              progress_callback_t const &iProgress,
+                                                                              EResamplingQuality iQuality) const
 {
   if(fSampleRate == iSampleRate)
   {
@@ -197,30 +256,50 @@ std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::resample(S
     return nullptr;
   }
 
-  constexpr int BUFFER_SIZE = 1024;
+  static constexpr int BUFFER_SIZE = 1024;
 
-  // holds the samples for the library (must be doubles)
-  double tmpBuffer[BUFFER_SIZE];
+  // how often (in number of buffers) the progress is reported
+  static constexpr int PROGRESS_NUM_BUFFERS = 64;
 
   auto newNumSamples = static_cast<int32>(fNumSamples * iSampleRate / fSampleRate);
 
   auto ptr = std::make_unique<SampleBuffers<SampleType>>(iSampleRate, fNumChannels, newNumSamples);
 
-  r8b::CDSPResampler24 resampler(fSampleRate, iSampleRate, BUFFER_SIZE);
+  std::atomic<bool> cancelled{false};
 
-  for(int32 c = 0; c < fNumChannels; c++)
-  {
-    // according to the doc: "It is more efficient to clear the state of the resampler object than to destroy it
-    // and create a new object"
-    resampler.clear();
+  // Implementation note: each channel is resampled with its own resampler (the resampler has a state) which makes
+  // them independent => they are resampled concurrently and the result is the same as resampling them one after the
+  // other. The progress is only reported (and cancellation checked) from this thread (first channel).
+  auto resampleChannel = [this, &ptr, iSampleRate, newNumSamples, &iProgress, iQuality, &cancelled](int32 c) {
+    std::unique_ptr<r8b::CDSPResampler> resampler{};
+    if(iQuality == EResamplingQuality::kFast)
+      resampler = std::make_unique<r8b::CDSPResampler16>(fSampleRate, iSampleRate, BUFFER_SIZE);
+    else
+      resampler = std::make_unique<r8b::CDSPResampler24>(fSampleRate, iSampleRate, BUFFER_SIZE);
+
+    // holds the samples for the library (must be doubles)
+    double tmpBuffer[BUFFER_SIZE];
 
     auto thisBuffer = getChannelBuffer(c);
     auto newBuffer = ptr->getChannelBuffer(c);
     int32 inSampleIndex = 0;
     int32 outSampleIndex = 0;
+    int numBuffers = 0;
 
     while(outSampleIndex < newNumSamples)
     {
+      if(cancelled.load())
+        return;
+
+      if(c == 0 && iProgress && ++numBuffers % PROGRESS_NUM_BUFFERS == 0)
+      {
+        if(!iProgress(static_cast<float>(static_cast<double>(outSampleIndex) / newNumSamples)))
+        {
+          cancelled.store(true);
+          return;
+        }
+      }
+
       for(int i = 0; i < BUFFER_SIZE; i++)
       {
         if(inSampleIndex < fNumSamples)
@@ -239,7 +318,7 @@ std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::resample(S
       }
 
       double *out;
-      auto count = resampler.process(tmpBuffer, BUFFER_SIZE, out);
+      auto count = resampler->process(tmpBuffer, BUFFER_SIZE, out);
 
       for(int i = 0; i < count; i++)
       {
@@ -249,7 +328,63 @@ std::unique_ptr<SampleBuffers<SampleType>> SampleBuffers<SampleType>::resample(S
           break;
       }
     }
-  }
+  };
+
+  // an exception cannot propagate out of a worker (the process would terminate) => the first one is kept (and the
+  // other channels cancelled) and rethrown from this thread once all the workers are done
+  std::exception_ptr workerException{};
+  std::mutex workerExceptionMutex{};
+
+  auto resampleChannelInWorker = [&resampleChannel, &cancelled, &workerException, &workerExceptionMutex](int32 c) {
+    try
+    {
+      resampleChannel(c);
+    }
+    catch(...)
+    {
+      std::lock_guard<std::mutex> lock{workerExceptionMutex};
+      if(!workerException)
+        workerException = std::current_exception();
+      cancelled.store(true);
+    }
+  };
+
+  std::vector<std::thread> workers{};
+
+  // destroying a joinable thread terminates the process => if resampling the first channel (or starting a worker)
+  // throws, the workers still running are cancelled and joined before the exception propagates
+  struct WorkersGuard
+  {
+    std::vector<std::thread> &fWorkers;
+    std::atomic<bool> &fCancelled;
+
+    ~WorkersGuard()
+    {
+      for(auto &worker: fWorkers)
+      {
+        if(worker.joinable())
+        {
+          fCancelled.store(true);
+          worker.join();
+        }
+      }
+    }
+  } workersGuard{workers, cancelled};
+
+  for(int32 c = 1; c < fNumChannels; c++)
+    workers.emplace_back(resampleChannelInWorker, c);
+
+  if(fNumChannels > 0)
+    resampleChannel(0);
+
+  for(auto &worker: workers)
+    worker.join();
+
+  if(workerException)
+    std::rethrow_exception(workerException);
+
+  if(cancelled.load())
+    return nullptr;
 
   return ptr;
 }
@@ -14,11 +14,17 @@ namespace pongasoft::VST::SampleSplitter {
  * @tparam numChannels the number of input channels supported (coming from the sample itself, currently only support
  *                     mono or stereo)
  * @tparam numXFadeSamples number of samples used in the cross fading algorithm
+ * @tparam StorageSampleType the type of the samples of the sample itself (independent of the type of the output
+ *                           buffers, `Sample32` or `Sample64`, chosen by the host)
  */
-template<int32 numChannels = MAX_NUM_INPUT_CHANNELS, int32 numXFadeSamples = NUM_XFADE_SAMPLES>
+template<int32 numChannels = MAX_NUM_INPUT_CHANNELS,
+         int32 numXFadeSamples = NUM_XFADE_SAMPLES,
+         typename StorageSampleType = Sample32>
 class SampleSlice
 {
 public:
+  using StorageBuffers = SampleBuffers<StorageSampleType>;
+
   // Keep track of the state of the slice
   enum class EState
   {
@@ -68,18 +74,34 @@ public:
    */
   inline bool isPlaying() const { return fState != EState::kNotPlaying; }
 
+  /**
+   * @return `true` if the slice is either playing or has a pending transition (meaning that the next call to `play`
+   *         may start or stop it)
+   */
+  inline bool isActive() const { return isPlaying() || fTransition != ETransition::kNone; }
+
+  /**
+   * @return `true` if the next call to `play` is going to (re)start the slice from the beginning */
+  inline bool isStarting() const
+  {
+    return fTransition == ETransition::kStarting || fTransition == ETransition::kRestarting;
+  }
+
+  /**
+   * @return the level of what the slice is about to play (used to determine which voice to steal) */
+  inline StorageSampleType getLevel() const { return isPlaying() ? fSlicer.currentLevel() : 0; }
+
   /**
    * @return how much of a slice was played
    */
   float getPercentPlayed() const
   {
-    if(isPlaying() && fNumActiveSlicers > 0)
+    if(isPlaying())
     {
-      auto &slicer = fSlicers[0];
-      auto numSamples = slicer.numSamples();
+      auto numSamples = fSlicer.numSamples();
       if(numSamples > 0)
       {
-        return static_cast<float>(slicer.numSamplesPlayed()) / numSamples;
+        return static_cast<float>(fSlicer.numSamplesPlayed()) / numSamples;
       }
     }
 
@@ -91,55 +113,49 @@ public:
   inline bool loop() const { return fLoop; }
 
   //! Sets the direction in which the slice is playing
-  void reverse(bool iReverse)
-  {
-    for(auto &slicer : fSlicers)
-      slicer.reverse(iReverse);
-  }
+  inline void reverse(bool iReverse) { fSlicer.reverse(iReverse); }
 
   /**
    * Specifies whether cross fading should happen or not (in order to avoid pops and clicks when starting/stopping or
    * looping.
    */
-  inline void crossFade(bool iEnabled)
-  {
-    for(auto &slicer : fSlicers)
-      slicer.crossFade(iEnabled);
-  }
+  inline void crossFade(bool iEnabled) { fSlicer.crossFade(iEnabled); }
+
+  /**
+   * Specifies the shape of the curve used when cross fading (see `EXFadeCurve`) */
+  inline void crossFadeCurve(EXFadeCurve iCurve) { fSlicer.crossFadeCurve(iCurve); }
 
   /**
    * Resets the slice to the new sample buffers and/or start/end */
-  void reset(SampleBuffers32 const *iSample, int32 iStart, int32 iEnd)
+  void reset(StorageBuffers const *iSample, int32 iStart, int32 iEnd)
   {
     DCHECK_F(iSample->getNumChannels() > 0);
     DCHECK_F(iStart >= 0 && iStart < iSample->getNumSamples());
     DCHECK_F(iEnd >= iStart && iEnd <= iSample->getNumSamples());
 
-    fNumActiveSlicers = std::min(iSample->getNumChannels(), numChannels);
-
-    for(int32 c = 0; c < fNumActiveSlicers; c++)
-    {
-      fSlicers[c].reset(iSample->getChannelBuffer(c), iStart, iEnd);
-    }
+    fSlicer.reset(iSample->getBuffer(), std::min(iSample->getNumChannels(), numChannels), iStart, iEnd);
   }
 
   /**
-   * "Plays" the slice. Plays each channels from the input sample into each channel of the output buffers (up to
-   * the number of samples coming from the output buffers)
+   * "Plays" the slice. Plays each channels from the input sample into each channel of the output buffers, in the
+   * `[iStartOffset, iEndOffset)` section of the output buffers only.
+   *
+   * \note This call does **not** update the silence flag of the output buffers (since it may be called multiple
+   *       times on different sections of the same buffers)
    *
    * @return `true` if anything was played at all or `false` if `out` was left untouched */
   template<typename SampleType>
-  bool play(EPlayMode iPlayMode, AudioBuffers<SampleType> &oAudioBuffers, bool iOverride)
+  bool play(EPlayMode iPlayMode, AudioBuffers<SampleType> &oAudioBuffers, int32 iStartOffset, int32 iEndOffset, bool iOverride)
   {
     if(!prepareSliceForPlaying(iPlayMode))
       return false;
 
-    int32 n = std::min(fNumActiveSlicers, oAudioBuffers.getNumChannels());
+    int32 n = std::min(fSlicer.getNumChannels(), oAudioBuffers.getNumChannels());
 
-    bool donePlaying = false;
+    // output buffers (one per channel of the sample, nullptr when there is no (active) output channel)
+    SampleType *buffers[numChannels]{};
 
     bool played = false;
-    auto loopAtEnd = iPlayMode == EPlayMode::kHold && loop();
 
     for(int32 c = 0; c < n; c++)
     {
@@ -147,23 +163,27 @@ public:
 
       if(channel.isActive())
       {
-        donePlaying |= playChannel<SampleType>(fSlicers[c], channel, iOverride, loopAtEnd);
+        buffers[c] = channel.getBuffer() + iStartOffset; // we know it is not null here
         played = true;
       }
     }
 
-    if(donePlaying)
+    if(!played)
+      return false;
+
+    auto loopAtEnd = iPlayMode == EPlayMode::kHold && loop();
+
+    if(playBuffers(buffers, iEndOffset - iStartOffset, iOverride, loopAtEnd))
       fState = EState::kNotPlaying;
 
-    return played;
+    return true;
   }
 
   /**
    * Sets the position of the slice to the beginning, doing any cross fading if necessary */
   void start()
   {
-    for(int32 i = 0; i < fNumActiveSlicers; i++)
-      fSlicers[i].start();
+    fSlicer.start();
 
     fState = EState::kPlaying;
     fTransition = ETransition::kNone;
@@ -177,31 +197,42 @@ public:
   {
     if(fState == EState::kPlaying)
     {
-      bool ended = false;
-
-      for(int32 i = 0; i < fNumActiveSlicers; i++)
-        ended = fSlicers[i].requestStop();
-
-      fState = ended ? EState::kNotPlaying : EState::kStopping;
+      fState = fSlicer.requestStop() ? EState::kNotPlaying : EState::kStopping;
     }
 
     fTransition = ETransition::kNone;
   }
 
+  /**
+   * Hands over what is currently playing to `oVoice` (a free voice from the pool) so that it keeps playing on its
+   * own until the end while this slice starts over from scratch on the next call to `play` (without cross fading with
+   * what was playing). */
+  void handOverVoice(SampleSlice &oVoice)
+  {
+    oVoice = *this;
+    oVoice.fPadSelected = false;
+    oVoice.fNoteSelected = false;
+    oVoice.fLoop = false;
+    oVoice.fTransition = ETransition::kNone;
+
+    fSlicer.hardStop();
+    fSlicer.resetCrossFader();
+    fState = EState::kNotPlaying;
+  }
+
   /**
    * Forces stop no matter what. No cross fading will happen. After this call, the slice is guaranteed to not be
    * playing. */
   inline void hardStop()
   {
-    for(auto &slicer: fSlicers)
-      slicer.hardStop();
+    fSlicer.hardStop();
 
     fState = EState::kNotPlaying;
     fTransition = ETransition::kNone;
   }
 
 protected:
-  using SlicerImpl = Slicer<Sample32, numXFadeSamples>;
+  using SlicerImpl = Slicer<StorageSampleType, numXFadeSamples, numChannels>;
 
   /**
    * Issues the right combination of `start`/`requestStop` calls based on transition and play mode
@@ -238,68 +269,50 @@ protected:
   }
 
   /**
-   * Plays an individual channel. Implementation note: this call does **not** changes `fState`.
+   * Plays all the channels at once (`iNumSamples` in each of the `oBuffers`). Implementation note: this call does
+   * **not** changes `fState`.
    *
    * @return `true` if after this call, the slice is done playing
    */
   template<typename SampleType>
-  bool playChannel(SlicerImpl &iSlicer,
-                   typename AudioBuffers<SampleType>::Channel oChannel,
-                   bool iOverride,
-                   bool iLoopAtEnd)
+  bool playBuffers(SampleType * const *oBuffers, int32 iNumSamples, bool iOverride, bool iLoopAtEnd)
   {
     bool donePlaying = false;
-    bool silent = true;
-
-    auto audioBuffer = oChannel.getBuffer(); // we know it is not null here
 
-    int32 silentSamples = 0;
+    int32 i = 0;
 
-    for(int32 i = 0; i < oChannel.getNumSamples(); i++)
+    while(i < iNumSamples)
     {
-      if(donePlaying)
-      {
-        if(iOverride)
-        {
-          audioBuffer[i] = 0;
-          silentSamples++;
-        }
-        else
-          silent = silent && isSilent(audioBuffer[i]);
-        continue;
-      }
-
-      if(!iSlicer.hasNext())
+      if(!fSlicer.hasNext())
       {
         if(fState == EState::kStopping || !iLoopAtEnd)
         {
-          if(iOverride)
-          {
-            audioBuffer[i] = 0;
-            silentSamples++;
-          }
-          else
-            silent = silent && isSilent(audioBuffer[i]);
           donePlaying = true;
-          continue;
+          break;
         }
-        iSlicer.start();
+        fSlicer.start();
       }
 
-      auto sample = static_cast<SampleType>(iSlicer.next());
+      // the slicer renders all the channels at once, so the pointers need to be moved to where we are
+      SampleType *buffers[numChannels]{};
+      for(int32 c = 0; c < numChannels; c++)
+        buffers[c] = oBuffers[c] ? oBuffers[c] + i : nullptr;
 
-      if(iOverride)
-        audioBuffer[i] = static_cast<SampleType>(sample);
-      else
-        audioBuffer[i] += static_cast<SampleType>(sample);
-
-      silent = silent && isSilent(audioBuffer[i]);
+      i += fSlicer.next(buffers, iNumSamples - i, iOverride);
     }
 
-    oChannel.setSilenceFlag(silent);
+    // nothing left to play => the rest of the buffer is either cleared or left untouched
+    if(iOverride)
+    {
+      for(int32 c = 0; c < numChannels; c++)
+      {
+        if(oBuffers[c])
+          std::fill(oBuffers[c] + i, oBuffers[c] + iNumSamples, 0);
+      }
+    }
 
     // need to account that we may have played the last sample and there may be no more in the "next" call
-    donePlaying = donePlaying || (!iSlicer.hasNext() && (fState == EState::kStopping || !iLoopAtEnd));
+    donePlaying = donePlaying || (!fSlicer.hasNext() && (fState == EState::kStopping || !iLoopAtEnd));
 
     return donePlaying;
   }
@@ -342,8 +355,7 @@ private:
   EState fState{EState::kNotPlaying};
   ETransition fTransition{ETransition::kNone};
 
-  int32 fNumActiveSlicers{numChannels};
-  SlicerImpl fSlicers[numChannels];
+  SlicerImpl fSlicer{};
 };
 
 }
@@ -2,6 +2,11 @@
 
 #include "SampleSlice.hpp"
 #include "Model.h"
+#include "SliceMap.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace pongasoft::VST::SampleSplitter {
 
@@ -12,10 +17,21 @@ namespace pongasoft::VST::SampleSplitter {
  * @tparam numChannels the number of input channels supported (coming from the sample itself, currently only support
  *                     mono or stereo)
  * @tparam numXFadeSamples number of samples used in the cross fading algorithm
+ * @tparam numExtraVoices the number of (preallocated) voices used to keep playing a slice which is retriggered while
+ *                        still playing (in `EPlayMode::kTrigger` mode, so that both instances overlap)
+ * @tparam StorageSampleType the type of the samples of the sample to play (the output type is independent and can be
+ *                           either `Sample32` or `Sample64`: the conversion happens while rendering)
  */
-template<int32 numSlices = NUM_SLICES, int32 numChannels = MAX_NUM_INPUT_CHANNELS, int32 numXFadeSamples = NUM_XFADE_SAMPLES>
+template<int32 numSlices = NUM_SLICES,
+         int32 numChannels = MAX_NUM_INPUT_CHANNELS,
+         int32 numXFadeSamples = NUM_XFADE_SAMPLES,
+         int32 numExtraVoices = NUM_EXTRA_VOICES,
+         typename StorageSampleType = Sample32>
 class SampleSlices
 {
+  static_assert(numSlices <= 64, "active slices are tracked in a 64 bits mask");
+  static_assert(numExtraVoices <= 64, "active extra voices are tracked in a 64 bits mask");
+
 public:
   // Constructor (simply sets the WE slice in looping mode)
   SampleSlices() { fWESlice.loop(true); }
@@ -26,7 +42,7 @@ public:
 
   /**
    * Sets the sample buffers. Note that this api moves the buffers. */
-  void setBuffers(SampleBuffers32 const *iBuffers) { fSampleBuffers = iBuffers; splitSample(); }
+  void setBuffers(SampleBuffers<StorageSampleType> const *iBuffers) { fSampleBuffers = iBuffers; splitSample(); }
 
   /**
    * Changes the number of slices that are active: the sample will be split into `iNumActiveSlices` slices */
@@ -36,6 +52,12 @@ public:
    * Changes the number of slices that are active: the sample will be split into `iNumActiveSlices` slices */
   void setNumActiveSlices(int32 iNumActiveSlices) { setNumActiveSlices(NumSlice{iNumActiveSlices}); }
 
+  /**
+   * Changes the layout of the slices (the pointer must remain valid until this method is called again, see
+   * `SharedSliceMapMgr`). The slice map is ignored (the sample is split uniformly) unless it applies to the current
+   * sample and number of active slices (see `SliceMap::appliesTo`) */
+  void setSliceMap(SliceMap const *iSliceMap) { fSliceMap = iSliceMap; splitSample(); }
+
   /**
    * @return number of active channels (1 for mono, 2 for stereo at the moment) */
   inline int32 getNumActiveChannels() const { DCHECK_F(fSampleBuffers != nullptr); return fSampleBuffers->getNumChannels(); }
@@ -55,6 +77,20 @@ public:
    * once triggered (`EPlayMode::kTrigger`) */
   void setPlayMode(EPlayMode iValue) { fPlayMode = iValue; };
 
+  /**
+   * Sets the maximum number of voices that can play at the same time in polyphonic mode (a slice playing and each
+   * instance of a slice retriggered while still playing count as 1 voice each). When a slice starts and the limit is
+   * reached, another voice is stopped, as determined by `setVoiceStealing`. By default (or when `iMaxNumVoices` is
+   * `0`) there is no limit (other than the number of slices and extra voices). */
+  void setMaxNumVoices(int32 iMaxNumVoices)
+  {
+    fMaxNumVoices = iMaxNumVoices <= 0 ? MAX_NUM_VOICES : Utils::clamp<int32>(iMaxNumVoices, 1, MAX_NUM_VOICES);
+  }
+
+  /**
+   * Sets which voice is stopped when a slice starts while the maximum number of voices is reached */
+  void setVoiceStealing(EVoiceStealing iValue) { fVoiceStealing = iValue; }
+
   /**
    * Sets the looping mode for a given slice (start over when reaches the end when play mode is set
    * to `EPlayMode::kHold`) */
@@ -77,20 +113,36 @@ public:
     for(auto &slice: fSampleSlices)
       slice.crossFade(iEnabled);
 
+    for(auto &voice: fExtraVoices)
+      voice.crossFade(iEnabled);
+
     fWESlice.crossFade(iEnabled);
   }
 
+  /**
+   * Changes the shape of the curve used when cross fading is enabled (linear by default) */
+  void setCrossFadeCurve(EXFadeCurve iCurve)
+  {
+    for(auto &slice: fSampleSlices)
+      slice.crossFadeCurve(iCurve);
+
+    for(auto &voice: fExtraVoices)
+      voice.crossFadeCurve(iCurve);
+
+    fWESlice.crossFadeCurve(iCurve);
+  }
+
   /**
    * Select/Deselect the slice (via pressing the pad in the UI)
    *
-   * @param iStartFrame at which frame this event happened (used for monophonic mode) */
-  inline void setPadSelected(int32 iSlice, bool iSelected, uint32 iStartFrame = 0) { setSelected(iSlice, true, iSelected, iStartFrame); }
+   * @param iTimestamp when this event happened (only used to order events for monophonic mode) */
+  inline void setPadSelected(int32 iSlice, bool iSelected, uint64 iTimestamp = 0) { setSelected(iSlice, true, iSelected, iTimestamp); }
 
   /**
    * Select/Deselect the slice (via MIDI event)
    *
-   * @param iStartFrame at which frame this event happened (used for monophonic mode) */
-  inline void setNoteSelected(int32 iSlice, bool iSelected, uint32 iStartFrame = 0) { setSelected(iSlice, false, iSelected, iStartFrame); }
+   * @param iTimestamp when this event happened (only used to order events for monophonic mode) */
+  inline void setNoteSelected(int32 iSlice, bool iSelected, uint64 iTimestamp = 0) { setSelected(iSlice, false, iSelected, iTimestamp); }
 
   /**
    * Changes the section of the sample that will be played on the Edit tab (the user can select a range (highlighted
@@ -133,14 +185,59 @@ public:
   template<typename SampleType>
   bool play(AudioBuffers<SampleType> &out, bool iOverride = true)
   {
-    if(out.getNumSamples() <= 0 || out.getNumChannels() == 0 || empty())
+    if(play(out, 0, out.getNumSamples(), iOverride))
+    {
+      adjustSilenceFlags(out);
+      return true;
+    }
+
+    return false;
+  }
+
+  /**
+   * Play all the slices that needs to be played in the `[iStartOffset, iEndOffset)` section of the `out` buffer
+   * only. This is used to split the RT frame in sections so that slices can be selected/deselected at the exact
+   * sample where the event happened.
+   *
+   * \note Since this method is meant to be called multiple times for the same `out` buffer, it does **not** update
+   *       the silence flags (call `adjustSilenceFlags` when done)
+   *
+   * @param iOverride if `out` should be overridden or added to
+   * @return `true` if anything was played at all or `false` if the section was left untouched */
+  template<typename SampleType>
+  bool play(AudioBuffers<SampleType> &out, int32 iStartOffset, int32 iEndOffset, bool iOverride)
+  {
+    if(iStartOffset >= iEndOffset || out.getNumChannels() == 0 || empty())
       return false;
 
+    DCHECK_F(iStartOffset >= 0 && iEndOffset <= out.getNumSamples());
+
     bool played = false;
 
-    // play each slice
-    for(int32 i = 0; i < fNumActiveSlices.intValue(); i++)
+    auto activeSlicesMask = fActiveSlices & getSlicesMask(fNumActiveSlices.intValue());
+
+    // in polyphonic mode, the slices about to (re)start get their voice before anything plays (so that a stolen voice
+    // stops right away)
+    if(fPolyphonic)
+    {
+      auto activeSlices = activeSlicesMask;
+      while(activeSlices != 0)
+      {
+        auto i = countTrailingZeros(activeSlices);
+        activeSlices &= activeSlices - 1;
+
+        if(getSlice(i).isStarting())
+          allocateVoice(i);
+      }
+    }
+
+    // play each active slice (in increasing slice order, like iterating over all of them would)
+    auto activeSlices = activeSlicesMask;
+    while(activeSlices != 0)
     {
+      auto i = countTrailingZeros(activeSlices);
+      activeSlices &= activeSlices - 1;
+
       auto &slice = getSlice(i);
 
       // handle monophonic case: any slice which is not the last one played must stop (requestStop is a noop
@@ -148,15 +245,42 @@ public:
       if(!fPolyphonic && i != fMostRecentSlicePlayed)
         slice.requestStop();
 
-      if(slice.play(fPlayMode, out, iOverride))
+      if(slice.play(fPlayMode, out, iStartOffset, iEndOffset, iOverride))
       {
         played = true;
         iOverride = false;
       }
+
+      // the slice is done playing (and has no pending transition) => no longer needs to be visited
+      if(!slice.isActive())
+        fActiveSlices &= ~getSliceBit(i);
+    }
+
+    // play the extra voices (slices which have been retriggered while still playing)
+    auto activeExtraVoices = fActiveExtraVoices;
+    while(activeExtraVoices != 0)
+    {
+      auto v = countTrailingZeros(activeExtraVoices);
+      activeExtraVoices &= activeExtraVoices - 1;
+
+      auto &voice = fExtraVoices[v];
+
+      // in monophonic mode, only the most recent slice plays
+      if(!fPolyphonic)
+        voice.requestStop();
+
+      if(voice.play(fPlayMode, out, iStartOffset, iEndOffset, iOverride))
+      {
+        played = true;
+        iOverride = false;
+      }
+
+      if(!voice.isActive())
+        fActiveExtraVoices &= ~getSliceBit(v);
     }
 
     // play the WE slice
-    if(fWESlice.play(EPlayMode::kHold, out, iOverride))
+    if(fWESlice.play(EPlayMode::kHold, out, iStartOffset, iEndOffset, iOverride))
     {
       played = true;
     }
@@ -164,8 +288,26 @@ public:
     return played;
   }
 
+  /**
+   * Sets the silence flag of each channel the slices play into, based on the content of `out` (to be called after
+   * `play` has returned `true` for at least one section) */
+  template<typename SampleType>
+  void adjustSilenceFlags(AudioBuffers<SampleType> &out) const
+  {
+    int32 n = std::min(getNumActiveChannels(), out.getNumChannels());
+
+    for(int32 c = 0; c < n; c++)
+    {
+      auto channel = out.getAudioChannel(c);
+      auto buffer = channel.getBuffer();
+
+      if(buffer)
+        channel.setSilenceFlag(Kernels::isSilent(buffer, channel.getNumSamples()));
+    }
+  }
+
 protected:
-  using SampleSliceImpl = SampleSlice<numChannels, numXFadeSamples>;
+  using SampleSliceImpl = SampleSlice<numChannels, numXFadeSamples, StorageSampleType>;
 
   //------------------------------------------------------------------------
   // splitSample
@@ -176,17 +318,20 @@ protected:
 
     if(!empty())
     {
-      auto numSamplesPerSlice = static_cast<int32>(fSampleBuffers->getNumSamples() / fNumActiveSlices.realValue());
-
       // enforcing that ALL slices are stopped (may generate pops and clicks but only when the sample changes while
       // being "played" which is clearly not a "usual" use case)
       for(auto &slice : fSampleSlices)
         slice.hardStop();
+      fActiveSlices = 0;
+
+      for(auto &voice : fExtraVoices)
+        voice.hardStop();
+      fActiveExtraVoices = 0;
 
-      int32 start = 0;
-      for(int32 i = 0; i < fNumActiveSlices.intValue(); i++, start += numSamplesPerSlice)
-        // the last slice may have less sample due to fractional slice count
-        getSlice(i).reset(fSampleBuffers, start, std::min(start + numSamplesPerSlice, fSampleBuffers->getNumSamples()));
+      // uniform split unless the UI provided a slice map for this sample (no allocation either way)
+      auto sliceMap = SliceMap::resolve(fSliceMap, fSampleBuffers->getNumSamples(), fNumActiveSlices);
+      for(int32 i = 0; i < sliceMap.getNumSlices(); i++)
+        getSlice(i).reset(fSampleBuffers, sliceMap.getStart(i), sliceMap.getEnd(i));
 
       // select the entire sample by default
       fWESlice.reset(fSampleBuffers, 0, fSampleBuffers->getNumSamples());
@@ -196,25 +341,139 @@ protected:
   //------------------------------------------------------------------------
   // setSelected
   //------------------------------------------------------------------------
-  void setSelected(int32 iSlice, bool iPad, bool iSelected, uint32 iStartFrame)
+  void setSelected(int32 iSlice, bool iPad, bool iSelected, uint64 iTimestamp)
   {
-//    DLOG_F(INFO, "SampleSlices::setSelected(%d,%s,%s,%d)", iSlice, iPad ? "pad" : "note", iSelected ? "true" : "false", iStartFrame);
+//    DLOG_F(INFO, "SampleSlices::setSelected(%d,%s,%s,%llu)", iSlice, iPad ? "pad" : "note", iSelected ? "true" : "false", iTimestamp);
 
     // only handle active slices
     if(iSlice >= fNumActiveSlices.intValue())
       return;
 
-    getSlice(iSlice).setSelected(iPad, iSelected);
+    auto &slice = getSlice(iSlice);
+    slice.setSelected(iPad, iSelected);
+
+    if(slice.isActive())
+      fActiveSlices |= getSliceBit(iSlice);
 
     // we record the most recently played slice (for monophonic case)
     if(iSelected)
     {
-      if(fMostRecentFrame < iStartFrame && iSlice < fNumActiveSlices.intValue())
+      if(fMostRecentTimestamp < iTimestamp && iSlice < fNumActiveSlices.intValue())
       {
         fMostRecentSlicePlayed = iSlice;
-        fMostRecentFrame = iStartFrame;
+        fMostRecentTimestamp = iTimestamp;
+      }
+    }
+  }
+
+  /**
+   * Called (in polyphonic mode) right before slice `iSlice` (re)starts playing:
+   * - when retriggered while still playing in `EPlayMode::kTrigger` mode, what is playing is handed over to a free
+   *   extra voice so that it keeps playing until the end (if there is no free voice, the slice simply restarts,
+   *   cross fading with what was playing)
+   * - enforces the maximum number of voices by stealing as many voices as necessary */
+  void allocateVoice(int32 iSlice)
+  {
+    auto &slice = getSlice(iSlice);
+
+    if(slice.isPlaying() && fPlayMode == EPlayMode::kTrigger)
+    {
+      auto freeExtraVoices = ~fActiveExtraVoices & getSlicesMask(numExtraVoices);
+      if(freeExtraVoices != 0)
+      {
+        auto v = countTrailingZeros(freeExtraVoices);
+        slice.handOverVoice(fExtraVoices[v]);
+        fExtraVoicesStartOrder[v] = fSlicesStartOrder[iSlice];
+        fActiveExtraVoices |= getSliceBit(v);
+      }
+    }
+
+    fSlicesStartOrder[iSlice] = ++fStartOrder;
+
+    if(fMaxNumVoices < MAX_NUM_VOICES)
+    {
+      while(maybeStealVoice(iSlice))
+        ; // stealing until under the limit
+    }
+  }
+
+  /**
+   * Stops 1 voice (other than slice `iSlice` which is about to start) if the maximum number of voices is reached.
+   * Slices which are about to (re)start are not eligible (they will be handled when they start).
+   *
+   * @return `true` if a voice was stopped, `false` otherwise (under the limit or nothing to steal) */
+  bool maybeStealVoice(int32 iSlice)
+  {
+    int32 numVoices = 1; // iSlice
+    SampleSliceImpl *stolenVoice = nullptr;
+    uint64 stolenVoiceStartOrder = 0;
+    StorageSampleType stolenVoiceLevel = 0;
+
+    auto visitVoice = [&](SampleSliceImpl &iVoice, uint64 iStartOrder) {
+      if(iVoice.getState() != SampleSliceImpl::EState::kPlaying)
+        return;
+
+      numVoices++;
+
+      if(iVoice.isStarting())
+        return;
+
+      auto level = fVoiceStealing == EVoiceStealing::kQuietest ? iVoice.getLevel() : StorageSampleType{0};
+
+      if(stolenVoice == nullptr ||
+         (fVoiceStealing == EVoiceStealing::kOldest && iStartOrder < stolenVoiceStartOrder) ||
+         (fVoiceStealing == EVoiceStealing::kQuietest && level < stolenVoiceLevel))
+      {
+        stolenVoice = &iVoice;
+        stolenVoiceStartOrder = iStartOrder;
+        stolenVoiceLevel = level;
       }
+    };
+
+    auto activeSlices = fActiveSlices & ~getSliceBit(iSlice);
+    while(activeSlices != 0)
+    {
+      auto i = countTrailingZeros(activeSlices);
+      activeSlices &= activeSlices - 1;
+      visitVoice(fSampleSlices[i], fSlicesStartOrder[i]);
+    }
+
+    auto activeExtraVoices = fActiveExtraVoices;
+    while(activeExtraVoices != 0)
+    {
+      auto v = countTrailingZeros(activeExtraVoices);
+      activeExtraVoices &= activeExtraVoices - 1;
+      visitVoice(fExtraVoices[v], fExtraVoicesStartOrder[v]);
     }
+
+    if(numVoices <= fMaxNumVoices || stolenVoice == nullptr)
+      return false;
+
+    stolenVoice->requestStop();
+    return true;
+  }
+
+  // getSliceBit
+  static inline uint64 getSliceBit(int32 iSlice) { return static_cast<uint64>(1) << iSlice; }
+
+  // getSlicesMask (mask with the first iNumSlices bits set)
+  static inline uint64 getSlicesMask(int32 iNumSlices)
+  {
+    return iNumSlices >= 64 ? ~static_cast<uint64>(0) : getSliceBit(iNumSlices) - 1;
+  }
+
+  /**
+   * @return the index of the lowest bit set in `iMask` (`iMask` must not be `0`) */
+  static inline int32 countTrailingZeros(uint64 iMask)
+  {
+    DCHECK_F(iMask != 0);
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, iMask);
+    return static_cast<int32>(index);
+#else
+    return __builtin_ctzll(iMask);
+#endif
   }
 
   // Adds checks to make sure we don't request an unavailable slice
@@ -222,19 +481,40 @@ protected:
   inline SampleSliceImpl const &getSlice(int32 iSlice) const { DCHECK_F(iSlice < numSlices); return fSampleSlices[iSlice]; }
 
 private:
+  // maximum number of voices that can possibly play at the same time (= no limit)
+  static constexpr int32 MAX_NUM_VOICES = numSlices + numExtraVoices;
+
   bool fPolyphonic{true};
   EPlayMode fPlayMode{EPlayMode::kHold};
 
-  uint32 fMostRecentFrame{};
+  int32 fMaxNumVoices{MAX_NUM_VOICES};
+  EVoiceStealing fVoiceStealing{EVoiceStealing::kOldest};
+
+  uint64 fMostRecentTimestamp{};
   int32 fMostRecentSlicePlayed{};
 
   // the sample to be played
-  SampleBuffers32 const *fSampleBuffers{};
+  SampleBuffers<StorageSampleType> const *fSampleBuffers{};
 
   // the slices
   NumSlice fNumActiveSlices{numSlices};
+  SliceMap const *fSliceMap{};
   SampleSliceImpl fSampleSlices[numSlices]{};
 
+  // bit i is set when slice i is active (playing or with a pending transition) so that `play` only visits the
+  // slices that have something to do instead of all of them on every frame
+  uint64 fActiveSlices{};
+
+  // the order in which slices/extra voices started (to determine the oldest one when stealing voices)
+  uint64 fStartOrder{};
+  uint64 fSlicesStartOrder[numSlices]{};
+
+  // the voices playing the slices which have been retriggered while still playing (bit v of fActiveExtraVoices is set
+  // when extra voice v is playing)
+  SampleSliceImpl fExtraVoices[numExtraVoices]{};
+  uint64 fExtraVoicesStartOrder[numExtraVoices]{};
+  uint64 fActiveExtraVoices{};
+
   // represents the slice on the edit tab which can be "played" by holding the "Play" pad
   SampleSliceImpl fWESlice{};
 };
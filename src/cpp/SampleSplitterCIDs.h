@@ -29,6 +29,8 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
   
   __deprecated_kNumSlices = 2100,
   kNumSlices = 2101,
+  kSlicingMode = 2102,
+  kSlicingSensitivity = 2103,
   kPadBank = 2110,
   kSelectedSlice = 2120,
   kSelectedSliceViaMidi = 2121,
@@ -37,9 +39,13 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
   kPolyphonic = 2140,
   kXFade = 2141,
   kInputRouting = 2142,
+  kVoiceLimit = 2143,
+  kVoiceStealing = 2144,
   kRootKey = 2145,
+  kXFadeCurve = 2146,
   kViewType = 2150,
   kEditingMode = 2155,
+  kResamplingPolicy = 2160,
 
   // sampling related properties
   kSamplingInput = 2200,
@@ -50,6 +56,12 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
   kSamplingLeftVuPPM = 2230,
   kSamplingRightVuPPM = 2231,
   kSamplingTrigger = 2240,
+  kSamplingTriggerThreshold = 2241,
+  kSamplingTriggerHold = 2242,
+  kSamplingRetroCapture = 2250,
+  kSamplingPreRoll = 2251,
+  kSamplingRetroCommit = 2252,
+  kSamplingToDisk = 2253,
 
 
   // editing related properties
@@ -58,6 +70,7 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
   kWEShowZeroCrossing = 2302,
   kWEPlaySelection = 2303,
   kWEZoomToSelection = 2304,
+  kWESnapToZeroCrossing = 2305,
 
   // saving related properties
   kExportSampleMajorFormat = 2400,
@@ -74,10 +87,15 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
   // info about the host (communicated from RT to UI)
   kHostInfo = 3005,
 
+  // whether the host is rendering offline (communicated from RT to UI)
+  kOfflineRendering = 3006,
+
   // The sample file
   kSampleFile = 3100,
   kCurrentSample = 3101,
   kUndoHistory = 3103,
+  kZeroCrossingIndex = 3104,
+  kSampleLoadingState = 3107,
 
   // The sample buffers sent by the GUI to RT (message)
   kGUINewSampleMessage = 3102,
@@ -88,6 +106,8 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
 
   // keep track of settings for each slice
   kSlicesSettings = 3110,
+  kSliceMap = 3111,
+  kGUINewSliceMapMessage = 3112,
   kSlicesQuickEdit = 3120,
 
   // The playing state
@@ -107,6 +127,11 @@ enum ESampleSplitterParamID : Steinberg::Vst::ParamID
 
   // the shared buffers mgr
   kSharedBuffersMgr = 3600,
+  kSharedSliceMapMgr = 3601,
+
+  // the (preallocated) buffers used by the sampler: requested by RT (message), allocated by the GUI (message)
+  kSamplerBuffersRequest = 3610,
+  kGUISamplerBuffersMessage = 3611,
 
   //------------------------------------------------------------------------
   // Custom View Tag (not tied to params)
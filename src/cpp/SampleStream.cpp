@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#include "SampleStream.h"
+
+#include <pongasoft/logging/logging.h>
+
+#include <sndfile.hh>
+#include <chrono>
+#include <cstdio>
+
+namespace pongasoft::VST::SampleSplitter {
+
+// how many frames the writer thread writes to the file at once
+constexpr int32 WRITER_BLOCK_NUM_FRAMES = 4096;
+
+// how long the writer thread sleeps when there is nothing to write
+constexpr auto WRITER_POLL_INTERVAL = std::chrono::milliseconds(10);
+
+//------------------------------------------------------------------------
+// SampleStreamWriter::SampleStreamWriter
+//------------------------------------------------------------------------
+SampleStreamWriter::SampleStreamWriter(SampleRate iSampleRate, int32 iNumChannels, int32 iFIFONumFrames) :
+  fSampleRate{iSampleRate},
+  fFIFO{iNumChannels, iFIFONumFrames},
+  fBlock(static_cast<size_t>(iNumChannels) * WRITER_BLOCK_NUM_FRAMES),
+  fThread{[this] { run(); }}
+{
+  DLOG_F(INFO, "SampleStreamWriter(%f, %d, %d)", iSampleRate, iNumChannels, iFIFONumFrames);
+}
+
+//------------------------------------------------------------------------
+// SampleStreamWriter::~SampleStreamWriter
+//------------------------------------------------------------------------
+SampleStreamWriter::~SampleStreamWriter()
+{
+  DLOG_F(INFO, "~SampleStreamWriter()");
+
+  fQuit.store(true);
+  if(fThread.joinable())
+    fThread.join();
+
+  // a take which was never acquired
+  fFile = nullptr;
+  if(!fTakeFilePath.cpp_str().empty())
+    std::remove(fTakeFilePath.toNativePath().c_str());
+}
+
+//------------------------------------------------------------------------
+// SampleStreamWriter::uiAcquireTake
+//------------------------------------------------------------------------
+std::optional<UTF8Path> SampleStreamWriter::uiAcquireTake(int64 iTakeId, int64 *oNumDroppedFrames)
+{
+  if(oNumDroppedFrames)
+    *oNumDroppedFrames = 0;
+
+  if(iTakeId == 0 || fTakeId.load(std::memory_order_relaxed) != iTakeId)
+    return UTF8Path{};
+
+  auto state = fTakeState.load(std::memory_order_acquire);
+
+  // the writer thread is still writing the take (the FIFO is bounded so it is quick)
+  if(state == kRecording || state == kEnded)
+    return std::nullopt;
+
+  if(state != kComplete)
+    return UTF8Path{};
+
+  auto res = std::move(fTakeFilePath);
+  fTakeFilePath = UTF8Path{};
+
+  if(oNumDroppedFrames)
+    *oNumDroppedFrames = fTakeNumDroppedFrames;
+
+  // RT can begin a new take
+  fTakeState.store(kIdle, std::memory_order_release);
+
+  return res;
+}
+
+//------------------------------------------------------------------------
+// SampleStreamWriter::run
+//------------------------------------------------------------------------
+void SampleStreamWriter::run()
+{
+  while(!fQuit.load())
+  {
+    if(!writeAvailableFrames())
+      std::this_thread::sleep_for(WRITER_POLL_INTERVAL);
+  }
+}
+
+//------------------------------------------------------------------------
+// SampleStreamWriter::writeAvailableFrames
+//------------------------------------------------------------------------
+bool SampleStreamWriter::writeAvailableFrames()
+{
+  auto state = fTakeState.load(std::memory_order_acquire);
+
+  if(state != kRecording && state != kEnded)
+    return false;
+
+  if(!fFile && fTakeFilePath.cpp_str().empty())
+  {
+    fTakeFilePath = createTempFilePath("sam_spl64_sampling.wav");
+
+    // RF64 is automatically downgraded to a regular WAV file unless the take is larger than 4GB (32 bits float so
+    // that the take is saved exactly as recorded)
+    fFile = std::make_unique<SndfileHandle>(fTakeFilePath.toNativePath().c_str(),
+                                            SFM_WRITE,
+                                            SF_FORMAT_RF64 | SF_FORMAT_FLOAT,
+                                            fFIFO.getNumChannels(),
+                                            static_cast<int>(fSampleRate));
+
+    if(fFile->rawHandle())
+      fFile->command(SFC_RF64_AUTO_DOWNGRADE, nullptr, SF_TRUE);
+    else
+      LOG_F(ERROR, "Could not open (W) %s", fTakeFilePath.c_str());
+  }
+
+  bool written = false;
+
+  int32 numFrames;
+  while((numFrames = fFIFO.read(fBlock.data(), WRITER_BLOCK_NUM_FRAMES)) > 0)
+  {
+    // the frames are still read (and dropped) when the file could not be opened
+    if(fFile && fFile->rawHandle())
+      fFile->writef(fBlock.data(), numFrames);
+    written = true;
+  }
+
+  // state was loaded before the FIFO was read, so when ended, all the frames of the take have been written
+  if(state == kEnded)
+    closeFile();
+
+  return written;
+}
+
+//------------------------------------------------------------------------
+// SampleStreamWriter::closeFile
+//------------------------------------------------------------------------
+void SampleStreamWriter::closeFile()
+{
+  auto valid = fFile && fFile->rawHandle();
+
+  // closes the file
+  fFile = nullptr;
+
+  if(!valid)
+  {
+    std::remove(fTakeFilePath.toNativePath().c_str());
+    fTakeFilePath = UTF8Path{};
+  }
+
+  fTakeNumDroppedFrames = fNumDroppedFrames.exchange(0);
+  if(fTakeNumDroppedFrames > 0)
+    LOG_F(WARNING, "Could not keep up with RT: dropped %lld frames", fTakeNumDroppedFrames);
+
+  DLOG_F(INFO, "SampleStreamWriter::closeFile(%s)", fTakeFilePath.c_str());
+
+  fTakeState.store(kComplete, std::memory_order_release);
+}
+
+}
@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_SAMPLESTREAM_H
+#define VST_SAM_SPL_64_SAMPLESTREAM_H
+
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/VST/AudioBuffer.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "FilePath.h"
+
+class SndfileHandle;
+
+namespace pongasoft::VST::SampleSplitter {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+/**
+ * Lock free single producer / single consumer FIFO of (interleaved) frames with a fixed capacity (allocated in the
+ * constructor). The producer (RT) writes audio buffers in it and the consumer reads blocks of frames. When the FIFO
+ * is full, the frames that do not fit are dropped (the producer never waits). */
+class SampleFIFO
+{
+public:
+  // Constructor
+  SampleFIFO(int32 iNumChannels, int32 iNumFrames) :
+    fNumChannels{iNumChannels},
+    fNumFrames{iNumFrames},
+    fSamples(static_cast<size_t>(iNumChannels) * static_cast<size_t>(iNumFrames))
+  {}
+
+  // getNumChannels
+  inline int32 getNumChannels() const { return fNumChannels; }
+
+  /**
+   * Writes the frames `[iStartOffset, iEndOffset)` of `iIn` (missing or inactive channels are written as silence)
+   *
+   * @return the number of frames written (less than requested when the FIFO is full)
+   * @note Must be called from the producer side **only** */
+  template<typename SampleType>
+  int32 write(AudioBuffers<SampleType> &iIn, int32 iStartOffset, int32 iEndOffset)
+  {
+    auto writeFrame = fWriteFrame.load(std::memory_order_relaxed);
+    auto numFreeFrames = fNumFrames - static_cast<int32>(writeFrame - fReadFrame.load(std::memory_order_acquire));
+
+    auto numFrames = std::min(std::max(iEndOffset - iStartOffset, 0), numFreeFrames);
+
+    // the FIFO is circular: writing in (up to) 2 parts
+    auto offset = static_cast<int32>(writeFrame % fNumFrames);
+    auto firstPartNumFrames = std::min(numFrames, fNumFrames - offset);
+
+    for(int32 c = 0; c < fNumChannels; c++)
+    {
+      auto buffer = c < iIn.getNumChannels() ? iIn.getAudioChannel(c).getBuffer() : nullptr;
+      if(buffer)
+        buffer += iStartOffset;
+
+      interleave(buffer, c, offset, firstPartNumFrames);
+      interleave(buffer ? buffer + firstPartNumFrames : nullptr, c, 0, numFrames - firstPartNumFrames);
+    }
+
+    fWriteFrame.store(writeFrame + numFrames, std::memory_order_release);
+
+    return numFrames;
+  }
+
+  /**
+   * Reads (up to) `iMaxNumFrames` frames (interleaved) into `oFrames`
+   *
+   * @return the number of frames read
+   * @note Must be called from the consumer side **only** */
+  int32 read(Sample32 *oFrames, int32 iMaxNumFrames)
+  {
+    auto readFrame = fReadFrame.load(std::memory_order_relaxed);
+    auto numFrames = std::min(static_cast<int32>(fWriteFrame.load(std::memory_order_acquire) - readFrame),
+                              iMaxNumFrames);
+
+    auto offset = static_cast<int32>(readFrame % fNumFrames);
+    auto firstPartNumFrames = std::min(numFrames, fNumFrames - offset);
+
+    auto first = fSamples.data() + offset * fNumChannels;
+    oFrames = std::copy(first, first + firstPartNumFrames * fNumChannels, oFrames);
+    std::copy(fSamples.data(), fSamples.data() + (numFrames - firstPartNumFrames) * fNumChannels, oFrames);
+
+    fReadFrame.store(readFrame + numFrames, std::memory_order_release);
+
+    return numFrames;
+  }
+
+private:
+  template<typename SampleType>
+  inline void interleave(SampleType const *iBuffer, int32 iChannel, int32 iOffset, int32 iNumFrames)
+  {
+    auto ptr = fSamples.data() + iOffset * fNumChannels + iChannel;
+    for(int32 i = 0; i < iNumFrames; i++, ptr += fNumChannels)
+      *ptr = iBuffer ? static_cast<Sample32>(iBuffer[i]) : 0;
+  }
+
+private:
+  int32 fNumChannels;
+  int32 fNumFrames;
+  std::vector<Sample32> fSamples;
+  std::atomic<uint64> fWriteFrame{};
+  std::atomic<uint64> fReadFrame{};
+};
+
+/**
+ * Streams takes to (temporary) WAV files so that recording them does not require buffers sized for the whole take
+ * (RT only needs a fixed size FIFO): RT writes the frames in a `SampleFIFO` and a background thread (owned by this
+ * class) writes them to the file. This object is created (and destroyed) by the UI and shared with RT (see
+ * `SamplerBuffers`). Note that once acquired, the take is loaded like any other sample (decoded in memory).
+ *
+ * A take goes through the following states: RT starts it (`rtBeginTake`), writes frames (`rtWrite`) and ends it
+ * (`rtEndTake`). The writer thread then finishes writing the file and the UI acquires it (`uiAcquireTake`), at
+ * which point a new take can begin. */
+class SampleStreamWriter
+{
+public:
+  // Constructor (starts the writer thread)
+  SampleStreamWriter(SampleRate iSampleRate, int32 iNumChannels, int32 iFIFONumFrames);
+
+  // Destructor (stops the writer thread and deletes any file not acquired)
+  ~SampleStreamWriter();
+
+  // getSampleRate
+  inline SampleRate getSampleRate() const { return fSampleRate; }
+
+  /**
+   * Begins a new take
+   *
+   * @return the id of the take or `0` if the previous take has not been acquired by the UI yet
+   * @note Must be called from the RT side **only** */
+  inline int64 rtBeginTake()
+  {
+    int expected = kIdle;
+    if(!fTakeState.compare_exchange_strong(expected, kRecording, std::memory_order_acq_rel))
+      return 0;
+
+    return fTakeId.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+
+  /**
+   * Writes the frames `[iStartOffset, iEndOffset)` of `iIn` to the current take
+   *
+   * @return the number of frames written (which is less than requested if the writer thread cannot keep up)
+   * @note Must be called from the RT side **only** */
+  template<typename SampleType>
+  int32 rtWrite(AudioBuffers<SampleType> &iIn, int32 iStartOffset, int32 iEndOffset)
+  {
+    auto numFrames = fFIFO.write(iIn, iStartOffset, iEndOffset);
+    if(numFrames < iEndOffset - iStartOffset)
+      fNumDroppedFrames.fetch_add(iEndOffset - iStartOffset - numFrames, std::memory_order_relaxed);
+    return numFrames;
+  }
+
+  /**
+   * Ends the current take (the writer thread finishes writing it)
+   *
+   * @note Must be called from the RT side **only** */
+  inline void rtEndTake()
+  {
+    // all the frames written so far (release) are part of the take
+    int expected = kRecording;
+    fTakeState.compare_exchange_strong(expected, kEnded, std::memory_order_acq_rel);
+  }
+
+  /**
+   * Hands over the take once the writer thread has finished writing it (the caller is now responsible for the
+   * file). This call never blocks: the UI polls until the take is available.
+   *
+   * @param oNumDroppedFrames if provided, set to the number of frames RT had to drop because the writer thread could
+   *                          not keep up (the take is then shorter than recorded)
+   * @return `std::nullopt` while the take is being written, otherwise the path to the (temporary) file or an empty
+   *         path if there is no such take (`iTakeId` is not the last take ended by RT) or it could not be written
+   * @note Must be called from the UI side **only** */
+  std::optional<UTF8Path> uiAcquireTake(int64 iTakeId, int64 *oNumDroppedFrames = nullptr);
+
+private:
+  enum ETakeState : int
+  {
+    kIdle,
+    kRecording,
+    kEnded,
+    kComplete
+  };
+
+  // the writer thread loop
+  void run();
+
+  // writes the frames available in the FIFO (`false` if there was nothing to write)
+  bool writeAvailableFrames();
+
+  // called by the writer thread when the take is complete
+  void closeFile();
+
+private:
+  SampleRate fSampleRate;
+  SampleFIFO fFIFO;
+
+  std::atomic<int> fTakeState{kIdle};
+  std::atomic<int64> fTakeId{};
+  std::atomic<int64> fNumDroppedFrames{};
+  std::atomic<bool> fQuit{};
+
+  // only accessed by the writer thread (until the take is complete)
+  std::vector<Sample32> fBlock;
+  std::unique_ptr<SndfileHandle> fFile{};
+  UTF8Path fTakeFilePath{};
+  int64 fTakeNumDroppedFrames{};
+
+  // declared last so that it starts once everything else is initialized
+  std::thread fThread;
+};
+
+}
+
+#endif //VST_SAM_SPL_64_SAMPLESTREAM_H
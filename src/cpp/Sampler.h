@@ -3,6 +3,7 @@
 #include <memory>
 #include <pongasoft/VST/AudioBuffer.h>
 #include "SampleBuffers.h"
+#include "SampleStream.h"
 
 namespace pongasoft {
 namespace VST {
@@ -23,7 +24,8 @@ enum class ESamplerState
  *
  * Sampler32 sampler(2); // stereo
  *
- * sampler.init(48000, 100000); // this allocates memory
+ * SampleBuffers32 buffers(48000, 2, 100000); // allocated outside the audio thread
+ * sampler.init(&buffers); // the sampler does not own the buffers (optional spare buffers)
  * sampler.start();
  * sampler.sample(in, startOffset); // may not start at the beginning of the buffer
  * for ... {
@@ -32,11 +34,19 @@ enum class ESamplerState
  *
  *   if(!sampler.isSampling()) {
  *     sampler.stop();
- *     sampler.copyTo(otherBuffer);
+ *     auto take = sampler.acquireBuffers(); // take.fBuffers == &buffers (untouched, no copy)
  *     break;
  *   }
  * }
- * sampler.dispose(); // this releases memory
+ * sampler.dispose(); // the buffers can now be freed
+ *
+ * The buffers are used as a circular buffer: when capture is enabled (`setCapture`), the sampler keeps recording
+ * (in `sample`) even when not sampling, so that a take can include some pre-roll (what was recorded right before
+ * `start`) or be committed after the fact (`commit`). In this case the take does not necessarily start at the
+ * beginning of the buffers (see `Take`).
+ *
+ * Alternatively, the sampler can stream the take to disk (`init(SampleStreamWriter *)`) in which case its length
+ * is not limited by the buffers (it never reaches `kDoneSampling`).
  *
  * @tparam SampleType the type of the samples this sampler store
  */
@@ -46,18 +56,71 @@ class Sampler : public Utils::Disposable
 public:
   using SampleBuffersT = SampleBuffers<SampleType>;
 
+  /**
+   * What the sampler hands over after sampling: the take is `fNumSamples` long and starts at `fStartOffset` in
+   * `fBuffers`, wrapping around at the end (see `SampleBuffers::unroll`). The buffers are left untouched (they may be
+   * larger than the take). When streaming, there are no buffers and the take is identified by `fStreamTakeId`. */
+  struct Take
+  {
+    SampleBuffersT *fBuffers{};
+    int32 fStartOffset{};
+    int32 fNumSamples{};
+    int64 fStreamTakeId{};
+  };
+
 public:
   // Constructor
   explicit Sampler(int32 iNumChannels) : fNumChannels{iNumChannels}, fCurrent{0}, fState{ESamplerState::kNotSampling} {};
 
-  // initializes this sampler (allocate enough memory for iMaxSamples)
-  void init(SampleRate iSampleRate, int32 iMaxSamples);
+  // initializes this sampler with the buffers to sample into (which determine the maximum number of samples) and
+  // the (optional) spare buffers to use after `acquireBuffers`. The buffers are not owned by the sampler and must
+  // remain valid until `dispose` (or `init`) is called again
+  void init(SampleBuffersT *iBuffers, SampleBuffersT *iSpareBuffers = nullptr);
+
+  // initializes this sampler to stream the takes to disk (not owned by the sampler either)
+  void init(SampleStreamWriter *iStream);
+
+  /**
+   * Provides new spare buffers while the sampler is using `iBuffers` (typically the buffers of a previous take handed
+   * back once done with them). Unlike `init`, this does not reset anything and can be called while sampling.
+   *
+   * @return `false` if the sampler is not using `iBuffers` (in which case nothing changes) */
+  bool setSpareBuffers(SampleBuffersT const *iBuffers, SampleBuffersT *iSpareBuffers);
+
+  // returns true if there are spare buffers to switch to after `acquireBuffers`
+  inline bool hasSpareBuffers() const { return fSpareBuffers != nullptr; }
+
+  // getNumChannels
+  inline int32 getNumChannels() const { return fNumChannels; }
 
   // isInitialized
-  bool isInitialized() const { return fBuffers != nullptr; }
+  bool isInitialized() const { return fBuffers != nullptr || fStream != nullptr; }
 
-  // start
-  void start(bool iResetCurrent = true);
+  // isStreaming
+  bool isStreaming() const { return fStream != nullptr; }
+
+  /**
+   * Enables (or disables) continuous capture: the sampler keeps recording in its buffers when not sampling (older
+   * samples being overwritten) so that `start` can include up to `iPreRollNumSamples` recorded before it (the
+   * buffers must be large enough for the pre-roll and the take) and `commit` can be used. The buffers must also
+   * hold up to `iMaxLookBackNumSamples` (see `start`). */
+  void setCapture(bool iCapture, int32 iPreRollNumSamples = 0, int32 iMaxLookBackNumSamples = 0);
+
+  // isCapturing
+  inline bool isCapturing() const { return fCapture; }
+
+  /**
+   * Starts sampling. When capturing, `iLookBackNumSamples` (up to the maximum provided in `setCapture`) recorded
+   * before the start are part of the take itself (for example when the start is detected late), the pre-roll
+   * preceding them. */
+  void start(int32 iLookBackNumSamples = 0);
+
+  /**
+   * Retroactively commits a take made of the last samples captured (up to the size of a regular take without
+   * pre-roll) as if it had been sampled. Does nothing unless capturing (and not sampling).
+   *
+   * @return `true` if there was anything to commit (the take is then available via `acquireBuffers`) */
+  bool commit();
 
   // stop
   inline void stop() { fState = ESamplerState::kNotSampling; }
@@ -69,12 +132,12 @@ public:
   // number of samples)
   inline bool isSampling() const { return fState == ESamplerState::kSampling; }
 
-  // free resources
+  // releases the buffers (which can then be freed)
   void dispose() override;
 
   /**
    * Sample the in buffer (which can be a different type) and return the end state. If the sampler is not sampling,
-   * then doesn't do anything.
+   * then only records the samples when capturing (see `setCapture`).
    *
    * @param iStartOffset optional start offset in the in buffer to start sampling from
    * @param iEndOffset optional end offset in the in buffer to stop sampling at
@@ -84,14 +147,34 @@ public:
   ESamplerState sample(AudioBuffers<InputSampleType> &iIn, int32 iStartOffset = -1, int32 iEndOffset = -1);
 
   /**
-   * After sampling, we acquire the buffers and reset for more sampling */
-  std::unique_ptr<SampleBuffersT> acquireBuffers();
+   * After sampling, hands over the buffers provided in `init` with what was sampled (no allocation, no copy) and
+   * switches to the spare buffers (if any) for more sampling. The sampler is not initialized anymore if there
+   * were no spare buffers.
+   *
+   * @return the take (the buffers are not owned by the sampler anymore) with `fBuffers == nullptr` if not
+   *         initialized */
+  Take acquireBuffers();
+
+private:
+  // resets the circular buffer (nothing captured)
+  void resetCapture();
 
 private:
   int32 fNumChannels;
-  int32 fCurrent;
+  int32 fCurrent; // number of samples in the take so far
   ESamplerState fState;
-  std::unique_ptr<SampleBuffersT> fBuffers{};
+  SampleBuffersT *fBuffers{};
+  SampleBuffersT *fSpareBuffers{};
+  SampleStreamWriter *fStream{};
+  int64 fStreamTakeId{};
+
+  bool fCapture{};
+  int32 fPreRollNumSamples{};
+  int32 fMaxLookBackNumSamples{};
+  int32 fWriteOffset{}; // where the next sample is written in the (circular) buffers
+  int32 fNumCaptured{}; // how many samples in the buffers are valid
+  int32 fTakeStartOffset{};
+  int32 fTakeNumSamples{}; // how many samples the take will have when done
 };
 
 // shortcut types
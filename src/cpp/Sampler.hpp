@@ -1,6 +1,9 @@
 #pragma once
 
 #include "Sampler.h"
+#include "AudioKernels.hpp"
+#include <pongasoft/Utils/Constants.h>
+#include <pongasoft/Utils/Misc.h>
 
 namespace pongasoft {
 namespace VST {
@@ -10,25 +13,128 @@ namespace SampleSplitter {
 // Sampler::start
 //------------------------------------------------------------------------
 template<typename SampleType>
-void Sampler<SampleType>::start(bool iResetCurrent)
+void Sampler<SampleType>::start(int32 iLookBackNumSamples)
 {
-  DLOG_F(INFO, "Sampler::start()");
-  DCHECK_F(fBuffers != nullptr);
-  fState = ESamplerState::kSampling;
-  if(iResetCurrent)
+  DLOG_F(INFO, "Sampler::start(%d)", iLookBackNumSamples);
+  DCHECK_F(isInitialized());
+
+  if(fStream)
+  {
+    // the previous take may not have been handed over to the UI yet (note that there is no capture when streaming
+    // so no pre-roll or look back either)
+    fStreamTakeId = fStream->rtBeginTake();
     fCurrent = 0;
+    fState = fStreamTakeId > 0 ? ESamplerState::kSampling : ESamplerState::kNotSampling;
+    return;
+  }
+
+  auto numSamples = fBuffers->getNumSamples();
+
+  // without capture, the take always starts at the beginning of the buffers
+  if(!fCapture)
+    resetCapture();
+
+  // the take includes (up to) the look back and the pre-roll already captured
+  auto lookBack = std::min(Utils::clamp(iLookBackNumSamples, Utils::ZERO_INT32, fMaxLookBackNumSamples), fNumCaptured);
+  auto preRoll = std::min(fPreRollNumSamples, fNumCaptured - lookBack);
+  fTakeStartOffset = (fWriteOffset - preRoll - lookBack + numSamples) % numSamples;
+  fTakeNumSamples = numSamples - fPreRollNumSamples - fMaxLookBackNumSamples + preRoll;
+  fCurrent = preRoll + lookBack;
+
+  fState = fCurrent == fTakeNumSamples ? ESamplerState::kDoneSampling : ESamplerState::kSampling;
+}
+
+//------------------------------------------------------------------------
+// Sampler::commit
+//------------------------------------------------------------------------
+template<typename SampleType>
+bool Sampler<SampleType>::commit()
+{
+  if(!fBuffers || !fCapture || fState != ESamplerState::kNotSampling || fNumCaptured == 0)
+    return false;
+
+  DLOG_F(INFO, "Sampler::commit()");
+
+  auto numSamples = fBuffers->getNumSamples();
+
+  fTakeNumSamples = std::min(numSamples - fPreRollNumSamples - fMaxLookBackNumSamples, fNumCaptured);
+  fTakeStartOffset = (fWriteOffset - fTakeNumSamples + numSamples) % numSamples;
+  fCurrent = fTakeNumSamples;
+  fState = ESamplerState::kDoneSampling;
+
+  return true;
 }
 
 //------------------------------------------------------------------------
 // Sampler::init
 //------------------------------------------------------------------------
 template<typename SampleType>
-void Sampler<SampleType>::init(SampleRate iSampleRate, int32 iMaxSamples)
+void Sampler<SampleType>::init(SampleBuffersT *iBuffers, SampleBuffersT *iSpareBuffers)
+{
+  DCHECK_F(iBuffers != nullptr);
+  DLOG_F(INFO, "Sampler::init(%f, %d)", iBuffers->getSampleRate(), iBuffers->getNumSamples());
+  fBuffers = iBuffers;
+  fSpareBuffers = iSpareBuffers;
+  fStream = nullptr;
+  fCurrent = 0;
+  fState = ESamplerState::kNotSampling;
+  resetCapture();
+}
+
+//------------------------------------------------------------------------
+// Sampler::init (streaming)
+//------------------------------------------------------------------------
+template<typename SampleType>
+void Sampler<SampleType>::init(SampleStreamWriter *iStream)
 {
-  DLOG_F(INFO, "Sampler::init(%f, %d)", iSampleRate, iMaxSamples);
-  fBuffers = std::make_unique<SampleBuffersT>(iSampleRate, fNumChannels, iMaxSamples);
+  DCHECK_F(iStream != nullptr);
+  DLOG_F(INFO, "Sampler::init(stream: %f)", iStream->getSampleRate());
+  fBuffers = nullptr;
+  fSpareBuffers = nullptr;
+  fStream = iStream;
+  fStreamTakeId = 0;
   fCurrent = 0;
   fState = ESamplerState::kNotSampling;
+  resetCapture();
+}
+
+//------------------------------------------------------------------------
+// Sampler::setSpareBuffers
+//------------------------------------------------------------------------
+template<typename SampleType>
+bool Sampler<SampleType>::setSpareBuffers(SampleBuffersT const *iBuffers, SampleBuffersT *iSpareBuffers)
+{
+  if(fBuffers == nullptr || fBuffers != iBuffers || iSpareBuffers == iBuffers)
+    return false;
+
+  fSpareBuffers = iSpareBuffers;
+  return true;
+}
+
+//------------------------------------------------------------------------
+// Sampler::setCapture
+//------------------------------------------------------------------------
+template<typename SampleType>
+void Sampler<SampleType>::setCapture(bool iCapture, int32 iPreRollNumSamples, int32 iMaxLookBackNumSamples)
+{
+  DLOG_F(INFO, "Sampler::setCapture(%s, %d, %d)", iCapture ? "true" : "false", iPreRollNumSamples, iMaxLookBackNumSamples);
+  fCapture = iCapture;
+  fPreRollNumSamples = iCapture ? std::max(iPreRollNumSamples, Utils::ZERO_INT32) : 0;
+  fMaxLookBackNumSamples = iCapture ? std::max(iMaxLookBackNumSamples, Utils::ZERO_INT32) : 0;
+  if(fState == ESamplerState::kNotSampling)
+    resetCapture();
+}
+
+//------------------------------------------------------------------------
+// Sampler::resetCapture
+//------------------------------------------------------------------------
+template<typename SampleType>
+void Sampler<SampleType>::resetCapture()
+{
+  fWriteOffset = 0;
+  fNumCaptured = 0;
+  fTakeStartOffset = 0;
+  fTakeNumSamples = fBuffers ? fBuffers->getNumSamples() - fPreRollNumSamples - fMaxLookBackNumSamples : 0;
 }
 
 //------------------------------------------------------------------------
@@ -37,10 +143,10 @@ void Sampler<SampleType>::init(SampleRate iSampleRate, int32 iMaxSamples)
 template<typename SampleType>
 float Sampler<SampleType>::getPercentSampled() const
 {
-  DCHECK_F(fBuffers != nullptr);
-  if(fState == ESamplerState::kSampling)
+  DCHECK_F(isInitialized());
+  if(fState == ESamplerState::kSampling && fTakeNumSamples > 0 && !fStream)
   {
-    return fCurrent / static_cast<float>(fBuffers->getNumSamples());
+    return fCurrent / static_cast<float>(fTakeNumSamples);
   }
   return 0;
 }
@@ -53,14 +159,35 @@ template<typename SampleType>
 template<typename InputSampleType>
 ESamplerState Sampler<SampleType>::sample(AudioBuffers<InputSampleType> &iIn, int32 iStartOffset, int32 iEndOffset)
 {
-  if(fState != ESamplerState::kSampling)
+  bool sampling = fState == ESamplerState::kSampling;
+
+  if(fStream)
+  {
+    if(sampling)
+    {
+      if(iStartOffset == -1)
+        iStartOffset = 0;
+
+      if(iEndOffset == -1)
+        iEndOffset = iIn.getNumSamples();
+
+      // the length of the take is not limited when streaming
+      fCurrent += fStream->rtWrite(iIn,
+                                   Utils::clamp(iStartOffset, Utils::ZERO_INT32, iIn.getNumSamples()),
+                                   Utils::clamp(iEndOffset, Utils::ZERO_INT32, iIn.getNumSamples()));
+    }
     return fState;
+  }
 
-  DCHECK_F(fBuffers != nullptr);
+  if(!fBuffers || !(sampling || (fCapture && fState == ESamplerState::kNotSampling)))
+    return fState;
 
   auto localBuffersNumSamples = fBuffers->getNumSamples();
   auto inNumSamples = iIn.getNumSamples();
 
+  if(localBuffersNumSamples == 0 || inNumSamples == 0)
+    return fState;
+
   if(iStartOffset == -1)
     iStartOffset = 0;
 
@@ -68,39 +195,51 @@ ESamplerState Sampler<SampleType>::sample(AudioBuffers<InputSampleType> &iIn, in
     iEndOffset = inNumSamples;
 
   // making sure offset remain within the bounds
-  iStartOffset = clamp(iStartOffset, ZERO_INT32, inNumSamples - 1);
-  iEndOffset = clamp(iEndOffset, ZERO_INT32, inNumSamples);
+  iStartOffset = Utils::clamp(iStartOffset, Utils::ZERO_INT32, inNumSamples - 1);
+  iEndOffset = Utils::clamp(iEndOffset, Utils::ZERO_INT32, inNumSamples);
 
-  auto numChannels = std::min(fBuffers->getNumChannels(), iIn.getNumChannels());
+  auto numSamples = std::max(iEndOffset - iStartOffset, Utils::ZERO_INT32);
+
+  if(sampling)
+    numSamples = std::min(numSamples, fTakeNumSamples - fCurrent);
+  else
+  {
+    // when only capturing, what does not fit would be overwritten anyway
+    if(numSamples > localBuffersNumSamples)
+    {
+      iStartOffset += numSamples - localBuffersNumSamples;
+      numSamples = localBuffersNumSamples;
+    }
+  }
+
+  // the buffers are circular: writing in (up to) 2 parts
+  auto firstPartNumSamples = std::min(numSamples, localBuffersNumSamples - fWriteOffset);
 
-  int32 newCurrent = fCurrent;
+  auto numChannels = std::min(fBuffers->getNumChannels(), iIn.getNumChannels());
 
   for(int32 c = 0; c < numChannels; c++)
   {
-    int32 current = fCurrent;
-
     auto channel = iIn.getAudioChannel(c);
     if(!channel.isActive())
       continue;
 
-    auto audioBuffer = channel.getBuffer(); // we know it is not null here
+    auto audioBuffer = channel.getBuffer() + iStartOffset; // we know it is not null here
     auto sampleBuffer = fBuffers->getChannelBuffer(c);
 
-    for(int32 i = iStartOffset; i < iEndOffset; i++)
-    {
-      if(current == localBuffersNumSamples)
-        break;
-
-      sampleBuffer[current++] = static_cast<SampleType>(audioBuffer[i]);
-    }
-
-    newCurrent = current;
+    Kernels::copy(audioBuffer, sampleBuffer + fWriteOffset, firstPartNumSamples);
+    Kernels::copy(audioBuffer + firstPartNumSamples, sampleBuffer, numSamples - firstPartNumSamples);
   }
 
-  fCurrent = newCurrent;
+  fWriteOffset = (fWriteOffset + numSamples) % localBuffersNumSamples;
+  fNumCaptured = std::min(fNumCaptured + numSamples, localBuffersNumSamples);
+
+  if(sampling)
+  {
+    fCurrent += numSamples;
 
-  if(localBuffersNumSamples == fCurrent)
-    fState = ESamplerState::kDoneSampling;
+    if(fTakeNumSamples == fCurrent)
+      fState = ESamplerState::kDoneSampling;
+  }
 
   return fState;
 }
@@ -113,22 +252,48 @@ void Sampler<SampleType>::dispose()
 {
   DLOG_F(INFO, "Sampler::dispose()");
   fBuffers = nullptr;
+  fSpareBuffers = nullptr;
+  fStream = nullptr;
   fCurrent = 0;
   fState = ESamplerState::kNotSampling;
+  resetCapture();
 }
 
 //------------------------------------------------------------------------
 // Sampler::acquireBuffers
 //------------------------------------------------------------------------
 template<typename SampleType>
-std::unique_ptr<typename Sampler<SampleType>::SampleBuffersT> Sampler<SampleType>::acquireBuffers()
+typename Sampler<SampleType>::Take Sampler<SampleType>::acquireBuffers()
 {
   DLOG_F(INFO, "Sampler::acquireBuffers()");
 
+  if(fStream)
+  {
+    if(fStreamTakeId == 0)
+      return {};
+
+    // the writer thread finishes writing the take
+    fStream->rtEndTake();
+    Take res{nullptr, 0, fCurrent, fStreamTakeId};
+    fStreamTakeId = 0;
+    fCurrent = 0;
+    fState = ESamplerState::kNotSampling;
+    return res;
+  }
+
   if(!fBuffers)
-    return nullptr;
+    return {};
+
+  // the buffers are not modified (they may be shared with other threads once handed over)
+  Take res{fBuffers, fTakeStartOffset, fCurrent};
+
+  fBuffers = fSpareBuffers;
+  fSpareBuffers = nullptr;
+  fCurrent = 0;
+  fState = ESamplerState::kNotSampling;
+  resetCapture();
 
-  return fBuffers->first(fCurrent);
+  return res;
 }
 
 }
@@ -21,7 +21,10 @@
 
 #include <pluginterfaces/vst/vsttypes.h>
 
-#include <pongasoft/Utils/Concurrent/SpinLock.h>
+#include <pongasoft/logging/logging.h>
+
+#include <atomic>
+#include <memory>
 
 #include "SampleBuffers.h"
 
@@ -59,9 +62,13 @@ namespace pongasoft::VST::SampleSplitter {
  *          `uiGetObject()->functionWhichMutateObject()` should never be called.
  *          Instead, create a new object and use `SharedObjectMgr::uiSetObject` (resp. `SharedObjectMgr::rtSetObject`).
  *
- * @note 2. This class relies on the fact that `std::shared_ptr` is thread safe **only** in regards to the counter which
- *          is why it uses a `SpinLock` when it gets assigned (as well as deal with version) to guarantee that it is
- *          thread safe.
+ * @note 2. The RT side never blocks: each side owns its own copy of the object and the two sides exchange objects
+ *          through a triple buffer (UI -> RT) and a single producer/single consumer queue (RT -> UI), both
+ *          implemented with atomics only. The RT side also never releases an object: any object it drops is sent
+ *          back to the UI (via the same queue) which releases it the next time it calls any `uiXXX` method
+ *          (or explicitly with `uiReclaim`, which the UI should call periodically). When the queue is full, the
+ *          objects are kept on the RT side until there is room (see `rtFlush`). As a result an object dropped by RT
+ *          (and by UI) stays in memory until the UI reclaims it.
  *
  * @note 3. Since `std::shared_ptr` is thread safe (from the counter point of view only!), it is technically
  *          possible to use it directly in RT, but it is not recommended. It is better to use the underlying pointer
@@ -75,14 +82,13 @@ class SharedObjectMgr
 public:
   using object_type = ObjectType;
   using version_type = VersionType;
-  
+
   /**
    * Shortcut to return the shared object from the UI side.
    *
    * @note Must be called from the UI side **only** */
   inline std::shared_ptr<ObjectType> uiGetObject() const
   {
-    auto lock = fLock.acquire();
     return fUIObject;
   }
 
@@ -92,22 +98,18 @@ public:
    * @note Must be called from the UI side **only** */
   inline VersionType uiSetObject(std::shared_ptr<ObjectType> iObject)
   {
-    std::shared_ptr<ObjectType> objectToDelete{};
-    VersionType res{};
+    uiReclaim();
 
-    // CRITICAL SECTION START
-    {
-      auto lock = fLock.acquire();
-      objectToDelete = std::move(fUIObject);
-      fUIObject = std::move(iObject);
-      fUIVersion = ++fVersion;
-      res = fUIVersion;
+    fUIObject = std::move(iObject);
+    fUIVersion = ++fVersion;
 //    DLOG_F(INFO, "std::shared_ptrMgr::uiSetObject -> %lld", fUIVersion);
-    }
-    // CRITICAL SECTION EMD
 
-    // ensures that if object needs to be deleted, it is deleted OUTSIDE the lock
-    return res;
+    // the object last set by RT (if any) is now outdated
+    fRTEntry = {};
+
+    uiPublish({fUIObject, fUIVersion}, true);
+
+    return fUIVersion;
   }
 
   /**
@@ -122,32 +124,67 @@ public:
    * @note Must be called from the UI side **only** */
   std::shared_ptr<ObjectType> uiAdjustObjectFromRT(VersionType iRTVersion, bool *oUpdated = nullptr)
   {
-    std::shared_ptr<ObjectType> objectToDelete{};
-    std::shared_ptr<ObjectType> res{};
+    uiReclaim();
 
-    // CRITICAL SECTION START
-    {
-      auto lock = fLock.acquire();
 //    DLOG_F(INFO, "std::shared_ptrMgr::uiAdjustObjectFromRT(%lld)", iRTVersion);
-      if(iRTVersion > fUIVersion && iRTVersion <= fVersion)
-      {
-        objectToDelete = std::move(fUIObject);
-        fUIObject = fRTObject;
-        fUIVersion = fRTVersion;
-        if(oUpdated)
-          *oUpdated = true;
-        res = fUIObject;
-      }
+    if(iRTVersion > fUIVersion && iRTVersion <= fVersion && iRTVersion <= fRTEntry.fVersion)
+    {
+      fUIObject = std::move(fRTEntry.fObject);
+      fUIVersion = fRTEntry.fVersion;
+
+      // the object set by UI (if RT did not use it yet) is now outdated
+      uiPublish({}, false);
+
+      if(oUpdated)
+        *oUpdated = true;
+      return fUIObject;
+    }
+
+    if(oUpdated)
+      *oUpdated = false;
+    return nullptr;
+  }
+
+  /**
+   * Releases (on the UI side) all the objects that RT dropped since the last call. Every `uiXXX` method (except
+   * `uiGetObject`) calls it, so it only needs to be called explicitly to release memory sooner.
+   *
+   * @note Must be called from the UI side **only** */
+  void uiReclaim()
+  {
+    Entry entry{};
+    while(uiPop(entry))
+    {
+      // an entry with a version is an object set by RT (only the most recent one is kept), otherwise it is an
+      // object dropped by RT which gets released here
+      if(entry.fVersion > fUIVersion && entry.fVersion > fRTEntry.fVersion)
+        fRTEntry = std::move(entry);
       else
-      {
-        if(oUpdated)
-          *oUpdated = false;
-      }
+        entry = {};
+    }
+  }
+
+  /**
+   * Sends the entries kept on the RT side (because the queue to the UI was full) to the UI, if there is room now.
+   * Every `rtXXX` method calls it, so it only needs to be called explicitly (for example on every frame) so that the
+   * UI can release them sooner. It does nothing (and is cheap) when there is nothing kept on the RT side.
+   *
+   * @note Must be called from the RT side **only** */
+  inline void rtFlush()
+  {
+    int32 i = 0;
+    for(; i < fRTNumPending; i++)
+    {
+      if(!rtTryPush(fRTPending[i]))
+        break;
     }
-    // CRITICAL SECTION EMD
 
-    // ensures that if object needs to be deleted, it is deleted OUTSIDE the lock
-    return res;
+    if(i > 0)
+    {
+      // the entries pushed have been moved out (so nothing is released here)
+      std::move(fRTPending + i, fRTPending + fRTNumPending, fRTPending);
+      fRTNumPending -= i;
+    }
   }
 
   /**
@@ -156,7 +193,6 @@ public:
    * @note Must be called from the RT side **only** */
   inline std::shared_ptr<ObjectType> rtGetObject() const
   {
-    auto lock = fLock.acquire();
     return fRTObject;
   }
 
@@ -166,13 +202,29 @@ public:
    * @note Must be called from the RT side **only** */
   inline VersionType rtSetObject(std::shared_ptr<ObjectType> iObject)
   {
-    auto lock = fLock.acquire();
+    // the UI releases the previous object
+    rtPush({std::move(fRTObject), 0});
+
     fRTObject = std::move(iObject);
     fRTVersion = ++fVersion;
 //    DLOG_F(INFO, "std::shared_ptrMgr::rtSetObject -> %lld", fRTVersion);
+
+    rtPush({fRTObject, fRTVersion});
+
     return fRTVersion;
   }
 
+  /**
+   * Hands an object RT kept a reference to (for example to keep using the previous object after `rtSetObject`) back
+   * to the UI to be released (RT never releases an object). Does nothing if `iObject` is `nullptr`.
+   *
+   * @note Must be called from the RT side **only** */
+  inline void rtRelease(std::shared_ptr<ObjectType> iObject)
+  {
+    if(iObject)
+      rtPush({std::move(iObject), 0});
+  }
+
   /**
    * Called after UI changes the object and communicates the version to RT. Note that this method returns `nullptr`
    * in the event that the version is outdated (or simply invalid).
@@ -185,15 +237,24 @@ public:
    * @note Must be called from the RT side **only** */
   inline std::shared_ptr<ObjectType> rtAdjustObjectFromUI(VersionType iUIVersion, bool *oUpdated = nullptr)
   {
-    auto lock = fLock.acquire();
 //    DLOG_F(INFO, "std::shared_ptrMgr::rtAdjustObjectFromUI(%lld)", iUIVersion);
     if(iUIVersion > fRTVersion && iUIVersion <= fVersion)
     {
-      fRTObject = fUIObject;
-      fRTVersion = fUIVersion;
-      if(oUpdated)
-        *oUpdated = true;
-      return fRTObject;
+      auto entry = rtReceive();
+      if(entry && entry->fVersion >= iUIVersion)
+      {
+        // swapping (and not assigning) so that the previous object is sent back to the UI to be released
+        std::swap(fRTObject, entry->fObject);
+        fRTVersion = entry->fVersion;
+        rtPush({std::move(entry->fObject), 0});
+        if(oUpdated)
+          *oUpdated = true;
+        return fRTObject;
+      }
+
+      // outdated entry => the UI releases it
+      if(entry)
+        rtPush({std::move(entry->fObject), 0});
     }
     if(oUpdated)
       *oUpdated = false;
@@ -201,15 +262,115 @@ public:
   }
 
 private:
-  mutable SpinLock fLock{};
+  struct Entry
+  {
+    std::shared_ptr<ObjectType> fObject{};
+    version_type fVersion{};
+  };
+
+  /**
+   * UI -> RT (triple buffer): UI writes the entry in its own slot then exchanges it with the shared one (which is then
+   * owned by UI and released) */
+  void uiPublish(Entry iEntry, bool iNewEntry)
+  {
+    fUIToRTSlots[fUIToRTWriteIndex] = std::move(iEntry);
+    auto sharedIndex = fUIToRTSharedIndex.exchange(fUIToRTWriteIndex | (iNewEntry ? NEW_ENTRY_FLAG : 0),
+                                                   std::memory_order_acq_rel);
+    fUIToRTWriteIndex = sharedIndex & SLOT_INDEX_MASK;
+    fUIToRTSlots[fUIToRTWriteIndex] = {};
+  }
+
+  /**
+   * UI -> RT (triple buffer): RT exchanges its own slot with the shared one if UI published a new entry
+   *
+   * @return the new entry or `nullptr` if there is none */
+  Entry *rtReceive()
+  {
+    if(!(fUIToRTSharedIndex.load(std::memory_order_acquire) & NEW_ENTRY_FLAG))
+      return nullptr;
+    fUIToRTReadIndex = fUIToRTSharedIndex.exchange(fUIToRTReadIndex, std::memory_order_acq_rel) & SLOT_INDEX_MASK;
+    return &fUIToRTSlots[fUIToRTReadIndex];
+  }
+
+  /**
+   * RT -> UI: when the queue is full (the UI has not reclaimed in a while), the entry is kept on the RT side
+   * (`fRTPending`) until there is room, so that it is still released by the UI. Entries are always sent in order. */
+  void rtPush(Entry iEntry)
+  {
+    rtFlush();
+
+    if(fRTNumPending == 0 && rtTryPush(iEntry))
+      return;
+
+    // The UI drains the queue every time it calls a `uiXXX` method and periodically, and RT only drops objects it
+    // received from the UI (at most 1 per UI update) or set itself (1 per `rtSetObject` or `rtRelease`), so running
+    // out of room on both sides means the UI has stopped reclaiming altogether (the entry is then released here as a
+    // last resort)
+    DCHECK_F(fRTNumPending < RT_PENDING_SIZE, "SharedObjectMgr - the UI is not reclaiming the objects dropped by RT");
+
+    if(fRTNumPending < RT_PENDING_SIZE)
+      fRTPending[fRTNumPending++] = std::move(iEntry);
+  }
+
+  /**
+   * RT -> UI (single producer/single consumer queue): the slots are always empty when RT writes to them (UI moves
+   * the entries out) so RT never releases anything.
+   *
+   * @return `false` if the queue is full (in which case `ioEntry` is left untouched) */
+  bool rtTryPush(Entry &ioEntry)
+  {
+    auto tail = fRTToUITail.load(std::memory_order_relaxed);
+    auto next = (tail + 1) % RT_TO_UI_QUEUE_SIZE;
+    if(next == fRTToUIHead.load(std::memory_order_acquire))
+      return false;
+    fRTToUIQueue[tail] = std::move(ioEntry);
+    fRTToUITail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * RT -> UI (single producer/single consumer queue)
+   *
+   * @return `false` if the queue is empty */
+  bool uiPop(Entry &oEntry)
+  {
+    auto head = fRTToUIHead.load(std::memory_order_relaxed);
+    if(head == fRTToUITail.load(std::memory_order_acquire))
+      return false;
+    oEntry = std::move(fRTToUIQueue[head]);
+    fRTToUIHead.store((head + 1) % RT_TO_UI_QUEUE_SIZE, std::memory_order_release);
+    return true;
+  }
+
+private:
+  static constexpr int NEW_ENTRY_FLAG = 0x4;
+  static constexpr int SLOT_INDEX_MASK = 0x3;
+  static constexpr int RT_TO_UI_QUEUE_SIZE = 64;
+  static constexpr int RT_PENDING_SIZE = 64;
 
-  version_type fVersion{};
+  std::atomic<version_type> fVersion{};
 
+  // UI side
   std::shared_ptr<ObjectType> fUIObject{};
   version_type fUIVersion{};
+  Entry fRTEntry{}; // most recent object set by RT (not yet used by UI)
 
+  // RT side
   std::shared_ptr<ObjectType> fRTObject{};
   version_type fRTVersion{};
+  Entry fRTPending[RT_PENDING_SIZE]{}; // entries waiting for room in the RT -> UI queue (oldest first)
+  int32 fRTNumPending{};
+
+  // UI -> RT
+  Entry fUIToRTSlots[3]{};
+  int fUIToRTWriteIndex{0}; // UI side
+  std::atomic<int> fUIToRTSharedIndex{1};
+  int fUIToRTReadIndex{2}; // RT side
+
+  // RT -> UI
+  Entry fRTToUIQueue[RT_TO_UI_QUEUE_SIZE]{};
+  std::atomic<int> fRTToUIHead{}; // UI side
+  std::atomic<int> fRTToUITail{}; // RT side
 };
 
 
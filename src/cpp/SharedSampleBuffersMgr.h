@@ -21,6 +21,8 @@
 
 #include "SharedObjectMgr.h"
 #include "SampleBuffers.h"
+#include "SampleStream.h"
+#include "Model.h"
 
 namespace pongasoft::VST::SampleSplitter {
 
@@ -31,6 +33,111 @@ using SharedSampleBuffersMgr32 = SharedSampleBuffersMgr<Vst::Sample32>;
 
 using SharedSampleBuffersVersion = SharedSampleBuffersMgr32::version_type;
 
+/**
+ * Message sent by RT to the UI after sampling. The sampler records in its buffers as a circular buffer so the take
+ * starts at `fStartOffset` (and may wrap around): RT does not copy (nor modify) anything. Unless the take fills the
+ * buffers entirely (in which case they are used as is, by RT and the UI), the UI makes a right sized copy of the take
+ * (see `SampleBuffers::unroll`), sends it to RT and hands the buffers back to the sampler (see
+ * `SamplerBuffers::fRecycled`). When the take was streamed to disk, `fStreamTakeId` identifies it (see
+ * `SampleStreamWriter::uiAcquireTake`) and there is no buffer. */
+struct RTNewSample
+{
+  SharedSampleBuffersVersion fVersion{};
+  int32 fStartOffset{};
+  int32 fNumSamples{};
+  int64 fStreamTakeId{};
+};
+
+//------------------------------------------------------------------------
+// RTNewSampleParamSerializer
+//------------------------------------------------------------------------
+class RTNewSampleParamSerializer : public IParamSerializer<RTNewSample>
+{
+public:
+  // readFromStream
+  tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue) const override
+  {
+    tresult res = IBStreamHelper::readInt64(iStreamer, oValue.fVersion);
+    res |= IBStreamHelper::readInt32(iStreamer, oValue.fStartOffset);
+    res |= IBStreamHelper::readInt32(iStreamer, oValue.fNumSamples);
+    res |= IBStreamHelper::readInt64(iStreamer, oValue.fStreamTakeId);
+    return res;
+  }
+
+  // writeToStream
+  tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const override
+  {
+    if(!oStreamer.writeInt64(iValue.fVersion) ||
+       !oStreamer.writeInt32(iValue.fStartOffset) ||
+       !oStreamer.writeInt32(iValue.fNumSamples) ||
+       !oStreamer.writeInt64(iValue.fStreamTakeId))
+      return kResultFalse;
+    return kResultOk;
+  }
+};
+
+/**
+ * The buffers used by the sampler (allocated by the UI): the sampler records in `fBuffers` and hands them over as is
+ * (no copy) when done, switching to `fSpareBuffers` so that it can record again right away. When streaming to disk,
+ * there are no buffers and the sampler uses `fStream` instead (for as many takes as needed).
+ *
+ * When `fRecycled` is `true`, `fSpareBuffers` are the buffers of a previous take that the UI is done with (it copied
+ * the take) and `fBuffers` the ones the sampler switched to: RT only uses them as new spare buffers (see
+ * `Sampler::setSpareBuffers`) so that takes do not require new allocations. */
+struct SamplerBuffers
+{
+  SharedSampleBuffers<Vst::Sample32> fBuffers{};
+  SharedSampleBuffers<Vst::Sample32> fSpareBuffers{};
+  std::shared_ptr<SampleStreamWriter> fStream{};
+  bool fRecycled{};
+};
+
+using SharedSamplerBuffersMgr = SharedObjectMgr<SamplerBuffers, int64>;
+
+/**
+ * Message sent by RT to the UI to request the buffers used by the sampler (which can be large) so that they are
+ * allocated (and later freed) outside the audio thread. The UI allocates them and shares them with RT via `fMgr`.
+ * `fNumSamples == 0` means that RT does not need the buffers anymore and that they can be freed. When `fStream` is
+ * `true`, RT requests a `SampleStreamWriter` instead (`fNumSamples` being the size of its FIFO). */
+struct SamplerBuffersRequest
+{
+  SharedSamplerBuffersMgr *fMgr{};
+  SampleRate fSampleRate{};
+  int32 fNumChannels{};
+  int32 fNumSamples{};
+  bool fStream{};
+};
+
+//------------------------------------------------------------------------
+// SamplerBuffersRequestParamSerializer
+//------------------------------------------------------------------------
+class SamplerBuffersRequestParamSerializer : public IParamSerializer<SamplerBuffersRequest>
+{
+public:
+  // readFromStream
+  tresult readFromStream(IBStreamer &iStreamer, ParamType &oValue) const override
+  {
+    tresult res = PointerSerializer<SharedSamplerBuffersMgr>().readFromStream(iStreamer, oValue.fMgr);
+    res |= IBStreamHelper::readDouble(iStreamer, oValue.fSampleRate);
+    res |= IBStreamHelper::readInt32(iStreamer, oValue.fNumChannels);
+    res |= IBStreamHelper::readInt32(iStreamer, oValue.fNumSamples);
+    res |= IBStreamHelper::readBool(iStreamer, oValue.fStream);
+    return res;
+  }
+
+  // writeToStream
+  tresult writeToStream(const ParamType &iValue, IBStreamer &oStreamer) const override
+  {
+    tresult res = PointerSerializer<SharedSamplerBuffersMgr>().writeToStream(iValue.fMgr, oStreamer);
+    if(!oStreamer.writeDouble(iValue.fSampleRate) ||
+       !oStreamer.writeInt32(iValue.fNumChannels) ||
+       !oStreamer.writeInt32(iValue.fNumSamples) ||
+       !oStreamer.writeBool(iValue.fStream))
+      res = kResultFalse;
+    return res;
+  }
+};
+
 }
 
 #endif //VST_SAM_SPL_64_SHAREDSAMPLEBUFFERSMGR_H
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2020 pongasoft
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not
+ * use this file except in compliance with the License. You may obtain a copy of
+ * the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations under
+ * the License.
+ *
+ * @author Yan Pujante
+ */
+
+#ifndef VST_SAM_SPL_64_SLICEMAP_H
+#define VST_SAM_SPL_64_SLICEMAP_H
+
+#include <algorithm>
+#include <array>
+#include <vector>
+
+#include "Model.h"
+#include "SharedObjectMgr.h"
+
+namespace pongasoft::VST::SampleSplitter {
+
+/**
+ * Where each slice of a sample starts and ends (the slices are contiguous and sorted). This is the one place that
+ * defines the layout of the slices: RT plays them (see `SampleSlices`) and the views draw and hit test them. A slice
+ * map is immutable once created and never allocates (so RT can compute a uniform one if it needs to).
+ *
+ * The UI computes the slice map (uniform, on transients, snapped to zero crossings...) and shares it with RT through
+ * a `SharedSliceMapMgr`. A slice map only applies to the sample it was computed for and only when the number of
+ * slices matches (`appliesTo`), which is not the case while RT or the UI is catching up with a change, in which case
+ * the sample is split uniformly (`resolve`).
+ */
+class SliceMap
+{
+public:
+  // Constructor (no slice)
+  SliceMap() = default;
+
+  /**
+   * Creates a slice map from the (sorted) start of each slice (truncated to `NUM_SLICES` slices). The first slice
+   * always starts at `0` and the last one ends at `iNumSamples`. */
+  SliceMap(int32 iNumSamples, std::vector<int32> const &iStarts) :
+    fNumSamples{iNumSamples},
+    fNumSlices{static_cast<int32>(std::min<size_t>(iStarts.size(), NUM_SLICES))},
+    fEnd{iNumSamples}
+  {
+    std::copy(iStarts.begin(), iStarts.begin() + fNumSlices, fStarts.begin());
+    if(fNumSlices > 0)
+      fStarts[0] = 0;
+  }
+
+  /**
+   * The sample split into `iNumSlices` slices of the same size (when `iNumSlices` is not an integer, the last slice
+   * is shorter, otherwise the samples left due to rounding are not part of any slice). */
+  static SliceMap uniform(int32 iNumSamples, NumSlice const &iNumSlices)
+  {
+    SliceMap res{};
+
+    res.fNumSamples = iNumSamples;
+    res.fNumSlices = std::clamp<int32>(iNumSlices.intValue(), 0, NUM_SLICES);
+
+    auto numSamplesPerSlice = static_cast<int32>(iNumSamples / iNumSlices.realValue());
+
+    int32 start = 0;
+    for(int32 i = 0; i < res.fNumSlices; i++, start += numSamplesPerSlice)
+      res.fStarts[i] = start;
+
+    res.fEnd = res.fNumSlices > 0 ? std::min(res.fStarts[res.fNumSlices - 1] + numSamplesPerSlice, iNumSamples) : 0;
+
+    return res;
+  }
+
+  /**
+   * @return `iSliceMap` if it applies to the sample and number of slices, the uniform split otherwise */
+  static SliceMap resolve(SliceMap const *iSliceMap, int32 iNumSamples, NumSlice const &iNumSlices)
+  {
+    if(iSliceMap && iSliceMap->appliesTo(iNumSamples, iNumSlices))
+      return *iSliceMap;
+    return uniform(iNumSamples, iNumSlices);
+  }
+
+  // appliesTo
+  inline bool appliesTo(int32 iNumSamples, NumSlice const &iNumSlices) const
+  {
+    return fNumSlices > 0 && fNumSamples == iNumSamples && iNumSlices.intValue() == fNumSlices;
+  }
+
+  // getNumSamples
+  inline int32 getNumSamples() const { return fNumSamples; }
+
+  // getNumSlices
+  inline int32 getNumSlices() const { return fNumSlices; }
+
+  // getStart (iSlice must be < getNumSlices())
+  inline int32 getStart(int32 iSlice) const { return fStarts[iSlice]; }
+
+  // getEnd (iSlice must be < getNumSlices())
+  inline int32 getEnd(int32 iSlice) const { return iSlice + 1 < fNumSlices ? fStarts[iSlice + 1] : fEnd; }
+
+  /**
+   * @return the slice containing `iSample` (binary search), clamped to the first (resp. last) slice when `iSample` is
+   *         before (resp. after) the slices, or `-1` when there is no slice */
+  int32 findSlice(int32 iSample) const
+  {
+    if(fNumSlices == 0)
+      return -1;
+
+    auto begin = fStarts.begin();
+    auto iter = std::upper_bound(begin, begin + fNumSlices, iSample);
+    return std::max(static_cast<int32>(iter - begin) - 1, 0);
+  }
+
+  bool operator==(SliceMap const &rhs) const
+  {
+    return fNumSamples == rhs.fNumSamples &&
+           fNumSlices == rhs.fNumSlices &&
+           fEnd == rhs.fEnd &&
+           std::equal(fStarts.begin(), fStarts.begin() + fNumSlices, rhs.fStarts.begin());
+  }
+
+  bool operator!=(SliceMap const &rhs) const
+  {
+    return !(rhs == *this);
+  }
+
+private:
+  int32 fNumSamples{};
+  int32 fNumSlices{};
+  int32 fEnd{}; // end of the last slice
+  std::array<int32, NUM_SLICES> fStarts{};
+};
+
+using SharedSliceMap = std::shared_ptr<SliceMap const>;
+using SharedSliceMapMgr = SharedObjectMgr<SliceMap const, int64>;
+using SharedSliceMapVersion = SharedSliceMapMgr::version_type;
+
+}
+
+#endif //VST_SAM_SPL_64_SLICEMAP_H
@@ -1,28 +1,126 @@
 #include <pongasoft/Utils/Misc.h>
 #include <pluginterfaces/base/ftypes.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "AudioKernels.hpp"
 
 namespace pongasoft::VST::SampleSplitter {
 
 using namespace Steinberg;
 
 /**
- * Implements a cross fader from 0 to 1 (res. 1 to 0).
+ * Shape of the gain curve used when cross fading:
+ * - `kLinear`: gain goes linearly from 0 to 1 (constant amplitude when cross fading correlated signals)
+ * - `kEqualPower`: sine/cosine gains (constant power when cross fading uncorrelated signals)
+ * - `kSCurve`: smooth step gain (smoother start and end than linear)
+ */
+enum class EXFadeCurve
+{
+  kLinear,
+  kEqualPower,
+  kSCurve
+};
+
+/**
+ * Gain tables used by the cross fader, computed at compile time for a given curve and number of samples:
+ * - `fIn[i]` is the gain going from 0 (`i == 0`) to 1 (`i == numSamples - 1`)
+ * - `fOut[i]` is the gain going from 1 to 0 (`fIn` reversed)
+ * - `fComplement[i]` is the gain to apply to the signal being faded out while fading in with `fIn[i]`
+ *
+ * \note For `EXFadeCurve::kLinear`, the values are computed exactly the same way the (original) ramp was computed
+ *       on the fly (`factor * i` and `1 - factor * i`) so that the output is bit for bit identical.
+ */
+template<typename SampleType, int32 numSamples>
+struct XFadeGainTable
+{
+  static_assert(numSamples > 1, "cross fading requires at least 2 samples");
+
+  constexpr explicit XFadeGainTable(EXFadeCurve iCurve) : fIn{}, fOut{}, fComplement{}
+  {
+    constexpr auto factor = (static_cast<SampleType>(1) / (numSamples - 1));
+
+    for(int32 i = 0; i < numSamples; i++)
+    {
+      switch(iCurve)
+      {
+        case EXFadeCurve::kLinear:
+          fIn[i] = factor * i;
+          break;
+
+        case EXFadeCurve::kEqualPower:
+          fIn[i] = static_cast<SampleType>(sinHalfPi(static_cast<double>(i) / (numSamples - 1)));
+          break;
+
+        case EXFadeCurve::kSCurve:
+        {
+          auto t = factor * i;
+          fIn[i] = t * t * (3 - 2 * t);
+          break;
+        }
+      }
+    }
+
+    // make sure the end points are exact (no matter the rounding of the curve)
+    fIn[0] = 0;
+    fIn[numSamples - 1] = 1;
+
+    for(int32 i = 0; i < numSamples; i++)
+    {
+      fOut[i] = fIn[numSamples - 1 - i];
+      // for equal power, cos(x) == sin(pi/2 - x), otherwise the curve is symmetric
+      fComplement[i] = iCurve == EXFadeCurve::kEqualPower ? fOut[i] : 1 - fIn[i];
+    }
+  }
+
+  SampleType fIn[numSamples];
+  SampleType fOut[numSamples];
+  SampleType fComplement[numSamples];
+
+private:
+  // sin(x * pi / 2) for x in [0, 1] (Taylor series which converges quickly on this range and is constexpr)
+  static constexpr double sinHalfPi(double x)
+  {
+    x *= 1.57079632679489661923;
+    double term = x;
+    double res = x;
+    for(int n = 1; n < 12; n++)
+    {
+      term *= -x * x / ((2 * n) * (2 * n + 1));
+      res += term;
+    }
+    return res;
+  }
+};
+
+/**
+ * Implements a cross fader from 0 to 1 (res. 1 to 0) following a gain curve (`EXFadeCurve`, linear by default). The
+ * gains come from precomputed tables (`XFadeGainTable`) and the cross fading section is computed in straight loops
+ * over local arrays (no branching, no index computation) so that the compiler can vectorize them.
+ *
+ * All the channels (up to `numChannels`) are cross faded at the same time (they share the same position).
  *
  * Supposed to be used this way (java style iteration):
  *
  * ```
- * fader.xFadeFrom0ToBuffer(&buffer[0], false);
- * if(fader.hasNext())
- *  fader.next();
+ * fader.xFadeFrom0ToBuffer(buffers, numChannels, false);
  * if(fader.hasNext())
- *  fader.next();
+ * {
+ *   fader.sample(0); fader.sample(1); ...
+ *   fader.advance();
+ * }
  * ...
  * ```
  */
-template<typename SampleType, int32 numSamples>
-class LinearCrossFader
+template<typename SampleType, int32 numSamples, int32 numChannels = 1>
+class CrossFader
 {
 public:
+  using GainTable = XFadeGainTable<SampleType, numSamples>;
+
+  template<typename Iterator>
+  using Iterators = std::array<Iterator, numChannels>;
+
   //! Resets the cross fader to its original state
   inline void reset()
   {
@@ -34,6 +132,9 @@ public:
     // std::fill(std::begin(fBuffer), std::end(fBuffer), 0);
   }
 
+  //! Changes the shape of the curve used for the next cross fades
+  inline void curve(EXFadeCurve iCurve) { fGains = &GAIN_TABLES[static_cast<int>(iCurve)]; }
+
   /**
    * Cross fade from 0 to the current buffer. Note that if there was already some cross fading happening then it will
    * cross fade from whatever was there before. As an example, stopping playing the slice puts it in "fading to 0" mode
@@ -41,73 +142,73 @@ public:
    * method.
    *
    * @tparam Iterator designed to be a "pointer" (need to support ++/--/*)
+   * @param iBuffers one iterator per channel (only the first `iNumChannels` are used)
    */
   template<typename Iterator>
-  void xFadeFrom0ToBuffer(Iterator iBuffer, bool iReverse)
+  void xFadeFrom0ToBuffer(Iterators<Iterator> const &iBuffers, int32 iNumChannels, bool iReverse)
   {
-    constexpr auto factor = (static_cast<SampleType>(1) / (numSamples - 1));
+    DCHECK_F(fCurrent >= numSamples || fFadeTo0, "xFadeFrom0ToBuffer called while already cross fading from 0");
+
+    auto const &gains = *fGains;
 
-    if(fCurrent < numSamples)
+    for(int32 c = 0; c < iNumChannels; c++)
     {
-      DCHECK_F(fFadeTo0, "xFadeFrom0ToBuffer called while already cross fading from 0");
+      SampleType input[numSamples];
+      readInput(iBuffers[c], iReverse, input);
 
-      int current = fCurrent;
+      auto buffer = fBuffer[c];
 
-      for(int32 i = 0; i < numSamples; i++)
+      if(fCurrent < numSamples)
       {
-        auto sample = current < numSamples ? fBuffer[current] : fBuffer[numSamples - 1];
-        auto f = factor * i;
-        fBuffer[i] = f * (iReverse ? *iBuffer-- : *iBuffer++) + (1 - f) * sample;
-        current++;
+        SampleType previous[numSamples];
+        readPrevious(c, previous);
+
+        for(int32 i = 0; i < numSamples; i++)
+          buffer[i] = gains.fIn[i] * input[i] + gains.fComplement[i] * previous[i];
       }
-    }
-    else
-    {
-      for(int32 i = 0; i < numSamples; i++)
+      else
       {
-        auto sample = iReverse ? *iBuffer-- : *iBuffer++;
-        fBuffer[i] = factor * i * sample;
+        for(int32 i = 0; i < numSamples; i++)
+          buffer[i] = gains.fIn[i] * input[i];
       }
     }
 
-
     fFadeTo0 = false;
     fCurrent = 0;
-
   }
 
   /**
    * Cross fade from the buffer to 0. Also handles the case when there is already cross fading happening.
    *
    * @tparam Iterator designed to be a "pointer" (need to support ++/--/*)
+   * @param iBuffers one iterator per channel (only the first `iNumChannels` are used)
    */
   template<typename Iterator>
-  void xFadeTo0FromBuffer(Iterator iBuffer, bool iReverse)
+  void xFadeTo0FromBuffer(Iterators<Iterator> const &iBuffers, int32 iNumChannels, bool iReverse)
   {
-    constexpr auto factor = (static_cast<SampleType>(1) / (numSamples - 1));
+    DCHECK_F(fCurrent >= numSamples || !fFadeTo0, "xFadeTo0FromBuffer called while already cross fading to 0");
+
+    auto const &gains = *fGains;
 
-    if(fCurrent < numSamples)
+    for(int32 c = 0; c < iNumChannels; c++)
     {
-      DCHECK_F(!fFadeTo0, "xFadeTo0FromBuffer called while already cross fading to 0");
+      SampleType input[numSamples];
+      readInput(iBuffers[c], iReverse, input);
 
-      int current = fCurrent;
+      auto buffer = fBuffer[c];
 
-      for(int32 i = 0; i < numSamples; i++)
+      if(fCurrent < numSamples)
       {
-        auto sample = iReverse ? *iBuffer-- : *iBuffer++;
-        auto sample1 = current < numSamples ? fBuffer[current] : fBuffer[numSamples - 1];
-        auto sample2 = factor * static_cast<float>(numSamples - 1 - i) * sample;
-        auto f = factor * i;
-        fBuffer[i] = f * sample2 + (1 - f) * sample1;
-        current++;
+        SampleType previous[numSamples];
+        readPrevious(c, previous);
+
+        for(int32 i = 0; i < numSamples; i++)
+          buffer[i] = gains.fIn[i] * (gains.fOut[i] * input[i]) + gains.fComplement[i] * previous[i];
       }
-    }
-    else
-    {
-      for(int32 i = 0; i < numSamples; i++)
+      else
       {
-        auto sample = iReverse ? *iBuffer-- : *iBuffer++;
-        fBuffer[i] = factor * static_cast<float>(numSamples - 1 - i) * sample;
+        for(int32 i = 0; i < numSamples; i++)
+          buffer[i] = gains.fOut[i] * input[i];
       }
     }
 
@@ -115,32 +216,72 @@ public:
     fCurrent = 0;
   }
 
-  inline bool hasNext()
+  inline bool hasNext() const
   {
     return fCurrent < numSamples;
   }
 
-  inline SampleType next()
+  //! @return the current (cross faded) sample for the given channel (must call `advance` to move to the next one)
+  inline SampleType sample(int32 iChannel) const
+  {
+    DCHECK_F(fCurrent >= 0 && fCurrent < numSamples);
+    return fBuffer[iChannel][fCurrent];
+  }
+
+  //! Moves to the next sample (for all channels)
+  inline void advance()
   {
-    DCHECK_F(fCurrent >= 0);
     DCHECK_F(hasNext());
-    auto res = fBuffer[fCurrent];
     fCurrent++;
-    return res;
   }
 
   /**
    * @return `true` if the cross fader is currently fading to 0 */
-  inline bool isFadingTo0() { return fFadeTo0 && hasNext(); }
+  inline bool isFadingTo0() const { return fFadeTo0 && hasNext(); }
 
   /**
    * @return `true` if the fader has faded to 0 and is done */
-  inline bool isDoneFadingTo0() { return fFadeTo0 && !hasNext(); }
+  inline bool isDoneFadingTo0() const { return fFadeTo0 && !hasNext(); }
 
 private:
+  /**
+   * Copies the `numSamples` samples to cross fade in `oInput` (reading backward when `iReverse`) */
+  template<typename Iterator>
+  static inline void readInput(Iterator iBuffer, bool iReverse, SampleType *oInput)
+  {
+    if(iReverse)
+    {
+      for(int32 i = 0; i < numSamples; i++)
+        oInput[i] = *iBuffer--;
+    }
+    else
+    {
+      for(int32 i = 0; i < numSamples; i++)
+        oInput[i] = *iBuffer++;
+    }
+  }
+
+  /**
+   * Copies what is left to play in the current cross fade in `oPrevious`, repeating the last sample to fill it up */
+  inline void readPrevious(int32 iChannel, SampleType *oPrevious) const
+  {
+    auto buffer = fBuffer[iChannel];
+    auto numLeft = numSamples - fCurrent;
+    std::copy(buffer + fCurrent, buffer + numSamples, oPrevious);
+    std::fill(oPrevious + numLeft, oPrevious + numSamples, buffer[numSamples - 1]);
+  }
+
+private:
+  static constexpr GainTable GAIN_TABLES[] = {
+    GainTable{EXFadeCurve::kLinear},
+    GainTable{EXFadeCurve::kEqualPower},
+    GainTable{EXFadeCurve::kSCurve}
+  };
+
   bool fFadeTo0{false};
   int32 fCurrent{numSamples};
-  SampleType fBuffer[numSamples]{};
+  SampleType fBuffer[numChannels][numSamples]{};
+  GainTable const *fGains{&GAIN_TABLES[static_cast<int>(EXFadeCurve::kLinear)]};
 };
 
 /**
@@ -148,6 +289,9 @@ private:
  * Handles 1 shot (plays from `fStart` to `fEnd`) and reverse. Looping is handled at a higher level
  * (call `restart` when `next` returns `false`).
  *
+ * Handles all the channels of the sample (up to `numChannels`) with a single play head: the position, direction and
+ * cross fading state are shared and each call renders all the channels at once.
+ *
  * Handles cross fading when enabled.
  *
  * Supposed to be used this way (java style iteration):
@@ -165,26 +309,36 @@ private:
  * ```
  *
  * Note that this class does NOT handle buffer management and assumes that `fStart`, `fEnd - 1` are within the boundary
- * of `buffer`. */
-template<typename SampleType, int32 numXFadeSamples>
+ * of `buffer`.
+ *
+ * @tparam numChannels the maximum number of channels handled by this slicer (the actual number of channels is
+ *                     provided in `reset` and the rendering loops are specialized for each channel count) */
+template<typename SampleType, int32 numXFadeSamples, int32 numChannels = 1>
 class Slicer
 {
 private:
   static constexpr int32 NOT_PLAYING = -2;
 
+  // number of samples used to compute the level of what is playing (see `currentLevel`)
+  static constexpr int32 NUM_LEVEL_SAMPLES = 256;
+
 public:
   /**
-   * Called to reset `fStart` and `fEnd`. Note that `fStart` is part of the range and `fEnd` is *not*. */
-  void reset(SampleType const *iBuffer, int32 iStart, int32 iEnd)
+   * Called to reset `fStart` and `fEnd`. Note that `fStart` is part of the range and `fEnd` is *not*.
+   *
+   * @param iBuffers one buffer per channel (`iNumChannels` of them) */
+  void reset(SampleType const * const *iBuffers, int32 iNumChannels, int32 iStart, int32 iEnd)
   {
     // sanity check
+    DCHECK_F(iNumChannels > 0 && iNumChannels <= numChannels);
     DCHECK_F(iStart >= 0);
     DCHECK_F(iEnd >= 0);
     DCHECK_F(iStart < iEnd);
 
     fStart = iStart;
     fEnd = iEnd;
-    fBuffer = iBuffer;
+    fNumChannels = iNumChannels;
+    std::copy(iBuffers, iBuffers + iNumChannels, fBuffers);
 
     maybeDisableCrossFader();
 
@@ -192,9 +346,16 @@ public:
       fCurrent = Utils::clamp(fCurrent, fStart, fEnd -1);
   }
 
+  /**
+   * Single channel version of `reset` */
+  inline void reset(SampleType const *iBuffer, int32 iStart, int32 iEnd) { reset(&iBuffer, 1, iStart, iEnd); }
+
   inline int32 startIdx() const { return fStart; }
   inline int32 endIdx() const { return fEnd; }
 
+  // Returns the number of channels handled by this slicer (as provided in `reset`)
+  inline int32 getNumChannels() const { return fNumChannels; }
+
   /**
    * Specifies whether cross fading should happen or not (in order to avoid pops and clicks when starting/stopping or
    * looping.
@@ -209,6 +370,9 @@ public:
       fXFader.reset();
   }
 
+  //! Specifies the shape of the cross fading curve
+  inline void crossFadeCurve(EXFadeCurve iCurve) { fXFader.curve(iCurve); }
+
   //! Specifies the iteration direction
   inline void reverse(bool iReverse) { fReverse = iReverse; }
 
@@ -234,7 +398,7 @@ public:
 
     if(fXFaderEnabled)
     {
-      fXFader.xFadeFrom0ToBuffer(getBuffer(fCurrent), fReverse);
+      fXFader.xFadeFrom0ToBuffer(getBuffers(fCurrent), fNumChannels, fReverse);
     }
   }
 
@@ -250,7 +414,7 @@ public:
       if(fXFaderEnabled)
       {
         if(!fXFader.isFadingTo0())
-          fXFader.xFadeTo0FromBuffer(getBuffer(fCurrent), fReverse);
+          fXFader.xFadeTo0FromBuffer(getBuffers(fCurrent), fNumChannels, fReverse);
       }
       else
         fCurrent = NOT_PLAYING;
@@ -263,31 +427,219 @@ public:
    * Forces end no matter what */
   inline void hardStop() { fCurrent = NOT_PLAYING; }
 
+  /**
+   * Forgets any cross fading in progress (so that the next `start` fades in from 0 instead of from what was
+   * playing before) */
+  inline void resetCrossFader() { fXFader.reset(); }
+
+  /**
+   * @return the level of what is about to play (RMS of the next `NUM_LEVEL_SAMPLES` samples from the play head, in
+   *         the direction of play, max across channels) or `0` if not playing. A single sample would not do since it
+   *         is close to 0 at every zero crossing. */
+  SampleType currentLevel() const
+  {
+    if(fCurrent == NOT_PLAYING)
+      return 0;
+
+    auto from = fReverse ? std::max(fStart, fCurrent - NUM_LEVEL_SAMPLES + 1) : fCurrent;
+    auto to = fReverse ? fCurrent + 1 : std::min(fEnd, fCurrent + NUM_LEVEL_SAMPLES);
+
+    double sumOfSquares = 0;
+    for(int32 c = 0; c < fNumChannels; c++)
+    {
+      double sum = 0;
+      for(int32 i = from; i < to; i++)
+      {
+        auto sample = static_cast<double>(fBuffers[c][i]);
+        sum += sample * sample;
+      }
+      sumOfSquares = std::max(sumOfSquares, sum);
+    }
+    return static_cast<SampleType>(std::sqrt(sumOfSquares / (to - from)));
+  }
+
   /**
    * @return `true` if there is a next step (which means it is ok to call `next`)
    */
   inline bool hasNext() { return fCurrent != NOT_PLAYING; }
 
   /**
-   * Retrieves the current sample (applies cross fading if necessary)
+   * Retrieves the current sample (applies cross fading if necessary). Single channel api (the slicer must have been
+   * reset with only 1 channel).
    */
   inline SampleType next()
   {
     DCHECK_F(hasNext());
+    DCHECK_F(fNumChannels == 1);
 
     // sanity check
     DCHECK_F(fCurrent >= 0);
     DCHECK_F(fCurrent >= fStart);
     DCHECK_F(fCurrent < fEnd);
 
-    auto res = fXFaderEnabled && fXFader.hasNext() ? fXFader.next() : fBuffer[fCurrent];
+    SampleType res;
+
+    if(fXFaderEnabled && fXFader.hasNext())
+    {
+      res = fXFader.sample(0);
+      fXFader.advance();
+    }
+    else
+      res = fBuffers[0][fCurrent];
 
     computeNext();
 
     return res;
   }
 
+  /**
+   * Block version of `next()`: renders up to `iNumSamples` samples of each channel into `oBuffers` (either overriding
+   * what is there or adding to it) and stops early when there is no more to play (`hasNext` returns `false`). The
+   * result is identical to calling `next()` once per sample, but the section of the slice which is not cross fading
+   * is rendered as a straight copy (no per sample branching). Only the cross fading section (at most
+   * `numXFadeSamples`) goes through the sample by sample path.
+   *
+   * @param oBuffers one output buffer per channel (`getNumChannels()` of them). A `nullptr` buffer is skipped (the
+   *                 play head still moves forward)
+   * @return the number of samples rendered (`0` if not playing) */
+  template<typename OutputSampleType>
+  inline int32 next(OutputSampleType **oBuffers, int32 iNumSamples, bool iOverride)
+  {
+    return nextForChannels<numChannels>(oBuffers, iNumSamples, iOverride);
+  }
+
+  /**
+   * Single channel version of the block api */
+  template<typename OutputSampleType>
+  inline int32 next(OutputSampleType *oBuffer, int32 iNumSamples, bool iOverride)
+  {
+    DCHECK_F(fNumChannels == 1);
+    return next(&oBuffer, iNumSamples, iOverride);
+  }
+
 private:
+  /**
+   * Dispatches (once per call) to the loop specialized for the actual number of channels */
+  template<int32 N, typename OutputSampleType>
+  inline int32 nextForChannels(OutputSampleType * const *oBuffers, int32 iNumSamples, bool iOverride)
+  {
+    if constexpr(N > 1)
+    {
+      if(fNumChannels < N)
+        return nextForChannels<N - 1>(oBuffers, iNumSamples, iOverride);
+    }
+
+    DCHECK_F(fNumChannels == N);
+    return renderChannels<N>(oBuffers, iNumSamples, iOverride);
+  }
+
+  /**
+   * Implementation of the block api for exactly `N` channels */
+  template<int32 N, typename OutputSampleType>
+  int32 renderChannels(OutputSampleType * const *oBuffers, int32 iNumSamples, bool iOverride)
+  {
+    int32 numRendered = 0;
+
+    while(numRendered < iNumSamples && hasNext())
+    {
+      if(fXFaderEnabled && fXFader.hasNext())
+      {
+        // cross fading section => sample by sample
+        for(int32 c = 0; c < N; c++)
+        {
+          if(oBuffers[c])
+          {
+            auto sample = static_cast<OutputSampleType>(fXFader.sample(c));
+            if(iOverride)
+              oBuffers[c][numRendered] = sample;
+            else
+              oBuffers[c][numRendered] += sample;
+          }
+        }
+        fXFader.advance();
+        numRendered++;
+        computeNext();
+      }
+      else
+        numRendered += copyRun<N>(oBuffers, numRendered, iNumSamples - numRendered, iOverride);
+    }
+
+    return numRendered;
+  }
+
+  /**
+   * Renders (up to `iNumSamples`) the section of the slice that does not involve the cross fader, meaning up to
+   * the point where `computeNext` would either start cross fading to 0 or end. Leaves the slicer in the same state
+   * as if `next()` had been called for each sample.
+   *
+   * @param iOffset where to start writing in each output buffer
+   * @return the number of samples rendered (always > 0 since the slicer is playing and not cross fading) */
+  template<int32 N, typename OutputSampleType>
+  int32 copyRun(OutputSampleType * const *oBuffers, int32 iOffset, int32 iNumSamples, bool iOverride)
+  {
+    DCHECK_F(hasNext());
+    DCHECK_F(fCurrent >= fStart && fCurrent < fEnd);
+
+    int32 numSamples;
+
+    if(fReverse)
+    {
+      // index at which the cross fader kicks in (or fStart - 1 which means end)
+      auto limit = fXFaderEnabled && fCurrent > fStart + numXFadeSamples - 1 ? fStart + numXFadeSamples - 1 : fStart - 1;
+      numSamples = std::min(fCurrent - limit, iNumSamples);
+
+      for(int32 c = 0; c < N; c++)
+      {
+        if(!oBuffers[c])
+          continue;
+
+        if(iOverride)
+          Kernels::copyReverse(fBuffers[c] + fCurrent, oBuffers[c] + iOffset, numSamples);
+        else
+          Kernels::addReverse(fBuffers[c] + fCurrent, oBuffers[c] + iOffset, numSamples);
+      }
+
+      fCurrent -= numSamples;
+
+      if(fCurrent == limit)
+      {
+        if(fCurrent < fStart)
+          fCurrent = NOT_PLAYING;
+        else
+          fXFader.xFadeTo0FromBuffer(getBuffers(fCurrent), N, true);
+      }
+    }
+    else
+    {
+      // index at which the cross fader kicks in (or fEnd which means end)
+      auto limit = fXFaderEnabled && fCurrent < fEnd - numXFadeSamples ? fEnd - numXFadeSamples : fEnd;
+      numSamples = std::min(limit - fCurrent, iNumSamples);
+
+      for(int32 c = 0; c < N; c++)
+      {
+        if(!oBuffers[c])
+          continue;
+
+        if(iOverride)
+          Kernels::copy(fBuffers[c] + fCurrent, oBuffers[c] + iOffset, numSamples);
+        else
+          Kernels::add(fBuffers[c] + fCurrent, oBuffers[c] + iOffset, numSamples);
+      }
+
+      fCurrent += numSamples;
+
+      if(fCurrent == limit)
+      {
+        if(fCurrent >= fEnd)
+          fCurrent = NOT_PLAYING;
+        else
+          fXFader.xFadeTo0FromBuffer(getBuffers(fCurrent), N, false);
+      }
+    }
+
+    return numSamples;
+  }
+
   /**
    * Advances the state of the slicer to the next sample (takes looping, reverse and cross fading into consideration)
    *
@@ -307,7 +659,7 @@ private:
       else
       {
         if(fXFaderEnabled && !fXFader.isFadingTo0() && fCurrent == fStart + numXFadeSamples - 1)
-          fXFader.xFadeTo0FromBuffer(getBuffer(fCurrent), true);
+          fXFader.xFadeTo0FromBuffer(getBuffers(fCurrent), fNumChannels, true);
       }
     }
     else
@@ -319,7 +671,7 @@ private:
       else
       {
         if(fXFaderEnabled && !fXFader.isFadingTo0() && fCurrent == fEnd - numXFadeSamples)
-          fXFader.xFadeTo0FromBuffer(getBuffer(fCurrent), false);
+          fXFader.xFadeTo0FromBuffer(getBuffers(fCurrent), fNumChannels, false);
       }
     }
 
@@ -377,26 +729,36 @@ private:
     int32 fCurrent{-1};
   };
 
-  // In dev mode, wraps the buffer access into an object to check boundaries
-  inline SafeBufferAccessor getBuffer(int idx) { return {fStart, fEnd, fBuffer, idx}; }
+  // In dev mode, wraps the buffer access into an object to check boundaries (one per channel)
+  inline std::array<SafeBufferAccessor, numChannels> getBuffers(int idx)
+  {
+    std::array<SafeBufferAccessor, numChannels> res{};
+    for(int32 c = 0; c < fNumChannels; c++)
+      res[c] = {fStart, fEnd, fBuffers[c], idx};
+    return res;
+  }
 #else
-  // in production mode, simply returns the pointer directly
-  inline SampleType const *getBuffer(int idx)
+  // in production mode, simply returns the pointers directly (one per channel)
+  inline std::array<SampleType const *, numChannels> getBuffers(int idx)
   {
-    return &fBuffer[idx];
+    std::array<SampleType const *, numChannels> res{};
+    for(int32 c = 0; c < fNumChannels; c++)
+      res[c] = &fBuffers[c][idx];
+    return res;
   }
 #endif
 
 private:
   int32 fStart{-1};
   int32 fEnd{-1};
-  SampleType const *fBuffer{};
+  int32 fNumChannels{numChannels};
+  SampleType const *fBuffers[numChannels]{};
   int32 fCurrent{NOT_PLAYING};
 
   bool fReverse{false};
 
   bool fXFaderEnabled{true};
-  LinearCrossFader<SampleType, numXFadeSamples> fXFader{};
+  CrossFader<SampleType, numXFadeSamples, numChannels> fXFader{};
 };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <pluginterfaces/base/ftypes.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "AudioKernels.hpp"
+
+namespace pongasoft::VST::SampleSplitter {
+
+using namespace Steinberg;
+
+/**
+ * Energy based transient (onset) detection used to split a sample into non uniform slices. It happens in 2 steps:
+ *
+ * 1. `computeDetectionFunction` (slow, proportional to the size of the sample, so meant to run on a worker thread)
+ *    computes, for each frame of `HOP_SIZE` samples, how much (in dB) the energy rises compared to the previous
+ *    frame (energy flux)
+ * 2. `pickSlices` (fast, proportional to the number of frames) picks the peaks of the detection function based on
+ *    a sensitivity, so that changing the sensitivity does not require computing the detection function again
+ */
+class TransientDetector
+{
+public:
+  // number of samples per frame of the detection function
+  static constexpr int32 HOP_SIZE = 512;
+
+  // energy (in dB) below which a frame is considered silent (a rise from silence to silence is not a transient)
+  static constexpr float SILENCE_DB = -60.0f;
+
+  // how many frames (on each side) are used to compute the (local) average of the detection function
+  static constexpr int32 AVERAGE_NUM_FRAMES = 8;
+
+  // a transient must be the maximum of the detection function in this many frames (on each side)
+  static constexpr int32 MIN_GAP_NUM_FRAMES = 4;
+
+  // how much (in dB) a transient must rise above the local average (at sensitivity 0, none at sensitivity 1)
+  static constexpr float MAX_MARGIN_DB = 24.0f;
+
+  // a transient must always rise at least this much (in dB) above the local average
+  static constexpr float MIN_MARGIN_DB = 1.0f;
+
+  using DetectionFunction = std::vector<float>;
+
+  /**
+   * Computes the detection function of the sample (all channels are combined): one value (>= 0) per frame of
+   * `HOP_SIZE` samples.
+   *
+   * @param iCancel when not `nullptr` and set (from another thread), the computation stops early and returns an
+   *                empty detection function
+   */
+  template<typename SampleType>
+  static DetectionFunction computeDetectionFunction(SampleType const * const *iChannels,
+                                                    int32 iNumChannels,
+                                                    int32 iNumSamples,
+                                                    std::atomic<bool> const *iCancel = nullptr)
+  {
+    auto numFrames = (iNumSamples + HOP_SIZE - 1) / HOP_SIZE;
+
+    DetectionFunction res(static_cast<size_t>(numFrames));
+
+    float previousEnergyInDb = SILENCE_DB;
+
+    for(int32 frame = 0; frame < numFrames; frame++)
+    {
+      if(iCancel && iCancel->load(std::memory_order_relaxed))
+        return {};
+
+      auto start = frame * HOP_SIZE;
+      auto numSamples = std::min(HOP_SIZE, iNumSamples - start);
+
+      double energy = 0;
+      for(int32 c = 0; c < iNumChannels; c++)
+        energy += Kernels::energy(iChannels[c] + start, numSamples);
+      energy /= static_cast<double>(numSamples) * iNumChannels;
+
+      auto energyInDb = std::max(SILENCE_DB, static_cast<float>(10.0 * std::log10(energy + 1e-12)));
+
+      // only rises in energy matter (half wave rectified)
+      res[frame] = std::max(0.0f, energyInDb - previousEnergyInDb);
+      previousEnergyInDb = energyInDb;
+    }
+
+    // the beginning of the sample is always the start of the first slice
+    if(numFrames > 0)
+      res[0] = 0;
+
+    return res;
+  }
+
+  /**
+   * Picks the transients in the detection function: a frame is a transient when its value is the maximum in the
+   * `MIN_GAP_NUM_FRAMES` frames around it and it rises above the local average by a margin which decreases as
+   * `iSensitivity` (in `[0, 1]`) increases. Only the strongest transients are kept when there are too many.
+   *
+   * @return the (sorted) start of each slice (in samples) with the first slice always starting at `0` (so it always
+   *         contains at least 1 slice and at most `iMaxNumSlices` slices)
+   */
+  static std::vector<int32> pickSlices(DetectionFunction const &iDetectionFunction,
+                                       double iSensitivity,
+                                       int32 iNumSamples,
+                                       int32 iMaxNumSlices)
+  {
+    auto numFrames = static_cast<int32>(iDetectionFunction.size());
+
+    auto margin = static_cast<float>(MIN_MARGIN_DB + (1.0 - std::clamp(iSensitivity, 0.0, 1.0)) * MAX_MARGIN_DB);
+
+    // candidate transients (frame index)
+    std::vector<int32> frames{};
+
+    for(int32 frame = 1; frame < numFrames; frame++)
+    {
+      auto value = iDetectionFunction[frame];
+
+      if(value < margin)
+        continue;
+
+      auto from = std::max(1, frame - MIN_GAP_NUM_FRAMES);
+      auto to = std::min(numFrames, frame + MIN_GAP_NUM_FRAMES + 1);
+      if(*std::max_element(iDetectionFunction.begin() + from, iDetectionFunction.begin() + to) > value)
+        continue;
+
+      from = std::max(0, frame - AVERAGE_NUM_FRAMES);
+      to = std::min(numFrames, frame + AVERAGE_NUM_FRAMES + 1);
+      auto sum = std::accumulate(iDetectionFunction.begin() + from, iDetectionFunction.begin() + to, 0.0f);
+      auto average = sum / static_cast<float>(to - from);
+
+      // plateau (multiple frames with the same maximum value) => only the first one counts
+      if(value - average >= margin && (frames.empty() || frame - frames.back() > MIN_GAP_NUM_FRAMES))
+        frames.emplace_back(frame);
+    }
+
+    // keeps the strongest ones
+    auto maxNumTransients = static_cast<size_t>(std::max(iMaxNumSlices - 1, 0));
+    if(frames.size() > maxNumTransients)
+    {
+      std::stable_sort(frames.begin(), frames.end(), [&iDetectionFunction](int32 a, int32 b) {
+        return iDetectionFunction[a] > iDetectionFunction[b];
+      });
+      frames.resize(maxNumTransients);
+      std::sort(frames.begin(), frames.end());
+    }
+
+    std::vector<int32> res{};
+    res.reserve(frames.size() + 1);
+    res.emplace_back(0);
+    for(auto frame: frames)
+    {
+      auto start = frame * HOP_SIZE;
+      if(start < iNumSamples)
+        res.emplace_back(start);
+    }
+
+    return res;
+  }
+};
+
+}
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <pluginterfaces/base/ftypes.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace pongasoft::VST::SampleSplitter {
+
+using namespace Steinberg;
+
+/**
+ * Index of the zero crossings of a sample (one sorted array of positions per channel) so that finding the zero
+ * crossing nearest to a position (to snap a slice boundary or a selection) is `O(log n)` instead of scanning the
+ * samples. Building the index is proportional to the size of the sample so it is meant to happen on a worker thread,
+ * once per sample (the index is immutable once built).
+ *
+ * Position `p` (`0 < p < numSamples`) is a zero crossing when the sign changes between sample `p - 1` and sample `p`
+ * or when sample `p` is the first `0` of a run of `0`s (so that silence does not add one position per sample).
+ */
+class ZeroCrossingIndex
+{
+public:
+  // how many samples are processed between 2 checks for cancellation
+  static constexpr int32 CANCEL_CHECK_NUM_SAMPLES = 1 << 16;
+
+  // Constructor (empty index)
+  ZeroCrossingIndex() = default;
+
+  /**
+   * Builds the index for the sample
+   *
+   * @param iCancel when not `nullptr` and set (from another thread), the build stops early and returns an empty
+   *                index
+   */
+  template<typename SampleType>
+  static ZeroCrossingIndex build(SampleType const * const *iChannels,
+                                 int32 iNumChannels,
+                                 int32 iNumSamples,
+                                 std::atomic<bool> const *iCancel = nullptr)
+  {
+    ZeroCrossingIndex res{};
+    res.fNumSamples = iNumSamples;
+    res.fCrossings.resize(static_cast<size_t>(std::max(iNumChannels, 0)));
+
+    for(int32 c = 0; c < iNumChannels; c++)
+    {
+      auto const *samples = iChannels[c];
+      auto &crossings = res.fCrossings[c];
+
+      for(int32 i = 1; i < iNumSamples; i++)
+      {
+        if(iCancel && i % CANCEL_CHECK_NUM_SAMPLES == 0 && iCancel->load(std::memory_order_relaxed))
+          return {};
+
+        if(isZeroCrossing(samples[i - 1], samples[i]))
+          crossings.emplace_back(i);
+      }
+
+      crossings.shrink_to_fit();
+    }
+
+    return res;
+  }
+
+  // getNumChannels
+  inline int32 getNumChannels() const { return static_cast<int32>(fCrossings.size()); }
+
+  // getNumSamples (of the sample the index was built for)
+  inline int32 getNumSamples() const { return fNumSamples; }
+
+  // getCrossings (sorted positions)
+  inline std::vector<int32> const &getCrossings(int32 iChannel) const { return fCrossings[iChannel]; }
+
+  /**
+   * @return `true` if there is a zero crossing in channel `iChannel` in the range `(iFrom, iTo]` */
+  bool hasCrossing(int32 iChannel, int32 iFrom, int32 iTo) const
+  {
+    auto const &crossings = fCrossings[iChannel];
+    auto iter = std::upper_bound(crossings.begin(), crossings.end(), iFrom);
+    return iter != crossings.end() && *iter <= iTo;
+  }
+
+  /**
+   * @return the zero crossing (of channel `iChannel`) nearest to `iPosition` or `-1` if there is none within
+   *         `iMaxDistance` samples */
+  int32 findNearest(int32 iChannel, int32 iPosition, int32 iMaxDistance) const
+  {
+    auto const &crossings = fCrossings[iChannel];
+
+    auto iter = std::lower_bound(crossings.begin(), crossings.end(), iPosition);
+
+    int32 res = -1;
+    int32 distance = std::numeric_limits<int32>::max();
+
+    if(iter != crossings.end())
+    {
+      res = *iter;
+      distance = *iter - iPosition;
+    }
+
+    if(iter != crossings.begin() && iPosition - *(iter - 1) < distance)
+    {
+      res = *(iter - 1);
+      distance = iPosition - res;
+    }
+
+    return distance <= iMaxDistance ? res : -1;
+  }
+
+  /**
+   * Same as `findNearest(iChannel, ...)` but for all the channels at once: the candidates are the nearest zero
+   * crossing of each channel and the one retained is the one closest to a zero crossing in every other channel (so
+   * that for a stereo sample, the boundary is as click free as possible on both sides).
+   *
+   * @return the zero crossing nearest to `iPosition` or `-1` if there is none within `iMaxDistance` samples */
+  int32 findNearest(int32 iPosition, int32 iMaxDistance) const
+  {
+    int32 res = -1;
+    int64 bestCost = std::numeric_limits<int64>::max();
+
+    for(int32 c = 0; c < getNumChannels(); c++)
+    {
+      auto candidate = findNearest(c, iPosition, iMaxDistance);
+      if(candidate == -1)
+        continue;
+
+      int64 cost = std::abs(candidate - iPosition);
+      for(int32 other = 0; other < getNumChannels(); other++)
+      {
+        if(other == c)
+          continue;
+        auto crossing = findNearest(other, candidate, iMaxDistance);
+        cost += crossing == -1 ? iMaxDistance : std::abs(crossing - candidate);
+      }
+
+      if(cost < bestCost)
+      {
+        bestCost = cost;
+        res = candidate;
+      }
+    }
+
+    return res;
+  }
+
+  /**
+   * @return the zero crossing nearest to `iPosition` (all channels, see `findNearest`) or `iPosition` itself if there
+   *         is none within `iMaxDistance` samples */
+  inline int32 snap(int32 iPosition, int32 iMaxDistance) const
+  {
+    auto res = findNearest(iPosition, iMaxDistance);
+    return res == -1 ? iPosition : res;
+  }
+
+  /**
+   * Snaps each position of `ioPositions` (sorted) to its nearest zero crossing while keeping them strictly increasing
+   * (a position which cannot be snapped without reaching one of its neighbors is left unchanged). Position `0` (the
+   * start of the sample) is never moved. */
+  void snap(std::vector<int32> &ioPositions, int32 iMaxDistance) const
+  {
+    for(size_t i = 0; i < ioPositions.size(); i++)
+    {
+      auto position = ioPositions[i];
+      if(position <= 0)
+        continue;
+
+      auto snapped = snap(position, iMaxDistance);
+      auto previous = i > 0 ? ioPositions[i - 1] : -1;
+      auto next = i + 1 < ioPositions.size() ? ioPositions[i + 1] : std::numeric_limits<int32>::max();
+
+      if(snapped > previous && snapped < next)
+        ioPositions[i] = snapped;
+    }
+  }
+
+  /**
+   * Convenient call to determine if there is a zero crossing between 2 consecutive samples (in this order). Leaving
+   * `0` is not a zero crossing (entering it was). */
+  template<typename SampleType>
+  static inline bool isZeroCrossing(SampleType iPrevious, SampleType iCurrent)
+  {
+    if(iPrevious == 0)
+      return false;
+
+    if(iCurrent == 0)
+      return true;
+
+    return iPrevious < 0 ? iCurrent > 0 : iCurrent < 0;
+  }
+
+private:
+  int32 fNumSamples{};
+  std::vector<std::vector<int32>> fCrossings{};
+};
+
+using SharedZeroCrossingIndex = std::shared_ptr<ZeroCrossingIndex const>;
+
+}
@@ -0,0 +1,94 @@
+#include <pluginterfaces/vst/vsttypes.h>
+#include <pongasoft/VST/AudioUtils.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <src/cpp/AudioKernels.hpp>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+// AudioKernels - copy (forward/reverse, override/add, with conversion)
+TEST(AudioKernels, copy)
+{
+  Sample32 in[] = {1.5f, -2.25f, 3.0f, 4.125f};
+  Sample64 out[4]{};
+
+  Kernels::copy(in, out, 4);
+  ASSERT_EQ(std::vector<Sample64>({1.5, -2.25, 3.0, 4.125}), std::vector<Sample64>(out, out + 4));
+
+  Kernels::add(in, out, 3);
+  ASSERT_EQ(std::vector<Sample64>({3.0, -4.5, 6.0, 4.125}), std::vector<Sample64>(out, out + 4));
+
+  Kernels::copyReverse(in + 3, out, 4);
+  ASSERT_EQ(std::vector<Sample64>({4.125, 3.0, -2.25, 1.5}), std::vector<Sample64>(out, out + 4));
+
+  Kernels::addReverse(in + 1, out, 2);
+  ASSERT_EQ(std::vector<Sample64>({1.875, 4.5, -2.25, 1.5}), std::vector<Sample64>(out, out + 4));
+}
+
+// AudioKernels - peak
+TEST(AudioKernels, peak)
+{
+  Sample32 buffer[] = {0.5f, -0.75f, 0.25f, 0.0f};
+
+  ASSERT_EQ(0.75f, Kernels::peak(buffer, 4));
+  ASSERT_EQ(0.5f, Kernels::peak(buffer, 1));
+  ASSERT_EQ(0.0f, Kernels::peak(buffer, 0));
+}
+
+// AudioKernels - isSilent: must match VST::isSilent applied to each sample (on either side of a chunk boundary)
+TEST(AudioKernels, isSilent)
+{
+  constexpr int NUM_SAMPLES = 200;
+
+  for(auto value: {1e-9, -1e-9, 1e-3, -1e-3})
+  {
+    for(auto index: {0, 63, 64, 150, NUM_SAMPLES - 1})
+    {
+      std::vector<Sample64> buffer(NUM_SAMPLES, 1e-10);
+      buffer[index] = value;
+
+      auto expected = std::all_of(buffer.begin(), buffer.end(), [](auto s) { return VST::isSilent(s); });
+      ASSERT_EQ(expected, Kernels::isSilent(buffer.data(), NUM_SAMPLES)) << "value=" << value << " index=" << index;
+    }
+  }
+
+  ASSERT_TRUE(Kernels::isSilent(static_cast<Sample32 const *>(nullptr), 0));
+}
+
+// AudioKernels - findFirstAbove: must match a sample by sample scan (on either side of a chunk boundary)
+TEST(AudioKernels, findFirstAbove)
+{
+  constexpr int NUM_SAMPLES = 200;
+
+  for(auto index: {0, 63, 64, 150, NUM_SAMPLES - 1})
+  {
+    std::vector<Sample32> buffer(NUM_SAMPLES, 0.1f);
+    buffer[index] = -0.5f;
+    buffer[NUM_SAMPLES - 1] = 0.6f;
+
+    ASSERT_EQ(index, Kernels::findFirstAbove(buffer.data(), NUM_SAMPLES, 0.25f));
+    ASSERT_EQ(NUM_SAMPLES - 1, Kernels::findFirstAbove(buffer.data(), NUM_SAMPLES, 0.55f));
+  }
+
+  std::vector<Sample32> buffer(NUM_SAMPLES, 0.1f);
+  ASSERT_EQ(NUM_SAMPLES, Kernels::findFirstAbove(buffer.data(), NUM_SAMPLES, 0.25f));
+  ASSERT_EQ(0, Kernels::findFirstAbove(buffer.data(), NUM_SAMPLES, 0.05f));
+  ASSERT_EQ(0, Kernels::findFirstAbove(buffer.data(), 0, 0.05f));
+}
+
+// AudioKernels - copyWithGain
+TEST(AudioKernels, copyWithGain)
+{
+  Sample32 in[] = {0.5f, -0.75f, 0.25f};
+  Sample32 out[3]{};
+
+  ASSERT_EQ(1.5f, Kernels::copyWithGain(in, out, 3, 2.0));
+  ASSERT_EQ(std::vector<Sample32>({1.0f, -1.5f, 0.5f}), std::vector<Sample32>(out, out + 3));
+}
+
+}
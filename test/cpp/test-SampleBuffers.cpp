@@ -1,4 +1,5 @@
 #include <src/cpp/SampleBuffers.hpp>
+#include <cmath>
 #include <gtest/gtest.h>
 
 namespace pongasoft {
@@ -188,6 +189,142 @@ TEST(SampleBuffers, crop)
 
 }
 
+// SampleBuffers - unroll
+TEST(SampleBuffers, unroll)
+{
+  constexpr int NUM_SAMPLES = 6;
+
+  SampleBuffers32 sampleBuffers{44100, 2, NUM_SAMPLES};
+
+  // circular buffer where the sample starts at index 4 (and wraps around)
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    sampleBuffers.getBuffer()[0][i] = (i + 2) % NUM_SAMPLES + 1;
+    sampleBuffers.getBuffer()[1][i] = -((i + 2) % NUM_SAMPLES + 1);
+  }
+
+  // right sized copy: the original buffers are untouched
+  auto unrolled = sampleBuffers.unroll(4, 5);
+  ASSERT_EQ(5, unrolled->getNumSamples());
+  ASSERT_EQ(2, unrolled->getNumChannels());
+  ASSERT_EQ(V32({1,2,3,4,5}), toVector(unrolled, 0));
+  ASSERT_EQ(V32({-1,-2,-3,-4,-5}), toVector(unrolled, 1));
+  ASSERT_EQ(NUM_SAMPLES, sampleBuffers.getNumSamples());
+  ASSERT_EQ(V32({3,4,5,6,1,2}), toVector(sampleBuffers.first(NUM_SAMPLES), 0));
+
+  // no wrapping around
+  ASSERT_EQ(V32({4,5,6}), toVector(sampleBuffers.unroll(1, 3), 0));
+
+  // the whole buffer
+  ASSERT_EQ(V32({5,6,1,2,3,4}), toVector(sampleBuffers.unroll(2, 100), 0));
+
+  ASSERT_FALSE(sampleBuffers.unroll(3, 0)->hasSamples());
+}
+
+// SampleBuffers - pad
+TEST(SampleBuffers, pad)
+{
+  SampleBuffers32 sampleBuffers{44100, 2, 3};
+
+  for(int i = 0; i < 3; i++)
+  {
+    sampleBuffers.getBuffer()[0][i] = i + 1;
+    sampleBuffers.getBuffer()[1][i] = -(i + 1);
+  }
+
+  auto padded = sampleBuffers.pad(6);
+  ASSERT_EQ(6, padded->getNumSamples());
+  ASSERT_EQ(2, padded->getNumChannels());
+  ASSERT_EQ(44100, padded->getSampleRate());
+  ASSERT_EQ(V32({1,2,3,0,0,0}), toVector(padded, 0));
+  ASSERT_EQ(V32({-1,-2,-3,0,0,0}), toVector(padded, 1));
+
+  // truncated when longer
+  ASSERT_EQ(V32({1,2}), toVector(sampleBuffers.pad(2), 0));
+
+  ASSERT_FALSE(sampleBuffers.pad(0)->hasSamples());
+  ASSERT_TRUE(sampleBuffers.pad(-1) == nullptr);
+}
+
+// SampleBuffers - resample
+TEST(SampleBuffers, resample)
+{
+  constexpr int NUM_SAMPLES = 44100;
+
+  SampleBuffers32 sampleBuffers{44100, 2, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    sampleBuffers.getBuffer()[0][i] = static_cast<Sample32>((i % 100) / 100.0);
+    sampleBuffers.getBuffer()[1][i] = static_cast<Sample32>(-(i % 37) / 37.0);
+  }
+
+  auto resampled = sampleBuffers.resample(48000);
+  ASSERT_EQ(48000, resampled->getSampleRate());
+  ASSERT_EQ(2, resampled->getNumChannels());
+  ASSERT_EQ(48000, resampled->getNumSamples());
+
+  // the channels are resampled concurrently: same result as resampling each one on its own
+  for(int32 c = 0; c < 2; c++)
+  {
+    SampleBuffers32 channel{44100, 1, NUM_SAMPLES};
+    std::copy(sampleBuffers.getChannelBuffer(c), sampleBuffers.getChannelBuffer(c) + NUM_SAMPLES, channel.getBuffer()[0]);
+    ASSERT_EQ(toVector(channel.resample(48000)), toVector(resampled, c));
+  }
+
+  // cancelled
+  SampleBuffers32 large{44100, 2, 1 << 17};
+  ASSERT_EQ(nullptr, large.resample(48000, [](float) { return false; }));
+
+  // an exception (thrown while resampling the first channel) propagates once the other channels are stopped
+  ASSERT_THROW(large.resample(48000, [](float) -> bool { throw std::runtime_error("progress"); }), std::runtime_error);
+}
+
+// SampleBuffers - resample (both qualities)
+TEST(SampleBuffers, resampleQuality)
+{
+  constexpr int NUM_SAMPLES = 44100;
+  constexpr double FREQUENCY = 1000.0;
+
+  SampleBuffers32 sampleBuffers{44100, 2, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    auto sample = static_cast<Sample32>(std::sin(2.0 * M_PI * FREQUENCY * i / 44100.0));
+    sampleBuffers.getBuffer()[0][i] = sample;
+    sampleBuffers.getBuffer()[1][i] = -sample;
+  }
+
+  for(auto quality: {EResamplingQuality::kFast, EResamplingQuality::kHigh})
+  {
+    auto resampled = sampleBuffers.resample(48000, {}, quality);
+    ASSERT_EQ(48000, resampled->getSampleRate());
+    ASSERT_EQ(2, resampled->getNumChannels());
+    ASSERT_EQ(48000, resampled->getNumSamples());
+
+    // same tone: same amplitude (RMS) and same frequency (zero crossings), ignoring the edges (10ms)
+    constexpr int EDGE = 480;
+    constexpr int NUM_MEASURED = 48000 - 2 * EDGE;
+
+    for(int32 c = 0; c < 2; c++)
+    {
+      auto buffer = resampled->getChannelBuffer(c);
+
+      double sumSquares = 0;
+      int numZeroCrossings = 0;
+      for(int i = EDGE; i < EDGE + NUM_MEASURED; i++)
+      {
+        sumSquares += buffer[i] * buffer[i];
+        if((buffer[i - 1] < 0) != (buffer[i] < 0))
+          numZeroCrossings++;
+      }
+
+      ASSERT_NEAR(1.0 / std::sqrt(2.0), std::sqrt(sumSquares / NUM_MEASURED), 0.01);
+      ASSERT_NEAR(2.0 * FREQUENCY * NUM_MEASURED / 48000.0, numZeroCrossings, 2);
+    }
+  }
+}
+
 
 }
 }
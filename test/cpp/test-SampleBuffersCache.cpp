@@ -0,0 +1,148 @@
+#include <src/cpp/SampleBuffers.hpp>
+#include <src/cpp/GUI/SampleBuffersCache.h>
+#include <gtest/gtest.h>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using namespace GUI;
+
+// a (fake) content hash for the tests
+static ContentHash fakeHash(uint8 iValue)
+{
+  ContentHash res{};
+  res[0] = iValue;
+  return res;
+}
+
+// hex representation of a content hash
+static std::string toHex(ContentHash const &iHash)
+{
+  static constexpr char HEX[] = "0123456789abcdef";
+  std::string res{};
+  for(auto b: iHash)
+  {
+    res += HEX[b >> 4];
+    res += HEX[b & 0xf];
+  }
+  return res;
+}
+
+// SampleBuffersCache - findAndAdd
+TEST(SampleBuffersCache, findAndAdd)
+{
+  SampleBuffersCache cache{};
+
+  SampleBuffersCache::Key key{fakeHash(1), 100, 44100};
+
+  ASSERT_FALSE(cache.find(key));
+
+  auto buffers = std::make_shared<SampleBuffers32>(44100, 2, 10);
+  auto value = cache.add(key, {buffers, 48000});
+  ASSERT_EQ(buffers, value.fBuffers);
+  ASSERT_EQ(2 * 10 * sizeof(Sample32), cache.getMemoryUsage());
+
+  auto cached = cache.find(key);
+  ASSERT_TRUE(cached);
+  ASSERT_EQ(buffers, cached->fBuffers);
+  ASSERT_EQ(48000, cached->fOriginalSampleRate);
+
+  // different sample rate => different entry
+  ASSERT_FALSE(cache.find({fakeHash(1), 100, 48000}));
+
+  // different resampling quality => different entry
+  ASSERT_FALSE(cache.find({fakeHash(1), 100, 44100, EResamplingQuality::kFast}));
+
+  // another instance adding the same sample gets the one already in the cache
+  value = cache.add(key, {std::make_shared<SampleBuffers32>(44100, 2, 10), 48000});
+  ASSERT_EQ(buffers, value.fBuffers);
+  ASSERT_EQ(1, cache.size());
+}
+
+// SampleBuffersCache - evict
+TEST(SampleBuffersCache, evict)
+{
+  constexpr size_t SAMPLE_SIZE = 10 * sizeof(Sample32);
+
+  SampleBuffersCache cache{2 * SAMPLE_SIZE};
+
+  auto b1 = std::make_shared<SampleBuffers32>(44100, 1, 10);
+  auto b2 = std::make_shared<SampleBuffers32>(44100, 1, 10);
+  cache.add({fakeHash(1), 40, 44100}, {b1, 44100});
+  cache.add({fakeHash(2), 40, 44100}, {b2, 44100});
+  ASSERT_EQ(2, cache.size());
+
+  // over budget but all in use => nothing is evicted
+  auto b3 = std::make_shared<SampleBuffers32>(44100, 1, 10);
+  cache.add({fakeHash(3), 40, 44100}, {b3, 44100});
+  ASSERT_EQ(3, cache.size());
+  ASSERT_EQ(3 * SAMPLE_SIZE, cache.getMemoryUsage());
+
+  // b1 and b2 no longer in use, b1 is the least recently used => evicted first
+  b1 = nullptr;
+  b2 = nullptr;
+  ASSERT_TRUE(cache.find({fakeHash(1), 40, 44100}));
+  cache.setMemoryBudget(2 * SAMPLE_SIZE);
+  ASSERT_EQ(2, cache.size());
+  ASSERT_TRUE(cache.find({fakeHash(1), 40, 44100}));
+  ASSERT_FALSE(cache.find({fakeHash(2), 40, 44100}));
+
+  cache.setMemoryBudget(0);
+  ASSERT_EQ(1, cache.size()); // b3 still in use
+  ASSERT_EQ(SAMPLE_SIZE, cache.getMemoryUsage());
+}
+
+// ContentHasher - hash (SHA-256 test vectors)
+TEST(ContentHasher, hash)
+{
+  ASSERT_EQ("e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", toHex(ContentHasher::hash("", 0)));
+  ASSERT_EQ("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", toHex(ContentHasher::hash("abc", 3)));
+
+  std::string const message = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+  ASSERT_EQ("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", toHex(ContentHasher::hash(message.data(), message.size())));
+
+  // 1 million 'a' hashed in (uneven) chunks
+  std::vector<char> chunk(999, 'a');
+  ContentHasher hasher{};
+  size_t remaining = 1000000;
+  while(remaining > 0)
+  {
+    auto count = std::min(remaining, chunk.size());
+    hasher.update(chunk.data(), count);
+    remaining -= count;
+  }
+  ASSERT_EQ("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", toHex(hasher.digest()));
+
+  // any change => different hash
+  std::vector<uint8> content(100);
+  for(size_t i = 0; i < content.size(); i++)
+    content[i] = static_cast<uint8>(i * 7);
+  auto hash = ContentHasher::hash(content.data(), content.size());
+  content[99]++;
+  ASSERT_NE(hash, ContentHasher::hash(content.data(), content.size()));
+}
+
+// SampleBuffersCache - findOriginal
+TEST(SampleBuffersCache, findOriginal)
+{
+  SampleBuffersCache cache{};
+
+  auto resampled = std::make_shared<SampleBuffers32>(48000, 2, 10);
+  cache.add({fakeHash(1), 100, 48000}, {resampled, 44100});
+
+  // only the resampled sample is in the cache
+  ASSERT_FALSE(cache.findOriginal(fakeHash(1), 100));
+
+  auto original = std::make_shared<SampleBuffers32>(44100, 2, 9);
+  cache.add({fakeHash(1), 100, 44100}, {original, 44100});
+
+  auto cached = cache.findOriginal(fakeHash(1), 100);
+  ASSERT_TRUE(cached);
+  ASSERT_EQ(original, cached->fBuffers);
+  ASSERT_EQ(44100, cached->fOriginalSampleRate);
+
+  // different sample
+  ASSERT_FALSE(cache.findOriginal(fakeHash(2), 100));
+  ASSERT_FALSE(cache.findOriginal(fakeHash(1), 101));
+}
+
+}
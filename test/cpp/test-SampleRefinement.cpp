@@ -0,0 +1,72 @@
+#include <src/cpp/SampleBuffers.hpp>
+#include <src/cpp/GUI/SampleRefinement.h>
+#include <gtest/gtest.h>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using namespace GUI;
+
+// SampleRefinement - swap (the current sample has not changed)
+TEST(SampleRefinement, swap)
+{
+  SampleRefinement refinement{};
+
+  auto current = std::make_shared<SampleBuffers32>(48000, 2, 10);
+  auto refined = std::make_shared<SampleBuffers32>(48000, 2, 10);
+
+  ASSERT_FALSE(refinement.isRefining(current));
+
+  refinement.start(current);
+  ASSERT_TRUE(refinement.isRefining(current));
+  ASSERT_FALSE(refinement.isRefining(refined));
+
+  ASSERT_TRUE(refinement.complete(current, refined));
+
+  // no longer refining
+  ASSERT_FALSE(refinement.isRefining(current));
+  ASSERT_FALSE(refinement.complete(current, refined));
+}
+
+// SampleRefinement - discard (the refined sample is obsolete or invalid)
+TEST(SampleRefinement, discard)
+{
+  SampleRefinement refinement{};
+
+  auto current = std::make_shared<SampleBuffers32>(48000, 2, 10);
+  auto refined = std::make_shared<SampleBuffers32>(48000, 2, 10);
+
+  // the current sample has changed (new sample, action, undo...)
+  refinement.start(current);
+  ASSERT_FALSE(refinement.complete(std::make_shared<SampleBuffers32>(48000, 2, 10), refined));
+  ASSERT_FALSE(refinement.isRefining(current));
+
+  // the refinement failed
+  refinement.start(current);
+  ASSERT_FALSE(refinement.complete(current, nullptr));
+
+  // the refined sample is the current one (shared from the cache)
+  refinement.start(current);
+  ASSERT_FALSE(refinement.complete(current, current));
+
+  // the sample rate has changed
+  refinement.start(current);
+  ASSERT_FALSE(refinement.complete(current, std::make_shared<SampleBuffers32>(44100, 2, 10)));
+
+  // no current sample
+  refinement.start(nullptr);
+  ASSERT_FALSE(refinement.isRefining(nullptr));
+  ASSERT_FALSE(refinement.complete(nullptr, refined));
+
+  // the sample being refined is gone (a new one may be allocated at the same address)
+  refinement.start(current);
+  current = nullptr;
+  ASSERT_FALSE(refinement.complete(std::make_shared<SampleBuffers32>(48000, 2, 10), refined));
+
+  // reset (for example when refined synchronously)
+  current = std::make_shared<SampleBuffers32>(48000, 2, 10);
+  refinement.start(current);
+  refinement.reset();
+  ASSERT_FALSE(refinement.complete(current, refined));
+}
+
+}
@@ -389,6 +389,337 @@ TEST(SampleSlice, playWithCrossFade)
 
 }
 
+// SampleSlice - playWithCrossFadeCurve (the curve applies to all the slices)
+TEST(SampleSlice, playWithCrossFadeCurve)
+{
+  constexpr int NUM_CHANNELS = 2;
+  constexpr int NUM_SAMPLES = 12;
+
+  SampleBuffers32 sampleBuffers{44100, NUM_CHANNELS, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    sampleBuffers.getBuffer()[0][i] = 2.0;
+    sampleBuffers.getBuffer()[1][i] = -2.0;
+  }
+
+  AudioOut<NUM_CHANNELS, 3> audioOut{};
+
+  SampleSlices<64, 2, 5> ss;
+  ss.setNumActiveSlices(1);
+  ss.setCrossFade(true);
+  ss.setCrossFadeCurve(EXFadeCurve::kSCurve);
+  ss.setPlayMode(EPlayMode::kHold);
+  ss.setBuffers(&sampleBuffers);
+
+  constexpr XFadeGainTable<Sample32, 5> gains{EXFadeCurve::kSCurve};
+
+  ss.setPadSelected(0, true);
+  ss.setLoop(0, false);
+
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 2.0f * gains.fIn[0],
+                                        2.0f * gains.fIn[1],
+                                        2.0f * gains.fIn[2] }}));
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 2.0f * gains.fIn[3],
+                                        2.0f * gains.fIn[4],
+                                        2.0f }}));
+}
+
+// SampleSlice - playSections (sample accurate start/stop)
+TEST(SampleSlice, playSections)
+{
+  constexpr int NUM_CHANNELS = 2;
+  constexpr int NUM_SAMPLES = 20;
+  constexpr Sample32 FIRST_SAMPLE = 5.0;
+
+  SampleBuffers32 sampleBuffers{44100, NUM_CHANNELS, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    auto sample = static_cast<Sample32>(i) + FIRST_SAMPLE;
+    sampleBuffers.getBuffer()[0][i] = sample;
+    sampleBuffers.getBuffer()[1][i] = -sample;
+  }
+
+  AudioOut<NUM_CHANNELS, 6> audioOut{};
+
+  SampleSlices<> ss;
+  // 2 active slices (10 samples each)
+  ss.setNumActiveSlices(2);
+  ss.setCrossFade(false);
+  ss.setPolyphonic(true);
+  ss.setPlayMode(EPlayMode::kHold);
+
+  ss.setBuffers(&sampleBuffers);
+
+  {
+    // nothing selected in [0, 2) => section left untouched
+    auto &out = audioOut.getBuffers();
+    ASSERT_FALSE(ss.play(out, 0, 2, true));
+
+    // slice 0 selected at sample 2
+    ss.setPadSelected(0, true, 2);
+    ASSERT_TRUE(ss.play(out, 2, 4, true));
+
+    // slice 1 selected at sample 4 (slice 0 still playing)
+    ss.setNoteSelected(1, true, 4);
+    ASSERT_TRUE(ss.play(out, 4, 6, true));
+
+    ss.adjustSilenceFlags(out);
+
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 0, 0, 5.0, 6.0, 7.0 + 15.0, 8.0 + 16.0 }}));
+  }
+
+  {
+    // slice 0 released then pressed again in the same frame => restarts at the exact sample
+    auto &out = audioOut.getBuffers();
+    ss.setPadSelected(0, false, 5);
+    ASSERT_TRUE(ss.play(out, 0, 1, true));
+    ss.setPadSelected(0, true, 6);
+    ASSERT_TRUE(ss.play(out, 1, 3, true));
+    ss.setNoteSelected(1, false, 7);
+    ASSERT_TRUE(ss.play(out, 3, 6, true));
+
+    ss.adjustSilenceFlags(out);
+
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 17.0, 5.0 + 18.0, 6.0 + 19.0, 7.0, 8.0, 9.0 }}));
+  }
+}
+
+// SampleSlice - sliceMap (non uniform split)
+TEST(SampleSlice, sliceMap)
+{
+  constexpr int NUM_CHANNELS = 2;
+  constexpr int NUM_SAMPLES = 20;
+  constexpr Sample32 FIRST_SAMPLE = 5.0;
+
+  SampleBuffers32 sampleBuffers{44100, NUM_CHANNELS, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    auto sample = static_cast<Sample32>(i) + FIRST_SAMPLE;
+    sampleBuffers.getBuffer()[0][i] = sample;
+    sampleBuffers.getBuffer()[1][i] = -sample;
+  }
+
+  AudioOut<NUM_CHANNELS, 6> audioOut{};
+
+  SampleSlices<> ss;
+  ss.setNumActiveSlices(2);
+  ss.setCrossFade(false);
+  ss.setPolyphonic(true);
+  ss.setPlayMode(EPlayMode::kHold);
+
+  ss.setBuffers(&sampleBuffers);
+
+  // slice 0 is [0, 4), slice 1 is [4, 20)
+  SliceMap sliceMap{NUM_SAMPLES, {0, 4}};
+  ss.setSliceMap(&sliceMap);
+
+  {
+    auto &out = audioOut.getBuffers();
+    ss.setPadSelected(1, true, 0);
+    ASSERT_TRUE(ss.play(out, 0, 6, true));
+    ss.adjustSilenceFlags(out);
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 9.0, 10.0, 11.0, 12.0, 13.0, 14.0 }}));
+    ss.setPadSelected(1, false, 1);
+  }
+
+  // the slice map does not apply to 3 slices => uniform
+  ss.setNumActiveSlices(3);
+
+  {
+    auto &out = audioOut.getBuffers();
+    ss.setPadSelected(1, true, 2);
+    ASSERT_TRUE(ss.play(out, 0, 6, true));
+    ss.adjustSilenceFlags(out);
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 11.0, 12.0, 13.0, 14.0, 15.0, 16.0 }}));
+  }
+}
+
+// SampleSlice - retriggerOverlap (extra voices)
+TEST(SampleSlice, retriggerOverlap)
+{
+  constexpr int NUM_CHANNELS = 2;
+  constexpr int NUM_SAMPLES = 20;
+  constexpr Sample32 FIRST_SAMPLE = 5.0;
+
+  SampleBuffers32 sampleBuffers{44100, NUM_CHANNELS, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    auto sample = static_cast<Sample32>(i) + FIRST_SAMPLE;
+    sampleBuffers.getBuffer()[0][i] = sample;
+    sampleBuffers.getBuffer()[1][i] = -sample;
+  }
+
+  AudioOut<NUM_CHANNELS, 3> audioOut{};
+
+  SampleSlices<> ss;
+  // 2 active slices (10 samples each)
+  ss.setNumActiveSlices(2);
+  ss.setCrossFade(false);
+  ss.setPolyphonic(true);
+  ss.setPlayMode(EPlayMode::kTrigger);
+
+  ss.setBuffers(&sampleBuffers);
+
+  ss.setPadSelected(0, true);
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 5.0, 6.0, 7.0 }}));
+
+  // retrigger slice 0 while still playing => the first instance keeps playing
+  ss.setPadSelected(0, false);
+  ss.setPadSelected(0, true);
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 5.0 + 8.0, 6.0 + 9.0, 7.0 + 10.0 }}));
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 8.0 + 11.0, 9.0 + 12.0, 10.0 + 13.0 }}));
+
+  // first instance is done
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 11.0 + 14.0, 12.0, 13.0 }}));
+
+  // in hold mode, retrigger restarts the slice (no overlap)
+  ss.setPlayMode(EPlayMode::kHold);
+  ss.setPadSelected(0, false);
+  ss.setPadSelected(0, true);
+  ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+  ASSERT_TRUE(audioOut.checkBuffers2({{ 5.0, 6.0, 7.0 }}));
+
+  ss.setPadSelected(0, false);
+  ASSERT_FALSE(ss.play(audioOut.getBuffers()));
+}
+
+// SampleSlice - voiceStealing (max number of voices)
+TEST(SampleSlice, voiceStealing)
+{
+  constexpr int NUM_CHANNELS = 2;
+  constexpr int NUM_SAMPLES = 20;
+  constexpr Sample32 FIRST_SAMPLE = 5.0;
+
+  SampleBuffers32 sampleBuffers{44100, NUM_CHANNELS, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    auto sample = static_cast<Sample32>(i) + FIRST_SAMPLE;
+    sampleBuffers.getBuffer()[0][i] = sample;
+    sampleBuffers.getBuffer()[1][i] = -sample;
+  }
+
+  AudioOut<NUM_CHANNELS, 2> audioOut{};
+
+  {
+    SampleSlices<> ss;
+    // 4 active slices (5 samples each)
+    ss.setNumActiveSlices(4);
+    ss.setCrossFade(false);
+    ss.setPolyphonic(true);
+    ss.setPlayMode(EPlayMode::kHold);
+    ss.setMaxNumVoices(2);
+    ss.setVoiceStealing(EVoiceStealing::kOldest);
+
+    ss.setBuffers(&sampleBuffers);
+
+    ss.setPadSelected(0, true, 1);
+    ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 5.0, 6.0 }}));
+
+    ss.setPadSelected(1, true, 2);
+    ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 7.0 + 10.0, 8.0 + 11.0 }}));
+
+    // slice 0 is the oldest => stopped
+    ss.setPadSelected(2, true, 3);
+    ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 12.0 + 15.0, 13.0 + 16.0 }}));
+  }
+
+  {
+    SampleSlices<> ss;
+    // 4 active slices (5 samples each)
+    ss.setNumActiveSlices(4);
+    ss.setCrossFade(false);
+    ss.setPolyphonic(true);
+    ss.setPlayMode(EPlayMode::kHold);
+    ss.setMaxNumVoices(2);
+    ss.setVoiceStealing(EVoiceStealing::kQuietest);
+
+    ss.setBuffers(&sampleBuffers);
+
+    ss.setPadSelected(1, true, 1);
+    ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 10.0, 11.0 }}));
+
+    ss.setPadSelected(0, true, 2);
+    ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 12.0 + 5.0, 13.0 + 6.0 }}));
+
+    // slice 0 is the quietest (7 vs 14) => stopped
+    ss.setPadSelected(2, true, 3);
+    ASSERT_TRUE(ss.play(audioOut.getBuffers()));
+    ASSERT_TRUE(audioOut.checkBuffers2({{ 14.0 + 15.0, 16.0 }}));
+  }
+}
+
+// SampleSlice - play64Bits (sample stored in 32 or 64 bits, played in 64 bits)
+TEST(SampleSlice, play64Bits)
+{
+  constexpr int NUM_CHANNELS = 2;
+  constexpr int NUM_SAMPLES = 20;
+  constexpr int NUM_OUT_SAMPLES = 4;
+
+  SampleBuffers<Sample64> sampleBuffers64{44100, NUM_CHANNELS, NUM_SAMPLES};
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    // not representable as a float
+    auto sample = 0.1 + static_cast<Sample64>(i) / 3.0;
+    sampleBuffers64.getBuffer()[0][i] = sample;
+    sampleBuffers64.getBuffer()[1][i] = -sample;
+  }
+
+  auto sampleBuffers32 = sampleBuffers64.convert<Sample32>();
+
+  Sample64 left[NUM_OUT_SAMPLES]{};
+  Sample64 right[NUM_OUT_SAMPLES]{};
+  Sample64 *channels[NUM_CHANNELS]{left, right};
+  AudioBusBuffers audioBusBuffers{};
+  audioBusBuffers.numChannels = NUM_CHANNELS;
+  audioBusBuffers.channelBuffers64 = channels;
+  AudioBuffers64 out{audioBusBuffers, NUM_OUT_SAMPLES};
+
+  // plays slice 1 (first 4 samples) and checks the output against the expected samples
+  auto checkPlay = [&](auto &iSlices, auto const *iBuffers, auto iExpectedSample) {
+    iSlices.setNumActiveSlices(2);
+    iSlices.setCrossFade(false);
+    iSlices.setPolyphonic(true);
+    iSlices.setPlayMode(EPlayMode::kHold);
+    iSlices.setBuffers(iBuffers);
+
+    iSlices.setPadSelected(1, true);
+    ASSERT_TRUE(iSlices.play(out));
+    for(int i = 0; i < NUM_OUT_SAMPLES; i++)
+    {
+      ASSERT_EQ(iExpectedSample(10 + i), left[i]);
+      ASSERT_EQ(-iExpectedSample(10 + i), right[i]);
+    }
+  };
+
+  {
+    // no loss of precision
+    SampleSlices<NUM_SLICES, 2, 5, NUM_EXTRA_VOICES, Sample64> ss;
+    checkPlay(ss, &sampleBuffers64, [&sampleBuffers64](int i) { return sampleBuffers64.getBuffer()[0][i]; });
+  }
+
+  {
+    SampleSlices<> ss;
+    checkPlay(ss, sampleBuffers32.get(), [&sampleBuffers32](int i) { return static_cast<Sample64>(sampleBuffers32->getBuffer()[0][i]); });
+  }
+}
+
 // SampleSlice - crossFadeIssue
 // Commented out as it is was used for debugging code
 //TEST(SampleSlice, crossFadeIssue)
@@ -0,0 +1,166 @@
+#include <pongasoft/logging/logging.h>
+#include <sndfile.hh>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <src/cpp/SampleStream.h>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using V32 = std::vector<Sample32>;
+
+// SampleFIFO - write/read (interleaved, wrapping around, full)
+TEST(SampleFIFO, writeRead)
+{
+  Sample32 left[] = {1, 2, 3, 4, 5};
+  Sample32 right[] = {-1, -2, -3, -4, -5};
+  Sample32 *channels[] = {left, right};
+
+  AudioBusBuffers audioBusBuffers{};
+  audioBusBuffers.numChannels = 2;
+  audioBusBuffers.channelBuffers32 = channels;
+  AudioBuffers32 in{audioBusBuffers, 5};
+
+  SampleFIFO fifo{2, 4};
+
+  V32 frames(8);
+
+  // nothing to read
+  ASSERT_EQ(0, fifo.read(frames.data(), 4));
+
+  ASSERT_EQ(3, fifo.write(in, 0, 3));
+  ASSERT_EQ(2, fifo.read(frames.data(), 2));
+  ASSERT_EQ(V32({1, -1, 2, -2}), V32(frames.begin(), frames.begin() + 4));
+
+  // only 3 frames are free (wraps around)
+  ASSERT_EQ(3, fifo.write(in, 1, 5));
+  ASSERT_EQ(0, fifo.write(in, 0, 1));
+
+  ASSERT_EQ(4, fifo.read(frames.data(), 10));
+  ASSERT_EQ(V32({3, -3, 2, -2, 3, -3, 4, -4}), frames);
+  ASSERT_EQ(0, fifo.read(frames.data(), 10));
+
+  // missing channel => silence
+  AudioBusBuffers monoBusBuffers{};
+  monoBusBuffers.numChannels = 1;
+  monoBusBuffers.channelBuffers32 = channels;
+  AudioBuffers32 mono{monoBusBuffers, 5};
+
+  ASSERT_EQ(2, fifo.write(mono, 3, 5));
+  ASSERT_EQ(2, fifo.read(frames.data(), 10));
+  ASSERT_EQ(V32({4, 0, 5, 0}), V32(frames.begin(), frames.begin() + 4));
+}
+
+// SampleStreamWriter - streams a take (larger than the FIFO) to a file and reads it back
+TEST(SampleStreamWriter, take)
+{
+  constexpr int NUM_FRAMES = 1000;
+
+  // the take is saved as 32 bits float (exactly as recorded)
+  std::vector<Sample32> left(NUM_FRAMES), right(NUM_FRAMES);
+  for(int i = 0; i < NUM_FRAMES; i++)
+  {
+    left[i] = static_cast<Sample32>(i % 256) / 256.0f;
+    right[i] = -left[i];
+  }
+  Sample32 *channels[] = {left.data(), right.data()};
+
+  AudioBusBuffers audioBusBuffers{};
+  audioBusBuffers.numChannels = 2;
+  audioBusBuffers.channelBuffers32 = channels;
+  AudioBuffers32 in{audioBusBuffers, NUM_FRAMES};
+
+  SampleStreamWriter writer{44100, 2, 64};
+
+  auto takeId = writer.rtBeginTake();
+  ASSERT_GT(takeId, 0);
+
+  // only one take at a time
+  ASSERT_EQ(0, writer.rtBeginTake());
+
+  // RT writes blocks of frames (giving the writer thread a chance to empty the FIFO when full)
+  int32 offset = 0;
+  while(offset < NUM_FRAMES)
+  {
+    auto numFrames = writer.rtWrite(in, offset, std::min(offset + 32, NUM_FRAMES));
+    if(numFrames == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    offset += numFrames;
+  }
+
+  writer.rtEndTake();
+
+  // the UI polls until the take has been written (never blocks)
+  std::optional<UTF8Path> filePath{};
+  int64 numDroppedFrames = -1;
+  while(!(filePath = writer.uiAcquireTake(takeId, &numDroppedFrames)))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  ASSERT_FALSE(filePath->cpp_str().empty());
+  ASSERT_EQ(0, numDroppedFrames);
+
+  // already acquired
+  ASSERT_TRUE(writer.uiAcquireTake(takeId)->cpp_str().empty());
+
+  // a new take can begin
+  ASSERT_EQ(takeId + 1, writer.rtBeginTake());
+  writer.rtEndTake();
+
+  SndfileHandle file{filePath->toNativePath().c_str()};
+  ASSERT_EQ(2, file.channels());
+  ASSERT_EQ(44100, file.samplerate());
+  ASSERT_EQ(NUM_FRAMES, file.frames());
+
+  V32 frames(NUM_FRAMES * 2);
+  ASSERT_EQ(NUM_FRAMES, file.readf(frames.data(), NUM_FRAMES));
+  for(int i = 0; i < NUM_FRAMES; i++)
+  {
+    ASSERT_EQ(left[i], frames[i * 2]);
+    ASSERT_EQ(right[i], frames[i * 2 + 1]);
+  }
+
+  std::remove(filePath->toNativePath().c_str());
+}
+
+// SampleStreamWriter - the frames RT drops when the writer thread cannot keep up are reported to the UI
+TEST(SampleStreamWriter, droppedFrames)
+{
+  constexpr int NUM_FRAMES = 1000;
+
+  std::vector<Sample32> left(NUM_FRAMES, 0.5f), right(NUM_FRAMES, -0.5f);
+  Sample32 *channels[] = {left.data(), right.data()};
+
+  AudioBusBuffers audioBusBuffers{};
+  audioBusBuffers.numChannels = 2;
+  audioBusBuffers.channelBuffers32 = channels;
+  AudioBuffers32 in{audioBusBuffers, NUM_FRAMES};
+
+  SampleStreamWriter writer{44100, 2, 64};
+
+  auto takeId = writer.rtBeginTake();
+  ASSERT_GT(takeId, 0);
+
+  // RT never waits => the FIFO overflows
+  auto numFramesWritten = writer.rtWrite(in, 0, NUM_FRAMES);
+  ASSERT_LT(numFramesWritten, NUM_FRAMES);
+
+  writer.rtEndTake();
+
+  std::optional<UTF8Path> filePath{};
+  int64 numDroppedFrames = -1;
+  while(!(filePath = writer.uiAcquireTake(takeId, &numDroppedFrames)))
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+  ASSERT_FALSE(filePath->cpp_str().empty());
+  ASSERT_EQ(NUM_FRAMES - numFramesWritten, numDroppedFrames);
+
+  SndfileHandle file{filePath->toNativePath().c_str()};
+  ASSERT_EQ(numFramesWritten, file.frames());
+
+  std::remove(filePath->toNativePath().c_str());
+}
+
+}
@@ -0,0 +1,218 @@
+#include <pongasoft/logging/logging.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <src/cpp/Sampler.hpp>
+#include <src/cpp/SampleBuffers.hpp>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using V32 = std::vector<Sample32>;
+
+// a mono input whose samples are simply increasing numbers (1, 2, 3...) across calls
+struct AudioIn
+{
+  explicit AudioIn(int32 iNumSamples) : fSamples(iNumSamples)
+  {
+    fChannels[0] = fSamples.data();
+    fAudioBusBuffers.numChannels = 1;
+    fAudioBusBuffers.channelBuffers32 = fChannels;
+  }
+
+  AudioBuffers32 &next()
+  {
+    for(auto &s: fSamples)
+      s = static_cast<Sample32>(++fCounter);
+    return fAudioBuffers;
+  }
+
+  std::vector<Sample32> fSamples;
+  Sample32 *fChannels[1]{};
+  AudioBusBuffers fAudioBusBuffers{};
+  AudioBuffers32 fAudioBuffers{fAudioBusBuffers, static_cast<int32>(fSamples.size())};
+  int fCounter{};
+};
+
+// unrolls the take the same way the UI does
+inline V32 toVector(Sampler32::Take const &iTake)
+{
+  auto buffers = iTake.fBuffers->unroll(iTake.fStartOffset, iTake.fNumSamples);
+  auto b = buffers->getChannelBuffer(0);
+  return V32(b, b + buffers->getNumSamples());
+}
+
+// Sampler - no capture: the take always starts at the beginning of the buffers
+TEST(Sampler, sample)
+{
+  AudioIn in{4};
+  SampleBuffers32 buffers{44100, 1, 6};
+  SampleBuffers32 spare{44100, 1, 6};
+
+  Sampler32 sampler{1};
+  sampler.init(&buffers, &spare);
+
+  // not sampling => nothing recorded
+  sampler.sample(in.next());
+
+  sampler.start();
+  ASSERT_EQ(ESamplerState::kSampling, sampler.sample(in.next(), 2));
+  ASSERT_EQ(ESamplerState::kDoneSampling, sampler.sample(in.next()));
+
+  auto take = sampler.acquireBuffers();
+  ASSERT_EQ(&buffers, take.fBuffers);
+  ASSERT_EQ(0, take.fStartOffset);
+  ASSERT_EQ(6, take.fNumSamples);
+  ASSERT_EQ(V32({7, 8, 9, 10, 11, 12}), toVector(take));
+
+  // switched to the spare buffers
+  ASSERT_TRUE(sampler.isInitialized());
+  sampler.start();
+  sampler.sample(in.next());
+  sampler.stop();
+  take = sampler.acquireBuffers();
+  ASSERT_EQ(&spare, take.fBuffers);
+  ASSERT_EQ(4, take.fNumSamples);
+  ASSERT_EQ(6, spare.getNumSamples()); // the buffers are not modified
+  ASSERT_EQ(V32({13, 14, 15, 16}), toVector(take));
+
+  ASSERT_FALSE(sampler.isInitialized());
+}
+
+// Sampler - the buffers of a previous take are handed back as spare buffers
+TEST(Sampler, setSpareBuffers)
+{
+  AudioIn in{4};
+  SampleBuffers32 buffers{44100, 1, 6};
+  SampleBuffers32 spare{44100, 1, 6};
+
+  Sampler32 sampler{1};
+  sampler.init(&buffers, &spare);
+
+  sampler.start();
+  sampler.sample(in.next());
+  sampler.stop();
+  auto take = sampler.acquireBuffers();
+  ASSERT_EQ(&buffers, take.fBuffers);
+  ASSERT_FALSE(sampler.hasSpareBuffers());
+
+  // not using these buffers anymore
+  ASSERT_FALSE(sampler.setSpareBuffers(&buffers, &spare));
+
+  // can be done while sampling
+  sampler.start();
+  sampler.sample(in.next());
+  ASSERT_TRUE(sampler.setSpareBuffers(&spare, &buffers));
+  ASSERT_TRUE(sampler.isSampling());
+  sampler.sample(in.next());
+  sampler.stop();
+
+  take = sampler.acquireBuffers();
+  ASSERT_EQ(&spare, take.fBuffers);
+  ASSERT_EQ(V32({5, 6, 7, 8, 9, 10}), toVector(take));
+
+  // switched back to the first buffers
+  ASSERT_TRUE(sampler.isInitialized());
+  ASSERT_FALSE(sampler.hasSpareBuffers());
+}
+
+// Sampler - capture with pre-roll
+TEST(Sampler, preRoll)
+{
+  AudioIn in{4};
+  SampleBuffers32 buffers{44100, 1, 8}; // 6 for the take + 2 for the pre-roll
+
+  Sampler32 sampler{1};
+  sampler.init(&buffers);
+  sampler.setCapture(true, 2);
+
+  // capturing (wraps around)
+  sampler.sample(in.next());
+  sampler.sample(in.next());
+  sampler.sample(in.next());
+
+  auto &frame = in.next();
+  sampler.sample(frame, 0, 1); // what precedes the trigger
+  sampler.start();
+  ASSERT_EQ(ESamplerState::kSampling, sampler.sample(frame, 1));
+  ASSERT_EQ(ESamplerState::kDoneSampling, sampler.sample(in.next()));
+
+  auto take = sampler.acquireBuffers();
+  ASSERT_EQ(&buffers, take.fBuffers);
+  ASSERT_EQ(8, take.fNumSamples);
+  ASSERT_NE(0, take.fStartOffset);
+  ASSERT_EQ(V32({12, 13, 14, 15, 16, 17, 18, 19}), toVector(take));
+}
+
+// Sampler - look back (start detected late)
+TEST(Sampler, lookBack)
+{
+  AudioIn in{4};
+  SampleBuffers32 buffers{44100, 1, 9}; // 6 for the take + 1 for the pre-roll + 2 for the look back
+
+  Sampler32 sampler{1};
+  sampler.init(&buffers);
+  sampler.setCapture(true, 1, 2);
+
+  sampler.sample(in.next());
+  sampler.sample(in.next());
+
+  // the take starts 2 samples before (7) and the pre-roll precedes it (6)
+  sampler.start(2);
+  ASSERT_EQ(ESamplerState::kDoneSampling, sampler.sample(in.next()));
+
+  auto take = sampler.acquireBuffers();
+  ASSERT_EQ(7, take.fNumSamples);
+  ASSERT_EQ(V32({6, 7, 8, 9, 10, 11, 12}), toVector(take));
+
+  // the look back is limited to what was provided in setCapture
+  SampleBuffers32 buffers2{44100, 1, 9};
+  sampler.init(&buffers2);
+  sampler.sample(in.next());
+  sampler.start(10);
+  sampler.sample(in.next());
+  sampler.stop();
+  take = sampler.acquireBuffers();
+  ASSERT_EQ(V32({14, 15, 16, 17, 18, 19, 20}), toVector(take)); // 15 and 16 looked back for, 14 being the pre-roll
+}
+
+// Sampler - retroactive commit
+TEST(Sampler, commit)
+{
+  AudioIn in{4};
+  SampleBuffers32 buffers{44100, 1, 8}; // 6 for the take + 2 for the pre-roll
+
+  Sampler32 sampler{1};
+  sampler.init(&buffers);
+
+  // not capturing => nothing to commit
+  sampler.sample(in.next());
+  ASSERT_FALSE(sampler.commit());
+
+  sampler.setCapture(true, 2);
+
+  // nothing captured yet
+  ASSERT_FALSE(sampler.commit());
+
+  // less than a take
+  sampler.sample(in.next());
+  ASSERT_TRUE(sampler.commit());
+  auto take = sampler.acquireBuffers();
+  ASSERT_EQ(0, take.fStartOffset);
+  ASSERT_EQ(V32({5, 6, 7, 8}), toVector(take));
+
+  SampleBuffers32 buffers2{44100, 1, 8};
+  sampler.init(&buffers2);
+
+  sampler.sample(in.next());
+  sampler.sample(in.next());
+  sampler.sample(in.next());
+
+  // the last 6 samples (the pre-roll is not included)
+  ASSERT_TRUE(sampler.commit());
+  take = sampler.acquireBuffers();
+  ASSERT_EQ(&buffers2, take.fBuffers);
+  ASSERT_EQ(V32({15, 16, 17, 18, 19, 20}), toVector(take));
+}
+
+}
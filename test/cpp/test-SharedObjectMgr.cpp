@@ -1,6 +1,8 @@
 #include <src/cpp/SharedObjectMgr.h>
 #include <gtest/gtest.h>
 #include <atomic>
+#include <thread>
+#include <chrono>
 
 namespace pongasoft::VST::SampleSplitter::Test {
 
@@ -102,6 +104,8 @@ TEST(SharedObjectMgr, test)
 
     // rt -> 78 [5]
     ASSERT_EQ(5, mgr.rtSetObject(std::make_shared<MyTestValue>(78)));
+    ASSERT_EQ(3, MyTestValue::instanceCounter.load()); // 56 is released by UI only
+    mgr.uiReclaim();
     ASSERT_EQ(2, MyTestValue::instanceCounter.load()); // 2 instances
     ASSERT_EQ(78, mgr.rtGetObject()->fValue);
     ASSERT_EQ(67, mgr.uiGetObject()->fValue);
@@ -112,6 +116,8 @@ TEST(SharedObjectMgr, test)
 
     // rt -> 89 [6]
     ASSERT_EQ(6, mgr.rtSetObject(std::make_shared<MyTestValue>(89)));
+    ASSERT_EQ(3, MyTestValue::instanceCounter.load()); // 78 is released by UI only
+    mgr.uiReclaim();
     ASSERT_EQ(2, MyTestValue::instanceCounter.load()); // 2 instances
     ASSERT_EQ(89, mgr.rtGetObject()->fValue);
     ASSERT_EQ(67, mgr.uiGetObject()->fValue);
@@ -140,6 +146,8 @@ TEST(SharedObjectMgr, test)
     ASSERT_EQ(35, mgr.uiGetObject()->fValue);
 
     ASSERT_EQ(35, mgr.rtAdjustObjectFromUI(7)->fValue); // UI was changed twice and RT will get the latest value
+    ASSERT_EQ(2, MyTestValue::instanceCounter.load()); // 89 is released by UI only
+    mgr.uiReclaim();
     ASSERT_EQ(1, MyTestValue::instanceCounter.load()); // back to 1
     ASSERT_EQ(35, mgr.uiGetObject()->fValue);
     ASSERT_EQ(35, mgr.rtGetObject()->fValue);
@@ -156,6 +164,8 @@ TEST(SharedObjectMgr, test)
 
     // rt -> 57 [10]
     ASSERT_EQ(10, mgr.rtSetObject(std::make_shared<MyTestValue>(57)));
+    ASSERT_EQ(3, MyTestValue::instanceCounter.load()); // 35 is released by UI only
+    mgr.uiReclaim();
     ASSERT_EQ(2, MyTestValue::instanceCounter.load()); // 2 instances
     ASSERT_EQ(57, mgr.rtGetObject()->fValue);
     ASSERT_EQ(46, mgr.uiGetObject()->fValue);
@@ -164,6 +174,8 @@ TEST(SharedObjectMgr, test)
 
     // rt -> nullptr [11]
     ASSERT_EQ(11, mgr.rtSetObject(nullptr));
+    ASSERT_EQ(2, MyTestValue::instanceCounter.load()); // 57 is released by UI only
+    mgr.uiReclaim();
     ASSERT_EQ(1, MyTestValue::instanceCounter.load()); // 1 instance
     ASSERT_TRUE(mgr.rtGetObject() == nullptr);
     ASSERT_EQ(46, mgr.uiGetObject()->fValue);
@@ -186,4 +198,154 @@ TEST(SharedObjectMgr, test)
   ASSERT_EQ(0, MyTestValue::instanceCounter.load());
 }
 
-}
\ No newline at end of file
+// SharedObjectMgr - rtFlush: when the UI does not reclaim, RT keeps what it drops until there is room
+TEST(SharedObjectMgr, rtFlush)
+{
+  // no instance at start
+  ASSERT_EQ(0, MyTestValue::instanceCounter.load());
+
+  {
+    SharedObjectMgr<MyTestValue> mgr{};
+
+    // each rtSetObject sends 2 entries to the UI => more than the queue can hold
+    constexpr int NUM_OBJECTS = 50;
+    for(int i = 0; i < NUM_OBJECTS; i++)
+      mgr.rtSetObject(std::make_shared<MyTestValue>(i));
+
+    // nothing has been released on the RT side
+    ASSERT_EQ(NUM_OBJECTS, MyTestValue::instanceCounter.load());
+
+    // the UI releases what is in the queue (and keeps the most recent object set by RT)
+    mgr.uiReclaim();
+    ASSERT_TRUE(MyTestValue::instanceCounter.load() > 1);
+    ASSERT_TRUE(MyTestValue::instanceCounter.load() < NUM_OBJECTS);
+
+    // RT sends what it kept
+    mgr.rtFlush();
+    mgr.uiReclaim();
+    ASSERT_EQ(1, MyTestValue::instanceCounter.load());
+
+    ASSERT_EQ(NUM_OBJECTS - 1, mgr.uiAdjustObjectFromRT(NUM_OBJECTS)->fValue);
+    ASSERT_EQ(NUM_OBJECTS - 1, mgr.rtGetObject()->fValue);
+    ASSERT_EQ(1, MyTestValue::instanceCounter.load());
+  }
+
+  // no instance at end
+  ASSERT_EQ(0, MyTestValue::instanceCounter.load());
+}
+
+// SharedObjectMgr - rtRelease: RT keeps using the previous object after rtSetObject and hands it back later
+TEST(SharedObjectMgr, rtRelease)
+{
+  // no instance at start
+  ASSERT_EQ(0, MyTestValue::instanceCounter.load());
+
+  {
+    SharedObjectMgr<MyTestValue> mgr{};
+
+    mgr.rtSetObject(std::make_shared<MyTestValue>(1));
+    mgr.uiAdjustObjectFromRT(1);
+    ASSERT_EQ(1, MyTestValue::instanceCounter.load());
+
+    // RT keeps a reference to the previous object while setting a new one
+    auto previous = mgr.rtGetObject();
+    ASSERT_EQ(2, mgr.rtSetObject(std::make_shared<MyTestValue>(2)));
+    ASSERT_EQ(2, mgr.uiAdjustObjectFromRT(2)->fValue);
+
+    // the UI has released its references but the previous object is still alive
+    ASSERT_EQ(2, MyTestValue::instanceCounter.load());
+    ASSERT_EQ(1, previous->fValue);
+
+    // RT hands it back => released by the UI
+    mgr.rtRelease(std::move(previous));
+    ASSERT_TRUE(previous == nullptr);
+    ASSERT_EQ(2, MyTestValue::instanceCounter.load());
+    mgr.uiReclaim();
+    ASSERT_EQ(1, MyTestValue::instanceCounter.load());
+
+    // nothing to release
+    mgr.rtRelease(nullptr);
+    mgr.uiReclaim();
+    ASSERT_EQ(2, mgr.rtGetObject()->fValue);
+    ASSERT_EQ(1, MyTestValue::instanceCounter.load());
+  }
+
+  // no instance at end
+  ASSERT_EQ(0, MyTestValue::instanceCounter.load());
+}
+
+// SharedObjectMgr - concurrent: RT never releases an object (released by the UI thread only)
+struct MyRTTestValue
+{
+  explicit MyRTTestValue(int iValue, std::thread::id const *iRTThreadId) : fValue(iValue), fRTThreadId{iRTThreadId} {}
+  ~MyRTTestValue() { if(std::this_thread::get_id() == *fRTThreadId) releasedOnRT = true; }
+
+  int fValue;
+  std::thread::id const *fRTThreadId;
+
+  static std::atomic<bool> releasedOnRT;
+};
+
+std::atomic<bool> MyRTTestValue::releasedOnRT{false};
+
+TEST(SharedObjectMgr, concurrent)
+{
+  constexpr int NUM_ITERATIONS = 5000;
+
+  // how many rtSetObject RT can be ahead of the UI (each one sends 2 entries to the UI)
+  constexpr int MAX_RT_ADVANCE = 8;
+
+  // written before RT starts (rtStart) and only read after (declared first: the objects outlive the test)
+  std::thread::id rtThreadId{};
+
+  SharedObjectMgr<MyRTTestValue> mgr{};
+  std::atomic<int64> uiVersion{};
+  std::atomic<int64> rtVersion{};
+  std::atomic<bool> rtStart{false};
+  std::atomic<bool> rtDone{false};
+
+  // number of objects set by RT / seen by the UI (the UI reclaims every time it checks)
+  std::atomic<int> rtCount{0};
+  std::atomic<int> uiCount{0};
+
+  std::thread rt([&] {
+    while(!rtStart.load(std::memory_order_acquire))
+      std::this_thread::yield();
+
+    for(int i = 0; i < NUM_ITERATIONS; i++)
+    {
+      auto object = mgr.rtAdjustObjectFromUI(uiVersion.load()).get(); // see note 3
+      if(object)
+      {
+        ASSERT_TRUE(object->fValue >= 0);
+      }
+      if(i % 10 == 0)
+      {
+        // the UI must be given a chance to reclaim
+        while(rtCount.load() - uiCount.load() >= MAX_RT_ADVANCE)
+          std::this_thread::yield();
+        rtVersion = mgr.rtSetObject(std::make_shared<MyRTTestValue>(i, &rtThreadId));
+        rtCount++;
+      }
+    }
+    rtDone = true;
+  });
+
+  rtThreadId = rt.get_id();
+  rtStart.store(true, std::memory_order_release);
+
+  for(int i = 0; !rtDone; i++)
+  {
+    auto count = rtCount.load();
+    mgr.uiAdjustObjectFromRT(rtVersion.load());
+    uiCount = count;
+    if(i % 3 == 0)
+      uiVersion = mgr.uiSetObject(std::make_shared<MyRTTestValue>(i, &rtThreadId));
+  }
+
+  rt.join();
+
+  ASSERT_FALSE(MyRTTestValue::releasedOnRT.load());
+}
+
+}
@@ -0,0 +1,60 @@
+#include <pluginterfaces/vst/vsttypes.h>
+
+#include <gtest/gtest.h>
+
+#include <src/cpp/SliceMap.h>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+// SliceMap - uniform
+TEST(SliceMap, uniform)
+{
+  auto sliceMap = SliceMap::uniform(10, NumSlice{3});
+  ASSERT_EQ(3, sliceMap.getNumSlices());
+  ASSERT_EQ(0, sliceMap.getStart(0));
+  ASSERT_EQ(3, sliceMap.getEnd(0));
+  ASSERT_EQ(6, sliceMap.getStart(2));
+  ASSERT_EQ(9, sliceMap.getEnd(2)); // sample 9 is not part of any slice
+
+  // fractional => last slice is shorter
+  sliceMap = SliceMap::uniform(10, NumSlice{2.5});
+  ASSERT_EQ(3, sliceMap.getNumSlices());
+  ASSERT_EQ(4, sliceMap.getStart(1));
+  ASSERT_EQ(8, sliceMap.getStart(2));
+  ASSERT_EQ(10, sliceMap.getEnd(2));
+
+  ASSERT_TRUE(sliceMap.appliesTo(10, NumSlice{2.5}));
+  ASSERT_TRUE(sliceMap.appliesTo(10, NumSlice{3}));
+  ASSERT_FALSE(sliceMap.appliesTo(10, NumSlice{2}));
+  ASSERT_FALSE(sliceMap.appliesTo(11, NumSlice{3}));
+}
+
+// SliceMap - findSlice
+TEST(SliceMap, findSlice)
+{
+  ASSERT_EQ(-1, SliceMap{}.findSlice(0));
+
+  SliceMap sliceMap{100, {0, 10, 50, 51}};
+  ASSERT_EQ(4, sliceMap.getNumSlices());
+  ASSERT_EQ(100, sliceMap.getEnd(3));
+
+  ASSERT_EQ(0, sliceMap.findSlice(-5));
+  ASSERT_EQ(0, sliceMap.findSlice(0));
+  ASSERT_EQ(0, sliceMap.findSlice(9));
+  ASSERT_EQ(1, sliceMap.findSlice(10));
+  ASSERT_EQ(1, sliceMap.findSlice(49));
+  ASSERT_EQ(2, sliceMap.findSlice(50));
+  ASSERT_EQ(3, sliceMap.findSlice(51));
+  ASSERT_EQ(3, sliceMap.findSlice(150));
+
+  // resolve
+  ASSERT_EQ(sliceMap, SliceMap::resolve(&sliceMap, 100, NumSlice{4}));
+  ASSERT_EQ(SliceMap::uniform(101, NumSlice{4}), SliceMap::resolve(&sliceMap, 101, NumSlice{4}));
+  ASSERT_EQ(SliceMap::uniform(100, NumSlice{2}), SliceMap::resolve(&sliceMap, 100, NumSlice{2}));
+  ASSERT_EQ(SliceMap::uniform(100, NumSlice{2}), SliceMap::resolve(nullptr, 100, NumSlice{2}));
+}
+
+}
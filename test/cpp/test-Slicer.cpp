@@ -1,4 +1,5 @@
 #include <pluginterfaces/vst/vsttypes.h>
+#include <cmath>
 
 #include <gtest/gtest.h>
 
@@ -242,4 +243,238 @@ TEST(Slicer, getSampleWithCrossFade)
 
 }
 
+// Slicer - nextBuffer: the block api must be bit identical to calling next() once per sample
+TEST(Slicer, nextBuffer)
+{
+  constexpr int NUM_SAMPLES = 50;
+  constexpr int NUM_OUT_SAMPLES = 7;
+
+  Sample32 buffer[NUM_SAMPLES];
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+    buffer[i] = 0.3f + static_cast<Sample32>(i) / 7.0f;
+
+  for(int config = 0; config < 8; config++)
+  {
+    bool xFade = (config & 1) != 0;
+    bool reverse = (config & 2) != 0;
+    bool override = (config & 4) != 0;
+
+    Slicer<Sample32, 5> expectedSlicer{};
+    Slicer<Sample32, 5> slicer{};
+
+    for(auto s: {&expectedSlicer, &slicer})
+    {
+      s->crossFade(xFade);
+      s->reverse(reverse);
+      s->reset(buffer, 3, 41);
+      s->start();
+    }
+
+    // renders multiple blocks, stopping/restarting in the middle to exercise all cross fading paths
+    for(int block = 0; block < 12; block++)
+    {
+      if(block == 3 || block == 9)
+      {
+        expectedSlicer.requestStop();
+        slicer.requestStop();
+      }
+
+      if(block == 4 || block == 10)
+      {
+        expectedSlicer.start();
+        slicer.start();
+      }
+
+      Sample64 expected[NUM_OUT_SAMPLES];
+      Sample64 actual[NUM_OUT_SAMPLES];
+      std::fill(std::begin(expected), std::end(expected), 0.5);
+      std::fill(std::begin(actual), std::end(actual), 0.5);
+
+      int32 expectedNumRendered = 0;
+      while(expectedNumRendered < NUM_OUT_SAMPLES && expectedSlicer.hasNext())
+      {
+        auto sample = static_cast<Sample64>(expectedSlicer.next());
+        if(override)
+          expected[expectedNumRendered] = sample;
+        else
+          expected[expectedNumRendered] += sample;
+        expectedNumRendered++;
+      }
+
+      ASSERT_EQ(expectedNumRendered, slicer.next(actual, NUM_OUT_SAMPLES, override));
+      ASSERT_EQ(expectedSlicer.hasNext(), slicer.hasNext());
+      ASSERT_EQ(expectedSlicer.numSamplesPlayed(), slicer.numSamplesPlayed());
+
+      for(int i = 0; i < NUM_OUT_SAMPLES; i++)
+        ASSERT_EQ(expected[i], actual[i]) << "config=" << config << " block=" << block << " i=" << i;
+    }
+  }
+}
+
+
+// Slicer - crossFadeCurves
+TEST(Slicer, crossFadeCurves)
+{
+  constexpr int NUM_XFADE_SAMPLES = 5;
+
+  // linear: same values as the original ramp
+  {
+    constexpr XFadeGainTable<Sample32, NUM_XFADE_SAMPLES> gains{EXFadeCurve::kLinear};
+    constexpr Sample32 expected[] = {0.00, 0.25, 0.50, 0.75, 1.00};
+    for(int i = 0; i < NUM_XFADE_SAMPLES; i++)
+    {
+      ASSERT_EQ(expected[i], gains.fIn[i]);
+      ASSERT_EQ(expected[NUM_XFADE_SAMPLES - 1 - i], gains.fOut[i]);
+      ASSERT_EQ(1 - expected[i], gains.fComplement[i]);
+    }
+  }
+
+  // equal power: in^2 + complement^2 == 1
+  {
+    constexpr XFadeGainTable<Sample64, NUM_XFADE_SAMPLES> gains{EXFadeCurve::kEqualPower};
+    ASSERT_EQ(0, gains.fIn[0]);
+    ASSERT_EQ(1, gains.fIn[NUM_XFADE_SAMPLES - 1]);
+    ASSERT_NEAR(std::sqrt(0.5), gains.fIn[2], 1e-12);
+    for(int i = 0; i < NUM_XFADE_SAMPLES; i++)
+      ASSERT_NEAR(1.0, gains.fIn[i] * gains.fIn[i] + gains.fComplement[i] * gains.fComplement[i], 1e-12);
+  }
+
+  // s curve: symmetric around the middle
+  {
+    constexpr XFadeGainTable<Sample64, NUM_XFADE_SAMPLES> gains{EXFadeCurve::kSCurve};
+    constexpr Sample64 expected[] = {0.0, 0.15625, 0.5, 0.84375, 1.0};
+    for(int i = 0; i < NUM_XFADE_SAMPLES; i++)
+    {
+      ASSERT_EQ(expected[i], gains.fIn[i]);
+      ASSERT_EQ(gains.fOut[i], gains.fComplement[i]);
+    }
+  }
+
+  // slicer using equal power curve
+  {
+    Sample64 buffer[20];
+    std::fill(std::begin(buffer), std::end(buffer), 2.0);
+
+    Slicer<Sample64, NUM_XFADE_SAMPLES> slicer{};
+    slicer.crossFadeCurve(EXFadeCurve::kEqualPower);
+    slicer.reset(buffer, 0, 20);
+    slicer.start();
+
+    constexpr XFadeGainTable<Sample64, NUM_XFADE_SAMPLES> gains{EXFadeCurve::kEqualPower};
+    for(int i = 0; i < NUM_XFADE_SAMPLES; i++)
+      ASSERT_EQ(2.0 * gains.fIn[i], slicer.next());
+    ASSERT_EQ(2.0, slicer.next());
+  }
+}
+
+
+// Slicer - multiChannel: all channels share the same play head and render like independent single channel slicers
+TEST(Slicer, multiChannel)
+{
+  constexpr int NUM_SAMPLES = 50;
+  constexpr int NUM_OUT_SAMPLES = 9;
+
+  Sample32 left[NUM_SAMPLES];
+  Sample32 right[NUM_SAMPLES];
+
+  for(int i = 0; i < NUM_SAMPLES; i++)
+  {
+    left[i] = 0.3f + static_cast<Sample32>(i) / 7.0f;
+    right[i] = -0.2f - static_cast<Sample32>(i) / 3.0f;
+  }
+
+  Sample32 const *buffers[] = {left, right};
+
+  for(int config = 0; config < 4; config++)
+  {
+    bool xFade = (config & 1) != 0;
+    bool reverse = (config & 2) != 0;
+
+    Slicer<Sample32, 5> expectedLeft{};
+    Slicer<Sample32, 5> expectedRight{};
+    Slicer<Sample32, 5, 2> slicer{};
+
+    expectedLeft.reset(left, 2, 45);
+    expectedRight.reset(right, 2, 45);
+    slicer.reset(buffers, 2, 2, 45);
+    ASSERT_EQ(2, slicer.getNumChannels());
+
+    for(auto s: {&expectedLeft, &expectedRight})
+    {
+      s->crossFade(xFade);
+      s->reverse(reverse);
+      s->start();
+    }
+    slicer.crossFade(xFade);
+    slicer.reverse(reverse);
+    slicer.start();
+
+    for(int block = 0; block < 8; block++)
+    {
+      if(block == 3)
+      {
+        expectedLeft.requestStop();
+        expectedRight.requestStop();
+        slicer.requestStop();
+      }
+
+      if(block == 4)
+      {
+        expectedLeft.start();
+        expectedRight.start();
+        slicer.start();
+      }
+
+      Sample32 expected[2][NUM_OUT_SAMPLES]{};
+      Sample32 actual[2][NUM_OUT_SAMPLES]{};
+      Sample32 *out[] = {actual[0], actual[1]};
+
+      auto expectedNumRendered = expectedLeft.next(expected[0], NUM_OUT_SAMPLES, true);
+      ASSERT_EQ(expectedNumRendered, expectedRight.next(expected[1], NUM_OUT_SAMPLES, true));
+      ASSERT_EQ(expectedNumRendered, slicer.next(out, NUM_OUT_SAMPLES, true));
+      ASSERT_EQ(expectedLeft.hasNext(), slicer.hasNext());
+
+      for(int c = 0; c < 2; c++)
+        for(int i = 0; i < NUM_OUT_SAMPLES; i++)
+          ASSERT_EQ(expected[c][i], actual[c][i]) << "config=" << config << " block=" << block << " c=" << c << " i=" << i;
+    }
+  }
+}
+
+// Slicer - currentLevel
+TEST(Slicer, currentLevel)
+{
+  constexpr int NUM_SAMPLES = 1000;
+
+  // a sine wave going through 0 at every multiple of 50 samples
+  Sample32 buffer[NUM_SAMPLES];
+  for(int i = 0; i < NUM_SAMPLES; i++)
+    buffer[i] = static_cast<Sample32>(0.5 * std::sin(M_PI * i / 50.0));
+
+  Slicer<Sample32, 4> slicer{};
+  slicer.crossFade(false);
+  slicer.reset(buffer, 0, NUM_SAMPLES);
+
+  ASSERT_EQ(0, slicer.currentLevel());
+
+  slicer.start();
+
+  // at a zero crossing, the level is still the RMS of the sine wave (0.5 / sqrt(2))
+  ASSERT_EQ(0, buffer[0]);
+  ASSERT_NEAR(0.5 / std::sqrt(2.0), slicer.currentLevel(), 0.01);
+
+  Sample32 out[75];
+  slicer.next(out, 75, true);
+  ASSERT_NEAR(0.5 / std::sqrt(2.0), slicer.currentLevel(), 0.01);
+
+  // reverse
+  slicer.reverse(true);
+  slicer.start();
+  ASSERT_NEAR(0.5 / std::sqrt(2.0), slicer.currentLevel(), 0.01);
+
+  slicer.requestStop();
+  ASSERT_EQ(0, slicer.currentLevel());
+}
+
 }
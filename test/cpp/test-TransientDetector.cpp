@@ -0,0 +1,60 @@
+#include <pluginterfaces/vst/vsttypes.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <src/cpp/TransientDetector.hpp>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+constexpr int32 HOP_SIZE = TransientDetector::HOP_SIZE;
+
+// adds a burst (decaying) starting at iStart
+static void addBurst(std::vector<Sample32> &ioBuffer, int32 iStart, Sample32 iAmplitude)
+{
+  auto amplitude = iAmplitude;
+  for(auto i = static_cast<size_t>(iStart); i < ioBuffer.size() && i < static_cast<size_t>(iStart + 8 * HOP_SIZE); i++)
+  {
+    ioBuffer[i] = (i % 2 == 0) ? amplitude : -amplitude;
+    amplitude *= 0.9995f;
+  }
+}
+
+// TransientDetector - pickSlices
+TEST(TransientDetector, pickSlices)
+{
+  constexpr int32 NUM_SAMPLES = 100 * HOP_SIZE;
+
+  std::vector<Sample32> left(NUM_SAMPLES, 0);
+  std::vector<Sample32> right(NUM_SAMPLES, 0);
+
+  addBurst(left, 20 * HOP_SIZE, 0.25f);
+  addBurst(right, 60 * HOP_SIZE, 0.5f);
+
+  Sample32 const *channels[] = {left.data(), right.data()};
+
+  auto df = TransientDetector::computeDetectionFunction(channels, 2, NUM_SAMPLES);
+  ASSERT_EQ(100, static_cast<int32>(df.size()));
+
+  ASSERT_EQ(std::vector<int32>({0, 20 * HOP_SIZE, 60 * HOP_SIZE}),
+            TransientDetector::pickSlices(df, 0.5, NUM_SAMPLES, 64));
+
+  // only the strongest transient is kept
+  ASSERT_EQ(std::vector<int32>({0, 60 * HOP_SIZE}), TransientDetector::pickSlices(df, 0.5, NUM_SAMPLES, 2));
+  ASSERT_EQ(std::vector<int32>({0}), TransientDetector::pickSlices(df, 0.5, NUM_SAMPLES, 1));
+
+  // nothing detected in a sample without transients
+  std::vector<Sample32> silence(NUM_SAMPLES, 0);
+  Sample32 const *silenceChannels[] = {silence.data()};
+  df = TransientDetector::computeDetectionFunction(silenceChannels, 1, NUM_SAMPLES);
+  ASSERT_EQ(std::vector<int32>({0}), TransientDetector::pickSlices(df, 1.0, NUM_SAMPLES, 64));
+
+  // cancelled
+  std::atomic<bool> cancel{true};
+  ASSERT_TRUE(TransientDetector::computeDetectionFunction(channels, 2, NUM_SAMPLES, &cancel).empty());
+}
+
+}
@@ -0,0 +1,82 @@
+#include <pluginterfaces/vst/vsttypes.h>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <src/cpp/ZeroCrossingIndex.hpp>
+
+namespace pongasoft::VST::SampleSplitter::Test {
+
+using namespace Steinberg;
+using namespace Steinberg::Vst;
+
+// ZeroCrossingIndex - build
+TEST(ZeroCrossingIndex, build)
+{
+  std::vector<Sample32> left{ 0.5f, 0.2f, -0.1f, -0.3f, 0, 0, 0, 0.4f, -0.2f, -0.1f};
+  std::vector<Sample32> right{-0.5f, -0.2f, -0.1f, 0.3f, 0.2f, 0.1f, -0.1f, -0.4f, -0.2f, -0.1f};
+
+  Sample32 const *channels[] = {left.data(), right.data()};
+
+  auto index = ZeroCrossingIndex::build(channels, 2, 10);
+  ASSERT_EQ(2, index.getNumChannels());
+  ASSERT_EQ(10, index.getNumSamples());
+
+  // a run of 0 only counts once
+  ASSERT_EQ(std::vector<int32>({2, 4, 8}), index.getCrossings(0));
+  ASSERT_EQ(std::vector<int32>({3, 6}), index.getCrossings(1));
+
+  ASSERT_TRUE(index.hasCrossing(0, 1, 2));
+  ASSERT_FALSE(index.hasCrossing(0, 2, 3));
+  ASSERT_TRUE(index.hasCrossing(0, 2, 4));
+  ASSERT_FALSE(index.hasCrossing(0, 4, 7));
+  ASSERT_FALSE(index.hasCrossing(1, 6, 9));
+
+  // cancelled
+  std::vector<Sample32> large(1 << 17, 0.5f);
+  Sample32 const *largeChannels[] = {large.data()};
+  std::atomic<bool> cancel{true};
+  ASSERT_EQ(0, ZeroCrossingIndex::build(largeChannels, 1, 1 << 17, &cancel).getNumChannels());
+}
+
+// ZeroCrossingIndex - findNearest
+TEST(ZeroCrossingIndex, findNearest)
+{
+  std::vector<Sample32> left{ 0.5f, 0.2f, -0.1f, -0.3f, 0, 0, 0, 0.4f, -0.2f, -0.1f};
+  std::vector<Sample32> right{-0.5f, -0.2f, -0.1f, 0.3f, 0.2f, 0.1f, -0.1f, -0.4f, -0.2f, -0.1f};
+
+  Sample32 const *channels[] = {left.data(), right.data()};
+
+  auto index = ZeroCrossingIndex::build(channels, 2, 10);
+
+  // per channel
+  ASSERT_EQ(2, index.findNearest(0, 0, 10));
+  ASSERT_EQ(4, index.findNearest(0, 3, 10)); // tie => after
+  ASSERT_EQ(4, index.findNearest(0, 4, 10));
+  ASSERT_EQ(8, index.findNearest(0, 7, 10));
+  ASSERT_EQ(8, index.findNearest(0, 9, 10));
+  ASSERT_EQ(-1, index.findNearest(0, 6, 1));
+  ASSERT_EQ(6, index.findNearest(1, 9, 3));
+  ASSERT_EQ(-1, index.findNearest(1, 9, 2));
+
+  // all channels: the one closest to a zero crossing in the other channel wins
+  ASSERT_EQ(2, index.findNearest(1, 2)); // 2 (left) is 1 away from 3 (right) when 3 (right) is 1 away from 4 (left)
+  ASSERT_EQ(3, index.findNearest(3, 1));
+  ASSERT_EQ(4, index.findNearest(5, 2)); // 4 (left) is 1 away from 3 (right) when 6 (right) is 2 away from 8 (left)
+  ASSERT_EQ(-1, index.findNearest(0, 1));
+
+  ASSERT_EQ(0, index.snap(0, 1));
+  ASSERT_EQ(8, index.snap(9, 2));
+
+  // remain strictly increasing and 0 never moves
+  std::vector<int32> positions{0, 1, 3, 5, 9};
+  index.snap(positions, 2);
+  ASSERT_EQ(std::vector<int32>({0, 2, 3, 4, 8}), positions);
+
+  // 1 cannot move to 2 (next position)
+  positions = {0, 1, 2};
+  index.snap(positions, 2);
+  ASSERT_EQ(std::vector<int32>({0, 1, 2}), positions);
+}
+
+}